@@ -0,0 +1,116 @@
+#include "Checksum.h"
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace Checksum {
+
+uint32_t byte_sum(const unsigned char* data, size_t length)
+{
+    uint32_t sum = 0;
+    size_t i = 0;
+
+#if defined(__ARM_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 16 <= length; i += 16) {
+        acc = vpadalq_u16(acc, vpaddlq_u8(vld1q_u8(data + i)));
+    }
+    uint64x2_t total = vpaddlq_u32(acc);
+    sum = (uint32_t)(vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1));
+#elif defined(__SSE2__)
+    // psadbw against zero sums each 8-byte half into a 64-bit lane
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+    }
+    sum = (uint32_t)_mm_cvtsi128_si32(acc) +
+          (uint32_t)_mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc));
+#endif
+    for (; i < length; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+#if defined(__ARM_FEATURE_CRC32)
+
+uint32_t crc32(const unsigned char* data, size_t length)
+{
+    // ARMv8 CRC32 instructions use the same reflected polynomial
+    uint32_t crc = 0xFFFFFFFF;
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        uint32_t word;
+        memcpy(&word, data + i, sizeof(word));
+        crc = __crc32w(crc, word);
+    }
+    for (; i < length; i++) {
+        crc = __crc32b(crc, data[i]);
+    }
+    return ~crc;
+}
+
+#else
+
+namespace {
+
+// Slicing-by-8 tables: table[k][b] is the CRC of byte b followed by k zeros
+struct Crc32Tables {
+    uint32_t table[8][256];
+};
+
+constexpr Crc32Tables make_crc32_tables()
+{
+    Crc32Tables t{};
+    for (uint32_t b = 0; b < 256; b++) {
+        uint32_t crc = b;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+        }
+        t.table[0][b] = crc;
+    }
+    for (int k = 1; k < 8; k++) {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t prev = t.table[k - 1][b];
+            t.table[k][b] = (prev >> 8) ^ t.table[0][prev & 0xff];
+        }
+    }
+    return t;
+}
+
+constexpr Crc32Tables crc32_tables = make_crc32_tables();
+
+} // namespace
+
+uint32_t crc32(const unsigned char* data, size_t length)
+{
+    const uint32_t (*t)[256] = crc32_tables.table;
+    uint32_t crc = 0xFFFFFFFF;
+    size_t i = 0;
+
+    for (; i + 8 <= length; i += 8) {
+        const unsigned char* p = data + i;
+        uint32_t lo = crc ^ ((uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                             ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+              t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+    for (; i < length; i++) {
+        crc = (crc >> 8) ^ t[0][(crc ^ data[i]) & 0xff];
+    }
+    return ~crc;
+}
+
+#endif
+
+} // namespace Checksum
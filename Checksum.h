@@ -0,0 +1,38 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Packet checksum helpers shared by the receiver and the config broadcaster
+ *
+ * Each function has a SIMD or hardware path where the target provides one
+ * (NEON / ARMv8 CRC32 on the Pi, SSE2 on x86) and a portable fallback; all
+ * paths return identical results.
+ */
+
+namespace Checksum {
+
+/**
+ * Sum of all bytes (upload packet checksums use the low 8 or 16 bits)
+ *
+ * @param data Bytes to sum
+ * @param length Number of bytes
+ * @return Sum of the bytes
+ */
+uint32_t byte_sum(const unsigned char* data, size_t length);
+
+/**
+ * Standard CRC-32 (IEEE 802.3, reflected 0xEDB88320, init and final XOR
+ * 0xFFFFFFFF)
+ *
+ * @param data Data to calculate CRC over
+ * @param length Length of data in bytes
+ * @return Calculated CRC32 value
+ */
+uint32_t crc32(const unsigned char* data, size_t length);
+
+} // namespace Checksum
+
+#endif // CHECKSUM_H
@@ -5,43 +5,65 @@
 #include <cctype>
 #include <sstream>
 #include <iomanip>
+#include <array>
 #include "command_definitions.h"
 
-// Initialize command registry
-std::map<char, CommandInfo> CommandProcessor::init_command_registry() {
-    std::map<char, CommandInfo> registry;
-    
+// Command registry: one entry per command byte, built at compile time
+namespace {
+
+struct CommandDef {
+    char code;
+    const char* name;
+    const char* description;
+    PacketDirection typical_direction;
+    uint8_t decoders;
+};
+
+constexpr CommandDef command_defs[] = {
     // BASE -> UNIT Commands (MAC = 0xFFFFFFFF)
-    registry[CMD_WAKEUP] = {CMD_WAKEUP, "WAKE", "Wake/Activate command", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_WAKEUP_LC] = {CMD_WAKEUP_LC, "WAKE", "Wake/Activate command (lowercase)", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_SAMPLE_DATA] = {CMD_SAMPLE_DATA, "SAMPLE_DATA", "Sample data command", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_SAMPLE_DATA_LC] = {CMD_SAMPLE_DATA_LC, "SAMPLE_DATA", "Sample data command (lowercase)", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_SLEEP] = {CMD_SLEEP, "SLEEP", "Sleep command", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_SLEEP_LC] = {CMD_SLEEP_LC, "SLEEP", "Sleep command (lowercase)", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_RESET] = {CMD_RESET, "RESET", "Reset command", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_RESET_LC] = {CMD_RESET_LC, "RESET", "Reset command (lowercase)", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_ERASE_CFG] = {CMD_ERASE_CFG, "ERASE_CFG", "Erase old config files", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_ERASE_CFG_LC] = {CMD_ERASE_CFG_LC, "ERASE_CFG", "Erase old config files (lowercase)", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_INITIALIZE] = {CMD_INITIALIZE, "INIT", "Initialize/Probe command", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_INITIALIZE_LC] = {CMD_INITIALIZE_LC, "INIT", "Initialize/Probe command (lowercase)", PacketDirection::BASE_TO_UNIT};
-    
+    {CMD_WAKEUP, "WAKE", "Wake/Activate command", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+    {CMD_WAKEUP_LC, "WAKE", "Wake/Activate command (lowercase)", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+    {CMD_SAMPLE_DATA, "SAMPLE_DATA", "Sample data command", PacketDirection::BASE_TO_UNIT, DECODE_SAMPLE_PARAMS},
+    {CMD_SAMPLE_DATA_LC, "SAMPLE_DATA", "Sample data command (lowercase)", PacketDirection::BASE_TO_UNIT, DECODE_SAMPLE_PARAMS},
+    {CMD_SLEEP, "SLEEP", "Sleep command", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+    {CMD_SLEEP_LC, "SLEEP", "Sleep command (lowercase)", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+    {CMD_RESET, "RESET", "Reset command", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+    {CMD_RESET_LC, "RESET", "Reset command (lowercase)", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+    {CMD_ERASE_CFG, "ERASE_CFG", "Erase old config files", PacketDirection::BASE_TO_UNIT, DECODE_ERASE_AGE},
+    {CMD_ERASE_CFG_LC, "ERASE_CFG", "Erase old config files (lowercase)", PacketDirection::BASE_TO_UNIT, DECODE_ERASE_AGE},
+    {CMD_INITIALIZE, "INIT", "Initialize/Probe command", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+    {CMD_INITIALIZE_LC, "INIT", "Initialize/Probe command (lowercase)", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+
     // UNIT -> BASE Responses (specific MAC address)
-    registry[CMD_ACK_INIT] = {CMD_ACK_INIT, "ACK_INIT", "ACK response to Initialize command with unit info", PacketDirection::UNIT_TO_BASE};
-    registry[CMD_DATA_UPLOAD] = {CMD_DATA_UPLOAD, "DATA_UPLOAD", "Data upload segment", PacketDirection::UNIT_TO_BASE};
-    registry[CMD_DATA_RESPONSE] = {CMD_DATA_RESPONSE, "DATA_RSP", "Data response with sensor readings", PacketDirection::UNIT_TO_BASE};
-    registry[CMD_DATA_RESPONSE_LC] = {CMD_DATA_RESPONSE_LC, "DATA_RSP", "Data response with sensor readings (lowercase)", PacketDirection::UNIT_TO_BASE};
-    registry[CMD_ACK] = {CMD_ACK, "ACK", "Acknowledgment response", PacketDirection::UNIT_TO_BASE};
-    registry[CMD_ACK_LC] = {CMD_ACK_LC, "ACK", "Acknowledgment response (lowercase)", PacketDirection::UNIT_TO_BASE};
+    {CMD_ACK_INIT, "ACK_INIT", "ACK response to Initialize command with unit info", PacketDirection::UNIT_TO_BASE, DECODE_NONE},
+    {CMD_DATA_UPLOAD, "DATA_UPLOAD", "Data upload segment", PacketDirection::UNIT_TO_BASE, DECODE_NONE},
+    {CMD_DATA_RESPONSE, "DATA_RSP", "Data response with sensor readings", PacketDirection::UNIT_TO_BASE, DECODE_PUSH_CONFIG},
+    {CMD_DATA_RESPONSE_LC, "DATA_RSP", "Data response with sensor readings (lowercase)", PacketDirection::UNIT_TO_BASE, DECODE_PUSH_CONFIG},
+    {CMD_ACK, "ACK", "Acknowledgment response", PacketDirection::UNIT_TO_BASE, DECODE_NONE},
+    {CMD_ACK_LC, "ACK", "Acknowledgment response (lowercase)", PacketDirection::UNIT_TO_BASE, DECODE_NONE},
     //  other BASE -> UNIT commands:
-    registry[CMD_UPLOAD_INIT] = {CMD_UPLOAD_INIT, "UPLOAD_INIT", "Upload initialization request (0x51)", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_UPLOAD_INIT_LC] = {CMD_UPLOAD_INIT_LC, "UPLOAD_INIT", "Upload initialization request (0x51, lowercase)", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_UPLOAD_PARTIAL] = {CMD_UPLOAD_PARTIAL, "UPLOAD_PARTIAL", "Upload partial data request (0x55)", PacketDirection::BASE_TO_UNIT};
-    registry[CMD_UPLOAD_PARTIAL_LC] = {CMD_UPLOAD_PARTIAL_LC, "UPLOAD_PARTIAL", "Upload partial data request (0x55)", PacketDirection::BASE_TO_UNIT};
-    
+    {CMD_UPLOAD_INIT, "UPLOAD_INIT", "Upload initialization request (0x51)", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+    {CMD_UPLOAD_INIT_LC, "UPLOAD_INIT", "Upload initialization request (0x51, lowercase)", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+    {CMD_UPLOAD_PARTIAL, "UPLOAD_PARTIAL", "Upload partial data request (0x55)", PacketDirection::BASE_TO_UNIT, DECODE_UPLOAD_PARTIAL},
+    {CMD_UPLOAD_PARTIAL_LC, "UPLOAD_PARTIAL", "Upload partial data request (0x55)", PacketDirection::BASE_TO_UNIT, DECODE_NONE},
+};
+
+constexpr std::array<CommandInfo, 256> make_command_registry()
+{
+    std::array<CommandInfo, 256> registry{};
+    for (int i = 0; i < 256; i++) {
+        registry[i] = {(char)i, "UNKNOWN", "Unknown command", PacketDirection::UNKNOWN, DECODE_NONE, false};
+    }
+    for (const CommandDef& def : command_defs) {
+        registry[(unsigned char)def.code] = {def.code, def.name, def.description,
+                                             def.typical_direction, def.decoders, true};
+    }
     return registry;
 }
 
-const std::map<char, CommandInfo> CommandProcessor::command_registry = init_command_registry();
+constexpr std::array<CommandInfo, 256> command_registry = make_command_registry();
+
+} // namespace
 
 CommandProcessor::CommandProcessor(CTS1X* core, char* buffer, int* input_cnt, int* output_cnt)
     : ts1x_core(core), ibuf(buffer), icnt(input_cnt), ocnt(output_cnt)
@@ -58,11 +80,12 @@ CommandProcessor::~CommandProcessor()
 
 // Command registry access
 const CommandInfo* CommandProcessor::get_command_info(char command_code) {
-    auto it = command_registry.find(command_code);
-    if (it != command_registry.end()) {
-        return &(it->second);
-    }
-    return nullptr;
+    const CommandInfo& info = command_registry[(unsigned char)command_code];
+    return info.registered ? &info : nullptr;
+}
+
+const CommandInfo& CommandProcessor::lookup_command(char command_code) {
+    return command_registry[(unsigned char)command_code];
 }
 
 std::string CommandProcessor::get_direction_string(PacketDirection dir) {
@@ -9,6 +9,7 @@ struct Sampleset;
 #include <map>
 #include "TS1X.h"
 #include <vector>
+#include <type_traits>
 class CTS1X;
 #define PACKET_LENGTH 128
 #define HEADER_OFFSET 0
@@ -84,7 +85,7 @@ struct CommandResponse {
     uint8_t descriptor_channel_mask;    // Bits 11-8: Bit0=Ultrasonic, Bit1=X, Bit2=Y, Bit3=Z
     uint8_t descriptor_length_code;     // Bits 7-0: (L+1)*256 = sample length
     uint32_t descriptor_sample_length;  // Decoded sample length in samples
-    std::string descriptor_sample_rate_str;  // Human-readable sample rate
+    const char* descriptor_sample_rate_str;  // Human-readable sample rate (static string)
     
     // Command parameters (bytes 46-125, for BASEâ†’UNIT commands)
     bool has_command_params;
@@ -106,14 +107,14 @@ struct CommandResponse {
     
     // Command info (byte 45 onwards)
     char command_code;
-    std::string command_name;
-    std::string command_description;
+    const char* command_name;           // Points into the command registry
+    const char* command_description;
     uint8_t command_hops;
     uint32_t command_macid;
     uint8_t command_count;
     char version[11];
-    std::string unit_type;
-    std::string firmware_version;
+    char unit_type[11];                 // version text before 'v'
+    char firmware_version[11];          // 'v' and after
     
     // Age field for 'E' (erase) command
     uint8_t erase_age;
@@ -160,12 +161,12 @@ struct CommandResponse {
     bool has_upload_data;
     bool is_fast_mode;
     uint16_t upload_segment_addr;
-    int16_t upload_data[32];  // 32 samples per segment
+    uint8_t upload_segment_count;   // Segments carried: 1 (SLOW) or 2 (FAST)
+    int16_t upload_data[64];  // 32 samples per segment, segments back to back
     
     // Upload partial request (for command 'U' / 0x55)
     bool has_upload_partial_request;
-    uint16_t upload_partial_start_addr;
-    std::vector<uint16_t> upload_partial_segments;
+    uint16_t upload_partial_start_addr;     // Segment list: get_upload_partial_segments()
     
     // Push config (for 'D' command BASEâ†’UNIT)
     bool has_push_config;
@@ -180,54 +181,72 @@ struct CommandResponse {
     uint8_t power_adjust;
     
     // Constructor
-    CommandResponse() : packet_valid(false), crc_valid(false), hops(0), 
-                       source_macid(0), unit_id(0), direction(UNKNOWN),
-                       has_header_info(false), has_command_params(false),
-                       command_code(0), command_hops(0), command_macid(0),
-                       command_count(0), erase_age(0), rssi_value(0), 
-                       ambient_rssi(0), ram_corruption_reset_count(0),
-                       firmware(0), on_deck_crc(0), session_id_command(0),
-                       fips_status(0), dest_macid(0), has_upload_data(false),
-                       is_fast_mode(false), upload_segment_addr(0),
-                       has_upload_partial_request(false), upload_partial_start_addr(0),
-                       has_push_config(false), config_target_macid(0),
-                       config_time_block(0), config_crc32(0), config_crc_valid(false),
-                       rssi_threshold(0), rssi_delay(0), rssi_increment(0), power_adjust(0),
-                       sample_capture_segments(0), sample_channel(0), sample_decimation(0),
-                       advanced_checksum(false),
-                       sample_tach_delay(0), sample_dc_control(0), sample_wakeup_delay(0),
-                       sample_bluewave_interval(0),
-                       sample_length(0), sample_rate(0.0),
-                       datasets_processed(0), packet_correction(0), on_deck_dataset_count(0),
-                       pi_time_year(0), pi_time_month(0), pi_time_day(0),
-                       pi_time_hour(0), pi_time_min(0), pi_spi_restart_count(0),
-                       global_power_control(0), reboot_count(0), undervoltage_count(0),
-                       header_debug(0), header_bleon(0), header_fpgaon(0),
-                       header_mincount(0), header_failcount(0),
+    CommandResponse() : packet_valid(false), crc_valid(false), hops(0), source_macid(0),
+                       unit_id(0), direction(UNKNOWN), has_header_info(false),
                        descriptor_rms_only(false), descriptor_sample_rate(0),
                        descriptor_channel_mask(0), descriptor_length_code(0),
-                       descriptor_sample_length(0)
+                       descriptor_sample_length(0), descriptor_sample_rate_str(""),
+                       has_command_params(false), sample_capture_segments(0),
+                       sample_channel(0), sample_decimation(0), advanced_checksum(false),
+                       sample_tach_delay(0), sample_dc_control(0), sample_wakeup_delay(0),
+                       sample_bluewave_interval(0), sample_length(0), sample_rate(0.0),
+                       command_code(0), command_name(""), command_description(""),
+                       command_hops(0), command_macid(0), command_count(0), erase_age(0),
+                       rssi_value(0), ambient_rssi(0), ram_corruption_reset_count(0),
+                       firmware(0), on_deck_crc(0), datasets_processed(0),
+                       packet_correction(0), on_deck_dataset_count(0), pi_time_year(0),
+                       pi_time_month(0), pi_time_day(0), pi_time_hour(0), pi_time_min(0),
+                       pi_spi_restart_count(0), global_power_control(0), reboot_count(0),
+                       undervoltage_count(0), header_debug(0), header_bleon(0),
+                       header_fpgaon(0), header_mincount(0), header_failcount(0),
+                       session_id_command(0), fips_status(0), dest_macid(0),
+                       has_upload_data(false), is_fast_mode(false), upload_segment_addr(0),
+                       upload_segment_count(0), has_upload_partial_request(false),
+                       upload_partial_start_addr(0), has_push_config(false), config_target_macid(0), config_time_block(0),
+                       config_crc32(0), config_crc_valid(false), rssi_threshold(0),
+                       rssi_delay(0), rssi_increment(0), power_adjust(0)
     {
         for (int i = 0; i < 128; i++) data[i] = 0;
-        for (int i = 0; i < 11; i++) version[i] = 0;
+        for (int i = 0; i < 11; i++) {
+            version[i] = 0;
+            unit_type[i] = 0;
+            firmware_version[i] = 0;
+        }
         for (int i = 0; i < 16; i++) {
             buf_data[i] = 0;
             buf_spread[i] = 0;
             buf_tach[i] = 0;
         }
-        for (int i = 0; i < 32; i++) upload_data[i] = 0;
+        for (int i = 0; i < 64; i++) upload_data[i] = 0;
         for (int i = 0; i < 38; i++) config_packet[i] = 0;
         for (int i = 0; i < 10; i++) command_params[i] = 0;
     }
 
 };
 
+// Responses are copied by value (parse_response, pending/triggering upload
+// responses); keep them plain data so a copy is a memcpy and parsing a frame
+// never allocates.
+static_assert(std::is_trivially_copyable<CommandResponse>::value,
+              "CommandResponse must stay trivially copyable");
+
+// Per-command body decoders run by CommandReceiver::parse_response
+enum CommandDecoder : uint8_t {
+    DECODE_NONE           = 0,
+    DECODE_SAMPLE_PARAMS  = 1 << 0,   // 'R': capture parameters
+    DECODE_ERASE_AGE      = 1 << 1,   // 'E': age byte
+    DECODE_UPLOAD_PARTIAL = 1 << 2,   // 'U': 0x55 segment bitmask
+    DECODE_PUSH_CONFIG    = 1 << 3    // 'D' from BASE: config push
+};
+
 // Command info structure
 struct CommandInfo {
     char code;
-    std::string name;
-    std::string description;
+    const char* name;
+    const char* description;
     PacketDirection typical_direction;  // Typical direction this command is used
+    uint8_t decoders;                   // CommandDecoder bits
+    bool registered;                    // false for the UNKNOWN placeholder
 };
 
 // Constants
@@ -253,7 +272,8 @@ public:
     void set_print_upload_data(bool enable);
     
     // Static utility functions
-    static const CommandInfo* get_command_info(char command_code);
+    static const CommandInfo* get_command_info(char command_code);   // nullptr if unknown
+    static const CommandInfo& lookup_command(char command_code);     // UNKNOWN entry if unknown
     static PacketDirection determine_direction(const unsigned char* data, char command_code);
     static bool is_header_info_present(const unsigned char* data);
     static std::string get_direction_string(PacketDirection dir);
@@ -269,10 +289,6 @@ private:
     
     CommandTransmitter* transmitter;
     CommandReceiver* receiver;
-    
-    // Command registry
-    static std::map<char, CommandInfo> init_command_registry();
-    static const std::map<char, CommandInfo> command_registry;
 };
 
 #endif // COMMAND_PROCESSOR_H
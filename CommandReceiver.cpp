@@ -10,26 +10,30 @@ CommandReceiver::CommandReceiver(char* buffer, int* input_cnt, int* output_cnt)
 {
 }
 
+FrameView CommandReceiver::current_frame() const
+{
+    return FrameView(reinterpret_cast<const unsigned char*>(ibuf) + (*ocnt & IBUF_MASK));
+}
+
 void CommandReceiver::print_command()
 {
-    //printf("command receiver icnt/ocnt %d,%d, clipped ocnt %d\n",*icnt,*ocnt,(*ocnt + COMMAND_START) & IBUF_MASK);
-    char cmd = ibuf[(*ocnt + COMMAND_START) & IBUF_MASK];
-    cmd = tolower(cmd);
-    
-    unsigned char temp_buffer[128];
-    for (int idx = 0; idx < 128; ++idx) {
-        temp_buffer[idx] = ibuf[(*ocnt + idx) & IBUF_MASK];
+    // The hex dump is only worth building if someone will read it
+    if (!LOG_ENABLED_CTX(LOG_LEVEL_INFO, "cmd_receiver")) {
+        return;
     }
+
+    FrameView frame = current_frame();
+    char cmd = tolower(frame.command_code());
     
     // Determine direction for logging
-    PacketDirection dir = CommandProcessor::determine_direction(temp_buffer, cmd);
+    PacketDirection dir = CommandProcessor::determine_direction(frame.data(), cmd);
     
-    std::string data = CommandProcessor::hex_dump_buffer(temp_buffer, 128);
+    std::string data = CommandProcessor::hex_dump_buffer(frame.data(), PACKET_LENGTH);
     
     const CommandInfo* info = CommandProcessor::get_command_info(cmd);
     if (info != nullptr) {
         LOG_INFO_CTX("cmd_receiver", "RX Command: %c [%s] %s, Data: %s", 
-                     cmd, info->name.c_str(), 
+                     cmd, info->name, 
                      CommandProcessor::get_direction_string(dir).c_str(),
                      data.c_str());
     } else {
@@ -46,48 +50,47 @@ void CommandReceiver::print_command()
 
 CommandResponse CommandReceiver::parse_response()
 {
-    CommandResponse response;
+    return parse_response(current_frame());
+}
 
-    // Copy all 128 bytes of data
-    for (int idx = 0; idx < PACKET_LENGTH; ++idx) {
-        response.data[idx] = ibuf[(*ocnt + idx) & IBUF_MASK];
-    }
+CommandResponse CommandReceiver::parse_response(const FrameView& frame)
+{
+    CommandResponse response;
 
     // Validate packet structure (header "tS" and tail "uP")
-    response.packet_valid = (response.data[HEADER_OFFSET] == HEADER_BYTE1 &&
-                            response.data[HEADER_OFFSET + 1] == HEADER_BYTE2 &&
-                            response.data[TAIL_OFFSET] == TAIL_BYTE1 &&
-                            response.data[TAIL_OFFSET + 1] == TAIL_BYTE2);
+    response.packet_valid = frame.has_valid_markers();
 
     // Parse basic header (bytes 0-12)
-    response.hops = response.data[2];
-    response.source_macid = ((uint32_t)response.data[3] << 24) |
-                           ((uint32_t)response.data[4] << 16) |
-                           ((uint32_t)response.data[5] << 8) |
-                           (uint32_t)response.data[6];
+    response.hops = frame.hops();
+    response.source_macid = frame.source_macid();
 
     // Get command code for direction determination
-    response.command_code = response.data[45];
+    response.command_code = frame.command_code();
     
     // Determine packet direction (using MAC address as primary indicator)
-    response.direction = CommandProcessor::determine_direction(response.data, response.command_code);
+    response.direction = CommandProcessor::determine_direction(frame.data(), response.command_code);
     
     // Get command info from registry
-    const CommandInfo* cmd_info = CommandProcessor::get_command_info(response.command_code);
-    if (cmd_info != nullptr) {
-        response.command_name = cmd_info->name;
-        response.command_description = cmd_info->description;
-    } else {
-        response.command_name = "UNKNOWN";
-        response.command_description = "Unknown command";
-    }
+    const CommandInfo& cmd_info = CommandProcessor::lookup_command(response.command_code);
+    response.command_name = cmd_info.name;
+    response.command_description = cmd_info.description;
     
+    // Hot path: DATA_UPLOAD segments are decoded straight from the ring.
+    // Only the command fields and the payload are materialized; the raw
+    // bytes are not copied and the status/header sections are skipped.
+    if (frame.is_upload()) {
+        response.command_hops = frame.u8(COMMAND_START + 1);
+        response.command_macid = frame.be32(COMMAND_START + 2);
+        response.command_count = frame.u8(COMMAND_START + 10);
+        CommandReceiverSubs::parse_upload_data(frame, response);
+        return response;
+    }
+
+    // Full decode works on a private copy of the frame
+    memcpy(response.data, frame.data(), PACKET_LENGTH);
+
     // Verify checksum based on packet type
-    if (response.command_code == '3') {
-        // DATA_UPLOAD packet - has special checksum (bytes 51-114 for SLOW, 5-124 for FAST)
-        bool is_fast = (response.data[2] == 0x80);
-        response.crc_valid = CommandReceiverSubs::verify_upload_checksum(response.data, is_fast);
-    } else if (response.direction == BASE_TO_UNIT) {
+    if (response.direction == BASE_TO_UNIT) {
         // BASE→UNIT commands don't have checksums (they're ASCII parameter strings)
         response.crc_valid = true;  // Mark as N/A (valid by default)
     } else {
@@ -155,6 +158,9 @@ CommandResponse CommandReceiver::parse_response()
 
     // Parse command parameters for BASE→UNIT commands
     CommandReceiverSubs::parse_command_params(response);
+    if (response.has_command_params && (cmd_info.decoders & DECODE_SAMPLE_PARAMS)) {
+        CommandReceiverSubs::decode_sample_params(response);
+    }
 
     // Command fields always start at byte 45
     int offset = 45;
@@ -168,7 +174,7 @@ CommandResponse CommandReceiver::parse_response()
     response.command_count = response.data[offset + 10];
 
     // Parse age field for 'E' (erase) command (byte 46)
-    if (response.command_code == 'E' || response.command_code == 'e') {
+    if (cmd_info.decoders & DECODE_ERASE_AGE) {
         uint8_t encoded_age = response.data[46];
         // Decode: remove top 2 bits (0xC0 mask) to get actual age
         response.erase_age = encoded_age & 0x3f;  // Extract bottom 6 bits
@@ -176,14 +182,15 @@ CommandResponse CommandReceiver::parse_response()
         response.erase_age = 0;
     }
 
-    // Parse upload data if this is a '3' command
-    CommandReceiverSubs::parse_upload_data(response);
-
     // Parse upload partial request if this is a 'U' (0x55) command
-    CommandReceiverSubs::parse_upload_partial_request(response);
+    if (cmd_info.decoders & DECODE_UPLOAD_PARTIAL) {
+        CommandReceiverSubs::parse_upload_partial_request(response);
+    }
 
     // Parse push config if this is a 'D' (broadcast) command
-    CommandReceiverSubs::parse_push_config(response);
+    if (cmd_info.decoders & DECODE_PUSH_CONFIG) {
+        CommandReceiverSubs::parse_push_config(response);
+    }
 
     // =========================================================================
     // ONLY parse UNIT→BASE response fields for UNIT→BASE packets
@@ -270,8 +277,8 @@ CommandResponse CommandReceiver::parse_response()
     } else {
         // BASE→UNIT commands - initialize fields to safe defaults
         memset(response.version, 0, sizeof(response.version));
-        response.unit_type = "";
-        response.firmware_version = "";
+        memset(response.unit_type, 0, sizeof(response.unit_type));
+        memset(response.firmware_version, 0, sizeof(response.firmware_version));
         response.rssi_value = 0;
         response.ambient_rssi = 0;
         response.ram_corruption_reset_count = 0;
@@ -304,8 +311,8 @@ void CommandReceiver::print_response(const CommandResponse& response)
     LOG_INFO_CTX("cmd_receiver", "=== Response Packet ===");
     
     // Check if this is a bidirectional command and adjust name/description
-    std::string cmd_name = response.command_name;
-    std::string cmd_desc = response.command_description;
+    const char* cmd_name = response.command_name;
+    const char* cmd_desc = response.command_description;
 
     if ((response.command_code == 'D' || response.command_code == 'd')) {
         if (response.source_macid == BROADCAST_MAC) {
@@ -321,8 +328,8 @@ void CommandReceiver::print_response(const CommandResponse& response)
    
     LOG_INFO_CTX("cmd_receiver", "RXParse: '%c' [%s] - %s", 
              response.command_code, 
-             cmd_name.c_str(),
-             cmd_desc.c_str());
+             cmd_name,
+             cmd_desc);
 
     LOG_INFO_CTX("cmd_receiver", "Direction: %s", CommandProcessor::get_direction_string(response.direction).c_str());
     LOG_INFO_CTX("cmd_receiver", "Valid: %s, CRC: %s", 
@@ -380,19 +387,20 @@ void CommandReceiver::print_response(const CommandResponse& response)
             LOG_INFO_CTX("cmd_receiver", "  Start Address: %d (0x%04X)", 
                         response.upload_partial_start_addr,
                         response.upload_partial_start_addr);
-            LOG_INFO_CTX("cmd_receiver", "  Segments Requested: %zu", 
-                        response.upload_partial_segments.size());
+            uint16_t segments[UPLOAD_PARTIAL_MAX_SEGMENTS];
+            size_t segment_count = CommandReceiverSubs::get_upload_partial_segments(response, segments);
+            LOG_INFO_CTX("cmd_receiver", "  Segments Requested: %zu", segment_count);
             
             // Always show the segment list (up to 32 segments per line)
-            if (!response.upload_partial_segments.empty()) {
+            if (segment_count > 0) {
                 std::string line = "  Segments: ";
-                for (size_t i = 0; i < response.upload_partial_segments.size(); i++) {
+                for (size_t i = 0; i < segment_count; i++) {
                     if (i > 0 && i % 32 == 0) {
                         LOG_INFO_CTX("cmd_receiver", "%s", line.c_str());
                         line = "            ";
                     }
                     char seg_str[10];
-                    snprintf(seg_str, sizeof(seg_str), "%d ", response.upload_partial_segments[i]);
+                    snprintf(seg_str, sizeof(seg_str), "%d ", segments[i]);
                     line += seg_str;
                 }
                 if (!line.empty() && line != "            ") {
@@ -401,9 +409,9 @@ void CommandReceiver::print_response(const CommandResponse& response)
                 
                 // Show sample ranges for first few segments
                 LOG_INFO_CTX("cmd_receiver", "  Sample Ranges:");
-                size_t max_ranges = std::min(response.upload_partial_segments.size(), (size_t)20);
+                size_t max_ranges = std::min(segment_count, (size_t)20);
                 for (size_t i = 0; i < max_ranges; i++) {
-                    uint16_t seg = response.upload_partial_segments[i];
+                    uint16_t seg = segments[i];
                     uint32_t start_sample = seg * 32;
                     uint32_t end_sample = start_sample + 31;
                     
@@ -420,9 +428,9 @@ void CommandReceiver::print_response(const CommandResponse& response)
                     }
                 }
                 
-                if (response.upload_partial_segments.size() > 20) {
+                if (segment_count > 20) {
                     LOG_INFO_CTX("cmd_receiver", "    ... and %zu more segments",
-                                response.upload_partial_segments.size() - 20);
+                                segment_count - 20);
                 }
             }
         }
@@ -518,7 +526,7 @@ void CommandReceiver::print_response(const CommandResponse& response)
                          response.descriptor_sample_length, 
                          response.descriptor_length_code);
             LOG_INFO_CTX("cmd_receiver", "  Sample Rate: %s (code=%d)",
-                         response.descriptor_sample_rate_str.c_str(),
+                         response.descriptor_sample_rate_str,
                          response.descriptor_sample_rate);
             
             // Build channel string
@@ -546,14 +554,15 @@ void CommandReceiver::print_response(const CommandResponse& response)
     
     // For DATA_UPLOAD ('3') commands, show segment info and optionally data
     if (response.command_code == '3' && response.has_upload_data) {
-        LOG_INFO_CTX("cmd_receiver", "  Upload Segment Address: %d (0x%04X) [%s mode]", 
+        LOG_INFO_CTX("cmd_receiver", "  Upload Segment Address: %d (0x%04X) [%s mode, %d segment(s)]", 
                      response.upload_segment_addr, 
                      response.upload_segment_addr,
-                     response.is_fast_mode ? "FAST" : "SLOW");
+                     response.is_fast_mode ? "FAST" : "SLOW",
+                     response.upload_segment_count);
         
         if (print_upload_data_samples) {
             // Print data in rows of 8 samples
-            for (int row = 0; row < 4; row++) {
+            for (int row = 0; row < 4 * response.upload_segment_count; row++) {
                 std::string line = "    Data[" + std::to_string(row * 8) + "-" + 
                                    std::to_string(row * 8 + 7) + "]: ";
                 for (int col = 0; col < 8; col++) {
@@ -567,6 +576,12 @@ void CommandReceiver::print_response(const CommandResponse& response)
             }
         }
     }
+
+    // Upload segments carry no status fields (see parse_response)
+    if (response.command_code == '3') {
+        LOG_INFO_CTX("cmd_receiver", "======================");
+        return;
+    }
     
     // Sanitize version string for display
     std::string clean_version = CommandProcessor::sanitize_string(response.version);
@@ -575,9 +590,9 @@ void CommandReceiver::print_response(const CommandResponse& response)
     if (response.command_code == '1') {
         LOG_INFO_CTX("cmd_receiver", "  Unit ID: 0x%08X", response.command_macid);
         LOG_INFO_CTX("cmd_receiver", "  Unit Type: %s", 
-                     response.unit_type.empty() ? "N/A" : response.unit_type.c_str());
+                     response.unit_type[0] ? response.unit_type : "N/A");
         LOG_INFO_CTX("cmd_receiver", "  Firmware Version: %s", 
-                     response.firmware_version.empty() ? "N/A" : response.firmware_version.c_str());
+                     response.firmware_version[0] ? response.firmware_version : "N/A");
         LOG_INFO_CTX("cmd_receiver", "  Full Version String: %s", clean_version.c_str());
     } else {
         LOG_INFO_CTX("cmd_receiver", "  Version: %s", clean_version.c_str());
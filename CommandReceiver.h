@@ -2,6 +2,7 @@
 #define COMMAND_RECEIVER_H
 
 #include "CommandProcessor.h"
+#include "FrameView.h"
 
 // Handles parsing and displaying received command packets
 class CommandReceiver
@@ -17,6 +18,7 @@ public:
     
     // Parse a complete response packet from the circular buffer
     CommandResponse parse_response();
+    CommandResponse parse_response(const FrameView& frame);
     
     // Print a parsed response packet
     void print_response(const CommandResponse& response);
@@ -25,6 +27,9 @@ public:
     bool verify_checksum();
 
 private:
+    // View of the frame at the ring read pointer (contiguous, see IBUF_ALLOC)
+    FrameView current_frame() const;
+
     char* ibuf;
     int* icnt;
     int* ocnt;
@@ -1,7 +1,9 @@
 #include "CommandReceiverSubs.h"
+#include "FrameView.h"
 #include "CommandReceiver.h"
 #include "logger.h"
 #include "buffer_constants.h"
+#include "Checksum.h"
 #include <cstring>
 #include <cmath>
 
@@ -12,14 +14,15 @@ void parse_version_string(CommandResponse& response)
     // Parse unit type and firmware version from version string
     // Format is typically: "TSX_7CHv85" or similar
     // Unit type: everything before 'v', Firmware: 'v' and after
-    std::string version_str(response.version);
-    size_t v_pos = version_str.find('v');
-    if (v_pos != std::string::npos) {
-        response.unit_type = version_str.substr(0, v_pos);
-        response.firmware_version = version_str.substr(v_pos);
+    const char* v_pos = strchr(response.version, 'v');
+    if (v_pos != nullptr) {
+        size_t type_len = v_pos - response.version;
+        memcpy(response.unit_type, response.version, type_len);
+        response.unit_type[type_len] = '\0';
+        strcpy(response.firmware_version, v_pos);
     } else {
-        response.unit_type = version_str;
-        response.firmware_version = "";
+        strcpy(response.unit_type, response.version);
+        response.firmware_version[0] = '\0';
     }
 }
 
@@ -50,49 +53,49 @@ void parse_command_params(CommandResponse& response)
         sscanf(hex_str, "%x", &value);
         response.command_params[i] = value;
     }
-    
-    // Decode specific parameters for 'R' (SAMPLE_DATA) command
-    if (response.command_code == 'R' || response.command_code == 'r') {
-        // params[0] = capture_segments
-        response.sample_capture_segments = response.command_params[0];
-        
-        // params[1] = sample_channel + (1<<12) + (task_sample_decimation<<8) + (analyzer_server_tach_delay<<16)
-        // Bit layout:
-        //   Bits 0-7:   sample_channel (8 bits)
-        //   Bits 8-11:  decimation (4 bits, range 0-15)
-        //   Bit 12:     advanced_checksum flag
-        //   Bits 13-15: unused
-        //   Bits 16-31: tach_delay (16 bits)
-        uint32_t combined = response.command_params[1];
-        response.sample_channel = combined & 0xFF;
-        response.sample_decimation = (combined >> 8) & 0x0F;      // Only 4 bits for decimation!
-        response.advanced_checksum = (combined >> 12) & 0x01;     // Bit 12 is advanced checksum flag
-        response.sample_tach_delay = (combined >> 16) & 0xFFFF;
-        
-        // params[2] = dc_control
-        response.sample_dc_control = response.command_params[2];
-        
-        // params[3] = wakeup_delay<<16
-        response.sample_wakeup_delay = (response.command_params[3] >> 16) & 0xFFFF;
-        
-        // params[4] = bluewave_interval
-        response.sample_bluewave_interval = response.command_params[4];
-        
-        // Calculate derived parameters
-        // sample_length = sample_capture_segments * 16
-        response.sample_length = response.sample_capture_segments * 16;
-        
-        // sample_rate = 20000.0 / (2^(sample_decimation - 1))
-        if (response.sample_decimation > 0) {
-            response.sample_rate = 20000.0 / pow(2.0, (double)(response.sample_decimation - 1));
-        } else {
-            // Handle edge case where decimation is 0
-            response.sample_rate = 20000.0;
-        }
+}
+
+void decode_sample_params(CommandResponse& response)
+{
+    // params[0] = capture_segments
+    response.sample_capture_segments = response.command_params[0];
+    
+    // params[1] = sample_channel + (1<<12) + (task_sample_decimation<<8) + (analyzer_server_tach_delay<<16)
+    // Bit layout:
+    //   Bits 0-7:   sample_channel (8 bits)
+    //   Bits 8-11:  decimation (4 bits, range 0-15)
+    //   Bit 12:     advanced_checksum flag
+    //   Bits 13-15: unused
+    //   Bits 16-31: tach_delay (16 bits)
+    uint32_t combined = response.command_params[1];
+    response.sample_channel = combined & 0xFF;
+    response.sample_decimation = (combined >> 8) & 0x0F;      // Only 4 bits for decimation!
+    response.advanced_checksum = (combined >> 12) & 0x01;     // Bit 12 is advanced checksum flag
+    response.sample_tach_delay = (combined >> 16) & 0xFFFF;
+    
+    // params[2] = dc_control
+    response.sample_dc_control = response.command_params[2];
+    
+    // params[3] = wakeup_delay<<16
+    response.sample_wakeup_delay = (response.command_params[3] >> 16) & 0xFFFF;
+    
+    // params[4] = bluewave_interval
+    response.sample_bluewave_interval = response.command_params[4];
+    
+    // Calculate derived parameters
+    // sample_length = sample_capture_segments * 16
+    response.sample_length = response.sample_capture_segments * 16;
+    
+    // sample_rate = 20000.0 / (2^(sample_decimation - 1))
+    if (response.sample_decimation > 0) {
+        response.sample_rate = 20000.0 / pow(2.0, (double)(response.sample_decimation - 1));
+    } else {
+        // Handle edge case where decimation is 0
+        response.sample_rate = 20000.0;
     }
 }
 
-void parse_upload_data(CommandResponse& response)
+void parse_upload_data(const FrameView& frame, CommandResponse& response)
 {
     // Check if this is a data upload packet (command '3')
     if (response.command_code != '3') {
@@ -101,13 +104,13 @@ void parse_upload_data(CommandResponse& response)
     }
     
     // Detect FAST vs SLOW mode
-    response.is_fast_mode = (response.data[2] == 0x80);
+    response.is_fast_mode = frame.is_fast_upload();
     
     // Verify checksum FIRST
-    if (!verify_upload_checksum(response.data, response.is_fast_mode)) {
+    response.crc_valid = verify_upload_checksum(frame.data(), response.is_fast_mode);
+    if (!response.crc_valid) {
         LOG_WARN_CTX("cmd_receiver", "Upload data checksum verification failed");
         response.has_upload_data = false;
-        response.crc_valid = false;  // Mark as invalid
         return;
     }
     
@@ -116,48 +119,12 @@ void parse_upload_data(CommandResponse& response)
         // Bytes 3-4: segment address (big endian)
         // Bytes 5-124: 120 bytes of packed data (64x 15-bit samples)
         
-        response.upload_segment_addr = ((uint16_t)response.data[3] << 8) | response.data[4];
-        
-        // Decode using the FAST algorithm
-        int16_t samples[64];
-        int sample_idx = 0;
-        int save_first = 0;
-        int lcnt = 0;
+        response.upload_segment_addr = frame.be16(3);
         
-        for (int i = 0; i < 64; i++) {
-            if ((i & 0xf) == 0) {
-                save_first = 0;
-                sample_idx++;  // Skip first sample of each group of 16
-            } else {
-                int ret = ((response.data[5 + (lcnt * 2)] << 8) & 0xff00) |
-                          (response.data[5 + (lcnt * 2) + 1] & 0xff);
-                
-                if (ret & 1) {
-                    save_first += 0x8000;  // Transfer bit from saved sample
-                }
-                
-                ret &= 0xfffe;  // Clear lower bit - it's trash in this mode
-                
-                if (ret & 2) {
-                    ret++;  // Dithering function
-                }
-                
-                samples[sample_idx] = ret - 32768;  // Convert to signed
-                
-                if ((i & 0xf) == 0xf) {
-                    samples[sample_idx - 15] = save_first - 32768;
-                }
-                
-                save_first >>= 1;
-                lcnt++;
-                sample_idx++;
-            }
-        }
+        decode_fast_samples(frame.data() + 5, response.upload_data);
         
-        // Store first 32 samples (FAST mode returns 64, we only store first segment)
-        for (int i = 0; i < 32; i++) {
-            response.upload_data[i] = samples[i];
-        }
+        // FAST packets carry two consecutive segments (addr and addr+1)
+        response.upload_segment_count = 2;
         
     } else {
         // SLOW format:
@@ -165,19 +132,20 @@ void parse_upload_data(CommandResponse& response)
         // Bytes 47-48: segment address (big endian)
         // Bytes 51-114: 64 bytes (32x 16-bit samples, big endian)
         
-        if (response.data[45] != 0x33) {
-            LOG_WARN_CTX("cmd_receiver_sub", "Invalid SLOW upload command byte: 0x%02X", response.data[45]);
+        if (frame[45] != 0x33) {
+            LOG_WARN_CTX("cmd_receiver_sub", "Invalid SLOW upload command byte: 0x%02X", frame[45]);
             response.has_upload_data = false;
             return;
         }
         
-        response.upload_segment_addr = ((uint16_t)response.data[47] << 8) | response.data[48];
+        response.upload_segment_addr = frame.be16(47);
         
         // Parse 32 samples (64 bytes)
         for (int i = 0; i < 32; i++) {
             int offset = 51 + (i * 2);
-            response.upload_data[i] = ((int16_t)response.data[offset] << 8) | response.data[offset + 1];
+            response.upload_data[i] = ((int16_t)frame[offset] << 8) | frame[offset + 1];
         }
+        response.upload_segment_count = 1;
     }
     
     response.has_upload_data = true;
@@ -189,9 +157,7 @@ bool verify_upload_checksum(const unsigned char* data, bool is_fast)
     
     if (is_fast) {
         // FAST mode: sum bytes 5-124 (120 bytes of data)
-        for (int i = 5; i < 125; i++) {
-            basic_checksum += data[i];
-        }
+        basic_checksum = (uint16_t)Checksum::byte_sum(data + 5, 120);
     } else {
         // SLOW mode: Check if checksum is enabled (version byte at 49 must be 0xBB)
         uint8_t version = data[49] & 0xFF;
@@ -201,9 +167,7 @@ bool verify_upload_checksum(const unsigned char* data, bool is_fast)
         }
         
         // SLOW mode: sum data bytes 51-114 (32 pairs = 64 bytes)
-        for (int i = 51; i < 115; i++) {
-            basic_checksum += data[i];
-        }
+        basic_checksum = (uint16_t)Checksum::byte_sum(data + 51, 64);
     }
     
     // Extract MAC address from bytes 3-6
@@ -272,12 +236,6 @@ void decode_descriptor(CommandResponse& response)
 
 void parse_upload_partial_request(CommandResponse& response)
 {
-    // Check if this is upload partial request (command 'U' = 0x55)
-    if (response.command_code != 'U' && response.command_code != 0x55) {
-        response.has_upload_partial_request = false;
-        return;
-    }
-    
     // Parse Sample Start address (4 ASCII hex chars at bytes 47-50)
     // This is the starting address divided by 32
     char addr_str[5];
@@ -291,59 +249,37 @@ void parse_upload_partial_request(CommandResponse& response)
     sscanf(addr_str, "%hx", &start_segment);
     response.upload_partial_start_addr = start_segment * 32;  // Convert back to byte address
     
-    // Parse bitmask (76 bytes at bytes 51-126)
+    response.has_upload_partial_request = true;
+}
+
+size_t get_upload_partial_segments(const CommandResponse& response,
+                                   uint16_t segments[UPLOAD_PARTIAL_MAX_SEGMENTS])
+{
+    // Bitmask: 76 bytes at bytes 51-126
     // Each byte has format: MMMMMMM1 where M are mask bits and bit 0 (LSB) is always 1
     // Each byte represents 7 segments (bits 7-1, bit 0 ignored)
     // Bit 7 (MSB) = first segment of the group
     // Total possible segments: 76 * 7 = 532 segments
-    response.upload_partial_segments.clear();
-    //LOG_INFO_CTX("cmd_receiver_sub", "Partial upload start address: %04x",start_segment*32);
-    for (int byte_idx = 0; byte_idx < 76; byte_idx++) {
+    size_t count = 0;
+    for (int byte_idx = 0; byte_idx < UPLOAD_PARTIAL_MASK_BYTES; byte_idx++) {
         uint8_t mask = response.data[50 + byte_idx];
-        //LOG_INFO_CTX("cmd_receiver_sub", "Check byte %d: %02x",byte_idx,mask);
         
         // Check bits 7 down to 1 (bit 0/LSB is always 1 and ignored)
         // Bit 7 (MSB) corresponds to segment (byte_idx * 7 + 0)
         // Bit 6 corresponds to segment (byte_idx * 7 + 1), etc.
         for (int bit_pos = 7; bit_pos >= 1; bit_pos--) {
             if (mask & (1 << bit_pos)) {
-                // Calculate absolute segment number
-                uint16_t segment_num = (byte_idx * 7) + (7 - bit_pos);
-                //LOG_INFO_CTX("cmd_receiver_sub", "found %d",segment_num);
-                response.upload_partial_segments.push_back(segment_num);
+                segments[count++] = (byte_idx * 7) + (7 - bit_pos);
             }
         }
     }
-    
-    response.has_upload_partial_request = true;
-}
-
-uint32_t calculate_crc32(const unsigned char* data, int length)
-{
-    uint32_t crc = 0xFFFFFFFF;
-    
-    for (int i = 0; i < length; i++) {
-        uint32_t byte = data[i];
-        crc = crc ^ byte;
-        
-        for (int j = 7; j >= 0; j--) {
-            uint32_t mask = -(crc & 1);
-            crc = (crc >> 1) ^ (0xEDB88320 & mask);
-        }
-    }
-    
-    return ~crc;
+    return count;
 }
 
 void parse_push_config(CommandResponse& response)
 {
-    // Check if this is a 'D' command going BASE→UNIT (broadcast MAC)
-    if (response.command_code != 'D' && response.command_code != 'd') {
-        response.has_push_config = false;
-        return;
-    }
-    
-    // Check if this is BASE→UNIT direction (source MAC = BROADCAST)
+    // Only 'D' commands get here (registry dispatch); the push goes
+    // BASE→UNIT (source MAC = BROADCAST)
     if (response.source_macid != BROADCAST_MAC) {
         response.has_push_config = false;
         return;
@@ -390,7 +326,7 @@ void parse_push_config(CommandResponse& response)
     idx += 4;
     
     // Calculate CRC32 over config data (38 bytes + 4 bytes macid + 2 bytes timeblock = 44 bytes)
-    uint32_t calculated_crc = calculate_crc32(&response.data[46], 44);
+    uint32_t calculated_crc = Checksum::crc32(&response.data[46], 44);
     response.config_crc_valid = (calculated_crc == response.config_crc32);
     
     // Check for RSSI marker (0xfa 0xde)
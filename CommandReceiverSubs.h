@@ -2,9 +2,15 @@
 #define COMMANDRECEIVERSUBS_H
 
 #include <cstdint>
+#include <cstddef>
 
-// Forward declaration
+// 0x55 bitmask: 76 bytes of 7 segment bits each
+#define UPLOAD_PARTIAL_MASK_BYTES 76
+#define UPLOAD_PARTIAL_MAX_SEGMENTS (UPLOAD_PARTIAL_MASK_BYTES * 7)
+
+// Forward declarations
 struct CommandResponse;
+class FrameView;
 
 namespace CommandReceiverSubs {
     
@@ -20,11 +26,26 @@ namespace CommandReceiverSubs {
      */
     void parse_command_params(CommandResponse& response);
     
+    /**
+     * Decode the 'R' (SAMPLE_DATA) capture parameters from command_params
+     * @param response CommandResponse with has_command_params set
+     */
+    void decode_sample_params(CommandResponse& response);
+    
     /**
      * Parse upload data from command '3' packet
+     * Verifies the upload checksum and sets crc_valid accordingly.
+     * @param frame Raw frame to decode (read in place, not copied)
      * @param response CommandResponse to populate with upload data
      */
-    void parse_upload_data(CommandResponse& response);
+    void parse_upload_data(const FrameView& frame, CommandResponse& response);
+    
+    /**
+     * Unpack the 64 samples of a FAST upload packet
+     * @param packed The 120 packed data bytes (frame bytes 5-124)
+     * @param samples Receives the 64 decoded samples
+     */
+    void decode_fast_samples(const unsigned char* packed, int16_t samples[64]);
     
     /**
      * Verify checksum for upload data packets
@@ -41,21 +62,23 @@ namespace CommandReceiverSubs {
     void decode_descriptor(CommandResponse& response);
     
     /**
-     * Parse upload partial request from command 'U'
+     * Parse upload partial request from command 'U' (caller checks the code)
      * @param response CommandResponse to populate with partial request data
      */
     void parse_upload_partial_request(CommandResponse& response);
     
     /**
-     * Calculate CRC32 checksum using standard algorithm
-     * @param data Data to calculate CRC over
-     * @param length Length of data in bytes
-     * @return Calculated CRC32 value
+     * List the segments flagged in an upload partial request's bitmask
+     * (decoded from the raw packet on demand; parsing does not store them)
+     * @param response Parsed 'U' request
+     * @param segments Receives the segment numbers in ascending order
+     * @return Number of segments written
      */
-    uint32_t calculate_crc32(const unsigned char* data, int length);
+    size_t get_upload_partial_segments(const CommandResponse& response,
+                                       uint16_t segments[UPLOAD_PARTIAL_MAX_SEGMENTS]);
     
     /**
-     * Parse push config command 'D' from BASE→UNIT
+     * Parse push config command 'D' from BASE→UNIT (caller checks the code)
      * @param response CommandResponse to populate with config data
      */
     void parse_push_config(CommandResponse& response);
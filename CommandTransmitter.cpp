@@ -175,7 +175,8 @@ bool CommandTransmitter::make_command(unsigned char* output, int command, uint32
             
             // Encode current time (bytes 86-99)
             time_t now = time(nullptr);
-            struct tm* timeinfo = localtime(&now);
+            struct tm timeinfo_buf;
+            struct tm* timeinfo = localtime_r(&now, &timeinfo_buf);
             
             if (timeinfo != nullptr) {
                 // Month (86-87): 2 hex characters
@@ -224,13 +225,16 @@ bool CommandTransmitter::make_command(unsigned char* output, int command, uint32
 void CommandTransmitter::send_command(const unsigned char* cmd_buffer, int len)
 {
     //LOG_INFO_CTX("cmd_transmitter", "Sending command (%d bytes)", len);
-    for (int i = 0; i < len; ++i) {
-        ts1x_core->scia_xmit(cmd_buffer[i]);
-    }
+    ts1x_core->scia_xmit_frame(cmd_buffer, len);
 }
 
 void CommandTransmitter::print_tx_command(const unsigned char* cmd_buffer, int length)
 {
+    // The hex dump is only worth building if someone will read it
+    if (!LOG_ENABLED_CTX(LOG_LEVEL_INFO, "cmd_transmitter")) {
+        return;
+    }
+
     size_t idx = COMMAND_START;
     if (cmd_buffer == nullptr || length == 0 || idx >= length) {
         LOG_ERROR_CTX("cmd_transmitter", "Invalid parameters: buffer=%p, length=%d", 
@@ -249,7 +253,7 @@ void CommandTransmitter::print_tx_command(const unsigned char* cmd_buffer, int l
     const CommandInfo* info = CommandProcessor::get_command_info(cmd);
     if (info != nullptr) {
         LOG_INFO_CTX("cmd_transmitter", "TX Command: %c [%s] %s, Data: %s", 
-                     cmd, info->name.c_str(),
+                     cmd, info->name,
                      CommandProcessor::get_direction_string(dir).c_str(),
                      data.c_str());
     } else {
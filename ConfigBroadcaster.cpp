@@ -9,6 +9,7 @@
 #include "pi_server_sleep.h"
 #include "command_definitions.h"
 #include "logger.h"
+#include "Checksum.h"
 #include <sys/types.h>
 #include <errno.h>
 #include <string.h>
@@ -21,6 +22,8 @@ ConfigBroadcaster::ConfigBroadcaster()
     , m_power_adjust(0)
     , m_broadcast_interval_hours(8)
     , m_last_broadcast_time(0)
+    , m_cache_file_list(false)
+    , m_file_list_valid(false)
 {
 }
 
@@ -71,8 +74,18 @@ bool ConfigBroadcaster::Initialize(const std::string& config_dir,
     return false;
 }
 
+void ConfigBroadcaster::SetFileListCaching(bool enable)
+{
+    m_cache_file_list = enable;
+    m_file_list_valid = false;
+}
+
 std::vector<std::string> ConfigBroadcaster::GetConfigFiles()
 {
+    if (m_cache_file_list && m_file_list_valid) {
+        return m_config_files;
+    }
+    
     std::vector<std::string> config_files;
     DIR* dir = opendir(m_config_directory.c_str());
     
@@ -98,6 +111,11 @@ std::vector<std::string> ConfigBroadcaster::GetConfigFiles()
     // Sort for consistent ordering
     std::sort(config_files.begin(), config_files.end());
     
+    if (m_cache_file_list) {
+        m_config_files = config_files;
+        m_file_list_valid = true;
+    }
+    
     return config_files;
 }
 
@@ -318,22 +336,7 @@ void ConfigBroadcaster::CalculateCRC32(unsigned char* message,
                                        int message_length,
                                        unsigned char* crcout)
 {
-    int i, j;
-    unsigned long int byte, crc, mask;
-    
-    i = 0;
-    crc = 0xFFFFFFFF;
-    while (i < message_length) {
-        byte = message[i];
-        crc = crc ^ byte;
-        for (j = 7; j >= 0; j--) {
-            mask = -(crc & 1);
-            crc = (crc >> 1) ^ (0xEDB88320 & mask);
-        }
-        i = i + 1;
-    }
-    
-    crc = ~crc;
+    uint32_t crc = Checksum::crc32(message, message_length);
     crcout[0] = (crc >> 24) & 0xff;
     crcout[1] = (crc >> 16) & 0xff;
     crcout[2] = (crc >> 8) & 0xff;
@@ -37,6 +37,12 @@ public:
     
     // Get list of config files
     std::vector<std::string> GetConfigFiles();
+    
+    // Keep the file list between broadcasts instead of re-reading the
+    // directory; only safe while something calls InvalidateConfigFiles()
+    // on every change (the file watcher)
+    void SetFileListCaching(bool enable);
+    void InvalidateConfigFiles() { m_file_list_valid = false; }
 
 private:
     std::string m_config_directory;
@@ -47,6 +53,10 @@ private:
     time_t m_last_broadcast_time;
     int m_broadcast_interval_hours;
     
+    bool m_cache_file_list;
+    bool m_file_list_valid;
+    std::vector<std::string> m_config_files;
+    
     // Helper functions
     bool BroadcastSingleConfig(const std::string& file_path, 
                               CTS1X* ts1x_core,
@@ -1,7 +1,9 @@
 #include "ConfigManager.h"
 
+#include <algorithm>
 #include <cctype>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 
 // ---------- singleton ----------
@@ -34,12 +36,15 @@ void ConfigManager::trim_value_inplace(std::string& s) {
 bool ConfigManager::load(const std::string& path) {
     std::ifstream in(path);
     if (!in.is_open()) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
         loaded_ = false;
         kv_.clear();
         return false;
     }
 
-    kv_.clear();
+    // Parse into a fresh table and swap it in, so readers on other threads
+    // see either the old or the new contents
+    std::unordered_map<std::string, std::string> kv;
     std::string line;
     int lineno = 0;
 
@@ -78,36 +83,45 @@ bool ConfigManager::load(const std::string& path) {
         trim_value_inplace(val);
 
         if (key.empty()) continue;  // ignore empty keys
-        kv_[key] = val;             // last one wins
+        kv[key] = val;              // last one wins
     }
 
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    kv_.swap(kv);
     loaded_ = true;
     return true;
 }
 
+bool ConfigManager::lookup(const std::string& key, std::string* value) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = kv_.find(key);
+    if (it == kv_.end()) return false;
+    *value = it->second;
+    return true;
+}
+
 // ---------- getters ----------
 std::string ConfigManager::get(const std::string& key, const std::string& default_value) const {
-    auto it = kv_.find(key);
-    return (it != kv_.end()) ? it->second : default_value;
+    std::string value;
+    return lookup(key, &value) ? value : default_value;
 }
 
 int ConfigManager::get(const std::string& key, int default_value) const {
-    auto it = kv_.find(key);
-    if (it == kv_.end()) return default_value;
+    std::string value;
+    if (!lookup(key, &value)) return default_value;
 
     // Robust integer parse; ignore leading/trailing spaces already trimmed
     int out = default_value;
-    std::istringstream ss(it->second);
+    std::istringstream ss(value);
     ss >> out;
     if (!ss.fail()) return out;
     return default_value; // fallback on parse failure
 }
 
 bool ConfigManager::get(const std::string& key, bool default_value) const {
-    auto it = kv_.find(key);
-    if (it == kv_.end()) return default_value;
+    std::string val;
+    if (!lookup(key, &val)) return default_value;
     
-    std::string val = it->second;
     // Convert to lowercase for comparison
     for (char& c : val) {
         c = std::tolower(c);
@@ -124,3 +138,16 @@ bool ConfigManager::get(const std::string& key, bool default_value) const {
     
     return default_value; // fallback on unrecognized value
 }
+
+std::vector<std::pair<std::string, std::string>>
+ConfigManager::get_with_prefix(const std::string& prefix) const {
+    std::vector<std::pair<std::string, std::string>> out;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& kv : kv_) {
+        if (kv.first.compare(0, prefix.size(), prefix) == 0) {
+            out.push_back(kv);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
@@ -1,9 +1,15 @@
 #ifndef CONFIGMANAGER_H
 #define CONFIGMANAGER_H
 
+#include <atomic>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+// Getters may be called from any thread; load() swaps in the new table
+// under a writer lock.
 class ConfigManager {
 public:
     static ConfigManager& instance();
@@ -17,6 +23,9 @@ public:
     int         get(const std::string& key, int default_value) const;
     bool        get(const std::string& key, bool default_value) const;
 
+    // All (key, value) pairs whose key starts with prefix, sorted by key
+    std::vector<std::pair<std::string, std::string>> get_with_prefix(const std::string& prefix) const;
+
     // Convenience getters used by main.cpp (adapt defaults as you like)
     std::string get_version() const {
         return get("system.version", std::string("unknown"));
@@ -75,6 +84,28 @@ public:
         return get("sampleset_database_file", std::string("/srv/UPTIMEDRIVE/wvsh/sampleset_times.txt"));
     }
     
+    // Sample time journal: fdatasync after this many records or once the
+    // oldest unsynced record is this old; fold into the database file once
+    // the journal holds compact_records
+    int get_sampleset_journal_sync_records() const {
+        return get("sampleset_journal_sync_records", 16);
+    }
+    
+    int get_sampleset_journal_sync_interval_sec() const {
+        return get("sampleset_journal_sync_interval_sec", 10);
+    }
+    
+    int get_sampleset_journal_compact_records() const {
+        return get("sampleset_journal_compact_records", 4096);
+    }
+    
+    // A sampleset whose sampling failed is not handed out again for this
+    // many seconds, even if nothing else is due (0 = retry immediately,
+    // behind the samplesets already due)
+    int get_sampleset_retry_delay_sec() const {
+        return get("sampleset_retry_delay_sec", 60);
+    }
+    
     std::string get_config_files_directory() const {
         return get("config.files_directory", std::string("/srv/UPTIMEDRIVE/commands"));
     }
@@ -101,6 +132,12 @@ public:
     int get_upload_retry_timeout_ms() const {
         return get("upload.retry_timeout_ms", 1000);
     }
+    
+    // Completed uploads waiting for the file writer thread before the
+    // state machine has to wait
+    int get_upload_writer_queue_depth() const {
+        return get("upload.writer_queue_depth", 4);
+    }
 
     bool is_loaded() const { return loaded_; }
 
@@ -111,9 +148,11 @@ private:
     static void trim_inplace(std::string& s);
     static void trim_key_inplace(std::string& s);
     static void trim_value_inplace(std::string& s);
+    bool lookup(const std::string& key, std::string* value) const;
 
+    mutable std::shared_mutex mutex_;
     std::unordered_map<std::string, std::string> kv_;
-    bool loaded_ = false;
+    std::atomic<bool> loaded_{false};
 };
 
 #endif // CONFIGMANAGER_H
\ No newline at end of file
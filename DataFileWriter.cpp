@@ -1,10 +1,14 @@
 #include "DataFileWriter.h"
+#include "WaveformFile.h"
+#include "ConfigManager.h"
 #include "logger.h"
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <errno.h>
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 
 // Data scaling constant
 #define DATA_SCALE (1.0 / 20971.52)
@@ -110,22 +114,21 @@ static double calculate_rms_debug(const std::vector<int16_t>& data,int meani) {
     return rms;
 }
 
-void fprintf_3digit_exp(FILE* fp, double value) {
-    char buffer[64];
-    snprintf(buffer, sizeof(buffer), "%.6e", value);
-    
-    // Find the 'e' in scientific notation
-    char* e_pos = strchr(buffer, 'e');
-    if (!e_pos) e_pos = strchr(buffer, 'E');
-    
-    // If exponent is only 2 digits (e.g., "e-04"), expand to 3 (e.g., "e-004")
-    if (e_pos && strlen(e_pos) == 4) {  // "e-04" is 4 chars
-        char sign = e_pos[1];           // '+' or '-'
-        int exp_val = abs(atoi(e_pos + 2));
-        sprintf(e_pos, "e%c%03d", sign, exp_val);
+// Waveform formats for one output directory (<unit_id>_ch<N>):
+// output.waveform_format.<dir> overrides output.waveform_format;
+// values: text (default), binary, both
+static void get_waveform_formats(const std::string& directory_name, bool* text, bool* binary) {
+    ConfigManager& cfg = ConfigManager::instance();
+    std::string format = cfg.get("output.waveform_format", std::string("text"));
+    format = cfg.get("output.waveform_format." + directory_name, format);
+    
+    *text = (format == "text" || format == "both");
+    *binary = (format == "binary" || format == "both");
+    if (!*text && !*binary) {
+        LOG_WARN_CTX("data_writer", "Unknown waveform format '%s' for %s - writing text",
+                     format.c_str(), directory_name.c_str());
+        *text = true;
     }
-    
-    fprintf(fp, "%s\n", buffer);
 }
 
 std::string write_data_file(
@@ -160,10 +163,6 @@ std::string write_data_file(
     char unit_id_hex[9];
     snprintf(unit_id_hex, sizeof(unit_id_hex), "%08x", response->unit_id);
     
-    // Extract echobase (source_macid) as hex string
-    char echobase_hex[9];
-    snprintf(echobase_hex, sizeof(echobase_hex), "%08x", response->source_macid);
-    
     // Extract date/time from dataset_pi_time (when data was collected on remote unit)
     uint16_t year = response->header_info.dataset_pi_time.year;
     uint8_t month = response->header_info.dataset_pi_time.month;
@@ -172,13 +171,14 @@ std::string write_data_file(
     uint8_t min = response->header_info.dataset_pi_time.min;
     uint8_t sec = response->header_info.dataset_pi_time.sec;
     
-    // Format filename: YYYY_MM_DD__HH_M_SS.txt
+    // Format filename: YYYY_MM_DD__HH_M_SS (.txt text / .wfb binary)
     char filename[64];
-    snprintf(filename, sizeof(filename), "%04d_%02d_%02d__%02d_%02d_%02d.txt",
+    snprintf(filename, sizeof(filename), "%04d_%02d_%02d__%02d_%02d_%02d",
              year, month, day, hour, min, sec);
     
     // Construct directory path: ts1_data_files/<unit_id>_ch<1/2>/
-    std::string data_directory = ts1_data_files + "/" + unit_id_hex + "_" + channel_str;
+    std::string directory_name = std::string(unit_id_hex) + "_" + channel_str;
+    std::string data_directory = ts1_data_files + "/" + directory_name;
     
     // Create directory structure if it doesn't exist
     if (!create_directory_recursive(data_directory)) {
@@ -186,9 +186,6 @@ std::string write_data_file(
         return "";
     }
     
-    // Create full file path
-    std::string filepath = data_directory + "/" + filename;
-    
     // Get sample rate
     double sample_rate = 0.0;
     uint8_t rate_code = response->descriptor_sample_rate;
@@ -205,46 +202,51 @@ std::string write_data_file(
     int meani=mean;
     double rms = calculate_rms(data,meani);
     
-    // Open file for writing
-    FILE* fp = fopen(filepath.c_str(), "w");
-    if (!fp) {
-        LOG_ERROR_CTX("data_writer", "Failed to open data file: %s", filepath.c_str());
-        return "";
+    WaveformHeader header;
+    header.pod_id = response->unit_id;
+    header.echobase = response->source_macid;
+    header.year = year;
+    header.month = month;
+    header.day = day;
+    header.hour = hour;
+    header.min = min;
+    header.sec = sec;
+    header.start_channel = start_channel;
+    header.sample_rate = sample_rate;
+    header.rms = rms;
+    header.scale = DATA_SCALE;
+    header.mean = meani;
+    header.sample_count = data.size();
+    // Optional fields (not in the header yet, can be added later):
+    // battery, temperature, bluetooth_on, fpga_on, current/sample mistlx time, fail_count
+    
+    bool want_text, want_binary;
+    get_waveform_formats(directory_name, &want_text, &want_binary);
+    
+    // Full file path without extension
+    std::string basepath = data_directory + "/" + filename;
+    std::string filepath;
+    
+    if (want_binary) {
+        std::string binpath = basepath + WAVEFORM_BINARY_EXTENSION;
+        if (!write_whole_file(binpath, render_waveform_binary(header, data.data()))) {
+            LOG_ERROR_CTX("data_writer", "Failed to write data file: %s (%s)", binpath.c_str(), strerror(errno));
+            return "";
+        }
+        filepath = binpath;
     }
-    
-    // Write header
-    fprintf(fp, ";PodID %s\n", unit_id_hex);
-    fprintf(fp, ";Date Year(%d) Month(%d) Day(%02d) Hour(%02d) Minutes(%02d) Seconds(%02d)\n",
-            year, month, day, hour, min, sec);
-    fprintf(fp, ";FSampleRate %f\n", sample_rate);
-    fprintf(fp, ";Channels 1\n");
-    fprintf(fp, ";nStart_channel %d\n", start_channel);
-    fprintf(fp, ";Units 0\n");
-    fprintf(fp, ";echobase %s\n", echobase_hex);
-    fprintf(fp, ";Agc 1\n");
-    // Optional fields (commented out for now, can be added later):
-    // fprintf(fp, ";battery: %d\n", response->header_info.battery);
-    // fprintf(fp, ";temperature: %d\n", response->header_info.temperature);
-    // fprintf(fp, ";bluetooth_on: %d\n", response->header_bleon);
-    // fprintf(fp, ";fpga_on: %d\n", response->header_fpgaon);
-    // fprintf(fp, ";current_mistlx_time: %u\n", response->header_mincount);
-    // fprintf(fp, ";sample_mistlx_time: %u\n", response->header_mincount);
-    // fprintf(fp, ";fail_count: %u\n", response->header_failcount);
-    fprintf(fp, ";Samples %zu\n", data.size());
-    fprintf(fp, ";RMS %f\n", rms);
-    fprintf(fp, ";channelIds -2 -1\n");
-
-  
-    for (int16_t sample : data) {
-        double scaled_sample = (sample-meani) * DATA_SCALE;
-        //fprintf(fp, "%e\n", scaled_sample);
-        fprintf_3digit_exp(fp, scaled_sample);
+    if (want_text) {
+        std::string textpath = basepath + WAVEFORM_TEXT_EXTENSION;
+        if (!write_whole_file(textpath, render_waveform_text(header, data.data()))) {
+            LOG_ERROR_CTX("data_writer", "Failed to write data file: %s (%s)", textpath.c_str(), strerror(errno));
+            return "";
+        }
+        filepath = textpath;
     }
     
-    fclose(fp);
-    
-    LOG_INFO_CTX("data_writer", "Wrote data file: %s (%zu samples, RMS=%.6f)", 
-                 filepath.c_str(), data.size(), rms);
+    LOG_INFO_CTX("data_writer", "Wrote data file: %s%s (%zu samples, RMS=%.6f)", 
+                 filepath.c_str(), (want_text && want_binary) ? " (+ binary)" : "",
+                 data.size(), rms);
     
     return filepath;
 }
@@ -0,0 +1,72 @@
+// CommandReceiverSubs::decode_fast_samples() in a file of its own, so
+// tools/fast_decode_check can build it for each instruction set
+
+#include "CommandReceiverSubs.h"
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 64 samples packed as 4 groups of 15 words (120 bytes)
+#define FAST_PACKED_WORDS 60
+
+namespace CommandReceiverSubs {
+
+// FAST packing: 4 groups of 16 samples, each sent as 15 big-endian words.
+// Word j of a group is sample j+1 with its LSB replaced: bit 0 carries
+// bit j+1 of sample 0 (which is not sent otherwise), and the real bit 0 is
+// rebuilt from bit 1 (dither).  Samples are offset binary.
+//
+// All 60 words are decoded in one fixed-shape pass (8 lanes at a time with
+// NEON/SSE2) that also gathers their LSBs into one 60-bit mask; each group's
+// sample 0 is then a 15-bit slice of that mask.
+void decode_fast_samples(const unsigned char* packed, int16_t samples[64])
+{
+    int16_t body[FAST_PACKED_WORDS];
+    uint64_t lsbs = 0;
+    int w = 0;
+
+#if defined(__ARM_NEON)
+    const uint16x8_t keep = vdupq_n_u16(0xfffe);
+    const uint16x8_t one = vdupq_n_u16(1);
+    const uint16x8_t bias = vdupq_n_u16(0x8000);
+    const int16_t lane_shift[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    const int16x8_t shifts = vld1q_s16(lane_shift);
+    for (; w + 8 <= FAST_PACKED_WORDS; w += 8) {
+        uint16x8_t raw = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(packed + w * 2)));
+        uint16x8_t v = vorrq_u16(vandq_u16(raw, keep), vandq_u16(vshrq_n_u16(raw, 1), one));
+        vst1q_s16(body + w, vreinterpretq_s16_u16(veorq_u16(v, bias)));
+        uint64x2_t bits = vpaddlq_u32(vpaddlq_u16(vshlq_u16(vandq_u16(raw, one), shifts)));
+        lsbs |= (vgetq_lane_u64(bits, 0) | vgetq_lane_u64(bits, 1)) << w;
+    }
+#elif defined(__SSE2__)
+    const __m128i keep = _mm_set1_epi16((short)0xfffe);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i bias = _mm_set1_epi16((short)0x8000);
+    for (; w + 8 <= FAST_PACKED_WORDS; w += 8) {
+        __m128i be = _mm_loadu_si128((const __m128i*)(packed + w * 2));
+        __m128i raw = _mm_or_si128(_mm_slli_epi16(be, 8), _mm_srli_epi16(be, 8));
+        __m128i v = _mm_or_si128(_mm_and_si128(raw, keep), _mm_and_si128(_mm_srli_epi16(raw, 1), one));
+        _mm_storeu_si128((__m128i*)(body + w), _mm_xor_si128(v, bias));
+        // LSB -> sign bit -> saturated byte -> one mask bit per word
+        __m128i top = _mm_packs_epi16(_mm_slli_epi16(raw, 15), _mm_setzero_si128());
+        lsbs |= (uint64_t)(_mm_movemask_epi8(top) & 0xff) << w;
+    }
+#endif
+    for (; w < FAST_PACKED_WORDS; w++) {
+        uint16_t raw = (uint16_t)((packed[w * 2] << 8) | packed[w * 2 + 1]);
+        body[w] = (int16_t)(((raw & 0xfffe) | ((raw >> 1) & 1)) ^ 0x8000);
+        lsbs |= (uint64_t)(raw & 1) << w;
+    }
+
+    for (int g = 0; g < 4; g++) {
+        uint16_t first = (uint16_t)(((lsbs >> (g * 15)) & 0x7fff) << 1);
+        samples[g * 16] = (int16_t)(first ^ 0x8000);
+        memcpy(&samples[g * 16 + 1], body + g * 15, 15 * sizeof(int16_t));
+    }
+}
+
+} // namespace CommandReceiverSubs
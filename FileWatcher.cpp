@@ -0,0 +1,188 @@
+#include "FileWatcher.h"
+#include "logger.h"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#define FILE_WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | \
+                           IN_CREATE | IN_DELETE | IN_ONLYDIR)
+
+FileWatcher::FileWatcher(int debounce_ms)
+    : inotify_fd(-1),
+      debounce(debounce_ms > 0 ? debounce_ms : 0)
+{
+    for (int i = 0; i < WATCH_TARGET_COUNT; i++) {
+        pending[i] = false;
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+    }
+}
+
+bool FileWatcher::start()
+{
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        LOG_WARN_CTX("file_watch", "inotify unavailable (%s), using periodic checks",
+                     strerror(errno));
+        return false;
+    }
+    last_retry = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool FileWatcher::add_watch(Watch& watch)
+{
+    watch.wd = inotify_add_watch(inotify_fd, watch.directory.c_str(), FILE_WATCH_EVENTS);
+    if (watch.wd < 0) {
+        return false;
+    }
+    return true;
+}
+
+bool FileWatcher::watch_file(FileWatchTarget target, const std::string& path)
+{
+    if (!is_active() || path.empty()) {
+        return false;
+    }
+
+    Watch watch;
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        watch.directory = ".";
+        watch.name = path;
+    } else {
+        watch.directory = slash == 0 ? std::string("/") : path.substr(0, slash);
+        watch.name = path.substr(slash + 1);
+    }
+    watch.target = target;
+
+    bool ok = add_watch(watch);
+    if (ok) {
+        LOG_INFO_CTX("file_watch", "Watching %s", path.c_str());
+    } else {
+        LOG_WARN_CTX("file_watch", "Cannot watch %s yet (%s), retrying every %ds",
+                     watch.directory.c_str(), strerror(errno), FILE_WATCH_RETRY_SEC);
+    }
+    watches.push_back(watch);
+    return ok;
+}
+
+bool FileWatcher::watch_directory(FileWatchTarget target, const std::string& directory)
+{
+    if (!is_active() || directory.empty()) {
+        return false;
+    }
+
+    Watch watch;
+    watch.directory = directory;
+    watch.target = target;
+
+    bool ok = add_watch(watch);
+    if (ok) {
+        LOG_INFO_CTX("file_watch", "Watching directory %s", directory.c_str());
+    } else {
+        LOG_WARN_CTX("file_watch", "Cannot watch %s yet (%s), retrying every %ds",
+                     directory.c_str(), strerror(errno), FILE_WATCH_RETRY_SEC);
+    }
+    watches.push_back(watch);
+    return ok;
+}
+
+void FileWatcher::mark_changed(FileWatchTarget target, std::chrono::steady_clock::time_point now)
+{
+    pending[target] = true;
+    last_event[target] = now;
+}
+
+void FileWatcher::drain_events(std::chrono::steady_clock::time_point now)
+{
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true) {
+        ssize_t len = read(inotify_fd, buffer, sizeof(buffer));
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) {
+                LOG_ERROR_CTX("file_watch", "inotify read failed: %s", strerror(errno));
+            }
+            return;
+        }
+        if (len == 0) {
+            return;
+        }
+
+        for (char* p = buffer; p < buffer + len; ) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events were lost; assume everything changed
+                LOG_WARN_CTX("file_watch", "inotify queue overflow, reloading all watched files");
+                for (int t = 0; t < WATCH_TARGET_COUNT; t++) {
+                    mark_changed(static_cast<FileWatchTarget>(t), now);
+                }
+                continue;
+            }
+
+            for (auto& watch : watches) {
+                if (watch.wd != event->wd) {
+                    continue;
+                }
+                if (event->mask & IN_IGNORED) {
+                    // Directory removed or unmounted; picked up again by retry_missing()
+                    LOG_WARN_CTX("file_watch", "Watch on %s removed", watch.directory.c_str());
+                    watch.wd = -1;
+                    mark_changed(watch.target, now);
+                    continue;
+                }
+                if (watch.name.empty() ||
+                    (event->len > 0 && watch.name == event->name)) {
+                    mark_changed(watch.target, now);
+                }
+            }
+        }
+    }
+}
+
+void FileWatcher::retry_missing(std::chrono::steady_clock::time_point now)
+{
+    if (now - last_retry < std::chrono::seconds(FILE_WATCH_RETRY_SEC)) {
+        return;
+    }
+    last_retry = now;
+
+    for (auto& watch : watches) {
+        if (watch.wd < 0 && add_watch(watch)) {
+            // It may have appeared with the file already in place
+            LOG_INFO_CTX("file_watch", "Now watching %s", watch.directory.c_str());
+            mark_changed(watch.target, now);
+        }
+    }
+}
+
+uint32_t FileWatcher::poll()
+{
+    if (!is_active()) {
+        return 0;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    drain_events(now);
+    retry_missing(now);
+
+    uint32_t changed = 0;
+    for (int t = 0; t < WATCH_TARGET_COUNT; t++) {
+        if (pending[t] && now - last_event[t] >= debounce) {
+            pending[t] = false;
+            changed |= FILE_WATCH_BIT(t);
+        }
+    }
+    return changed;
+}
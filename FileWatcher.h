@@ -0,0 +1,77 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Things the main loop reloads when they change on disk
+enum FileWatchTarget {
+    WATCH_SAMPLING_FILE = 0,    // TS1X sampling file (samplesets)
+    WATCH_NODELIST,             // nodelist_force.txt
+    WATCH_CONFIG_FILES,         // config_files_directory (*.config broadcasts)
+    WATCH_SERVER_CONFIG,        // config.txt
+    WATCH_TARGET_COUNT
+};
+
+#define FILE_WATCH_BIT(target) (1u << (target))
+#define FILE_WATCH_RETRY_SEC 30     // re-try watches on directories that did not exist
+
+// inotify-based change detection for the files the server reloads.
+//
+// Files are watched through their parent directory so atomic-rename
+// updates (write temp, rename over) and files that do not exist yet are
+// both seen.  The inotify descriptor is non-blocking and owned by the main
+// thread: poll() drains it and reports a target only once its events have
+// been quiet for the debounce time, so a file written in several steps
+// triggers a single reload after the writer is done.  Nothing is stat()ed
+// while files are unchanged.
+//
+// If inotify is unavailable start() returns false and the caller keeps
+// its timer-based checks.
+class FileWatcher
+{
+public:
+    explicit FileWatcher(int debounce_ms);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool start();
+    bool is_active() const { return inotify_fd >= 0; }
+
+    // Report target when the file at path is created, replaced, written or removed
+    bool watch_file(FileWatchTarget target, const std::string& path);
+
+    // Report target when any file in directory changes
+    bool watch_directory(FileWatchTarget target, const std::string& directory);
+
+    // Drain pending events; returns FILE_WATCH_BIT()s of targets that changed
+    // and have since been quiet for the debounce time
+    uint32_t poll();
+
+private:
+    struct Watch {
+        int wd;                 // -1 until the directory exists
+        std::string directory;
+        std::string name;       // empty = any file in the directory
+        FileWatchTarget target;
+    };
+
+    bool add_watch(Watch& watch);
+    void mark_changed(FileWatchTarget target, std::chrono::steady_clock::time_point now);
+    void drain_events(std::chrono::steady_clock::time_point now);
+    void retry_missing(std::chrono::steady_clock::time_point now);
+
+    int inotify_fd;
+    std::chrono::milliseconds debounce;
+    std::vector<Watch> watches;
+
+    bool pending[WATCH_TARGET_COUNT];
+    std::chrono::steady_clock::time_point last_event[WATCH_TARGET_COUNT];
+    std::chrono::steady_clock::time_point last_retry;
+};
+
+#endif // FILE_WATCHER_H
@@ -0,0 +1,147 @@
+#include "FileWriterThread.h"
+#include "logger.h"
+#include <signal.h>
+#include <pthread.h>
+
+std::atomic<FileWriterThread*> FileWriterThread::active{nullptr};
+
+static int64_t ms_between(std::chrono::steady_clock::time_point from,
+                          std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+}
+
+FileWriterThread::FileWriterThread(size_t max_queued)
+    : max_queued(max_queued > 0 ? max_queued : 1),
+      stopping(false),
+      pending_jobs(0),
+      max_depth_seen(0),
+      jobs_written(0),
+      jobs_failed(0),
+      max_write_ms(0),
+      max_submit_wait_ms(0)
+{
+    // Signals stay with the main thread
+    sigset_t all_signals, old_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &old_signals);
+    writer_thread = std::thread(&FileWriterThread::writer_loop, this);
+    pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+
+    active.store(this);
+    LOG_INFO_CTX("file_writer", "File writer thread started (queue depth %zu)", this->max_queued);
+}
+
+FileWriterThread::~FileWriterThread()
+{
+    FileWriterThread* self = this;
+    active.compare_exchange_strong(self, nullptr);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_cv.notify_one();
+    if (writer_thread.joinable()) {
+        writer_thread.join();
+    }
+}
+
+void FileWriterThread::submit(FileWriteJob&& job)
+{
+    auto start = std::chrono::steady_clock::now();
+    job.queued_at = start;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (jobs.size() >= max_queued) {
+        LOG_WARN_CTX("file_writer", "Write queue full (%zu jobs) - waiting for the disk", jobs.size());
+        space_cv.wait(lock, [this] { return jobs.size() < max_queued; });
+
+        int64_t waited = ms_between(start, std::chrono::steady_clock::now());
+        if (waited > max_submit_wait_ms.load()) {
+            max_submit_wait_ms.store(waited);
+        }
+        LOG_WARN_CTX("file_writer", "Queued upload from 0x%08X after %lld ms backpressure",
+                     job.macid, (long long)waited);
+    }
+    jobs.push_back(std::move(job));
+    pending_jobs++;
+    if (jobs.size() > max_depth_seen.load()) {
+        max_depth_seen.store(jobs.size());
+    }
+    lock.unlock();
+    work_cv.notify_one();
+}
+
+bool FileWriterThread::poll_result(FileWriteResult& result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (results.empty()) {
+        return false;
+    }
+    result = std::move(results.front());
+    results.pop_front();
+    return true;
+}
+
+bool FileWriterThread::flush(int timeout_ms)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    std::unique_lock<std::mutex> lock(mutex);
+    return idle_cv.wait_until(lock, deadline, [this] { return pending_jobs.load() == 0; });
+}
+
+size_t FileWriterThread::get_queue_depth() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size();
+}
+
+void FileWriterThread::flush_active(int timeout_ms)
+{
+    FileWriterThread* writer = active.load();
+    if (writer && !writer->flush(timeout_ms)) {
+        LOG_ERROR_CTX("file_writer", "Shutdown with %zu upload(s) still unwritten",
+                      writer->pending_jobs.load());
+    }
+}
+
+void FileWriterThread::writer_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        work_cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) {
+            break;  // stopping and drained
+        }
+
+        FileWriteJob job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        space_cv.notify_all();
+
+        auto start = std::chrono::steady_clock::now();
+        FileWriteResult result;
+        result.macid = job.macid;
+        result.files = write_output_files(job.root_filehandler, job.config_files_directory,
+                                          job.ts1_data_files, job.samples, &job.trigger);
+        auto done = std::chrono::steady_clock::now();
+        result.wait_ms = ms_between(job.queued_at, start);
+        result.write_ms = ms_between(start, done);
+
+        if (result.files.success) {
+            jobs_written++;
+        } else {
+            jobs_failed++;
+        }
+        if (result.write_ms > max_write_ms.load()) {
+            max_write_ms.store(result.write_ms);
+        }
+
+        lock.lock();
+        result.queue_depth = jobs.size();
+        results.push_back(std::move(result));
+        if (--pending_jobs == 0) {
+            idle_cv.notify_all();
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef FILE_WRITER_THREAD_H
+#define FILE_WRITER_THREAD_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CommandProcessor.h"
+#include "WriteOutputFiles.h"
+
+// One completed upload, handed to the writer by move
+struct FileWriteJob {
+    uint32_t macid;
+    std::vector<int16_t> samples;
+    CommandResponse trigger;                // response that started the upload
+    std::string root_filehandler;
+    std::string config_files_directory;
+    std::string ts1_data_files;
+    std::chrono::steady_clock::time_point queued_at;
+
+    FileWriteJob() : macid(0) {}
+};
+
+// Outcome of one job, collected by the main thread
+struct FileWriteResult {
+    uint32_t macid;
+    OutputFileInfo files;
+    int64_t wait_ms;            // queued -> write started
+    int64_t write_ms;           // time spent in write_output_files
+    size_t queue_depth;         // jobs still queued when this one finished
+};
+
+// Writes completed uploads (header log, DC file, waveform file) on a
+// background thread so the radio state machine never waits on the disk.
+//
+// The queue is bounded: submit() only blocks when max_queued jobs are
+// already waiting, which means the disk has fallen that far behind.
+// Results go back through poll_result() so StateLogger is only used from
+// the main thread.
+class FileWriterThread
+{
+public:
+    explicit FileWriterThread(size_t max_queued);
+    ~FileWriterThread();                    // finishes queued jobs
+
+    FileWriterThread(const FileWriterThread&) = delete;
+    FileWriterThread& operator=(const FileWriterThread&) = delete;
+
+    // Queue a job; blocks while the queue is full
+    void submit(FileWriteJob&& job);
+
+    // Next finished job, if any (main thread)
+    bool poll_result(FileWriteResult& result);
+
+    // Wait until every queued job is written, up to timeout_ms
+    bool flush(int timeout_ms);
+
+    // Statistics
+    size_t get_queue_depth() const;
+    size_t get_max_queue_depth() const { return max_depth_seen.load(); }
+    uint64_t get_jobs_written() const { return jobs_written.load(); }
+    uint64_t get_jobs_failed() const { return jobs_failed.load(); }
+    int64_t get_max_write_ms() const { return max_write_ms.load(); }
+    int64_t get_max_submit_wait_ms() const { return max_submit_wait_ms.load(); }
+
+    // Flush the running writer (if any) during shutdown; logs what is left
+    // unwritten on timeout.  Main thread only, never from a signal handler.
+    static void flush_active(int timeout_ms);
+
+private:
+    void writer_loop();
+
+    size_t max_queued;
+    std::deque<FileWriteJob> jobs;
+    std::deque<FileWriteResult> results;
+    bool stopping;
+    std::atomic<size_t> pending_jobs;       // queued or being written
+    mutable std::mutex mutex;
+    std::condition_variable work_cv;        // jobs queued or stopping
+    std::condition_variable space_cv;       // queue slot freed
+    std::condition_variable idle_cv;        // pending_jobs reached zero
+    std::thread writer_thread;
+
+    std::atomic<size_t> max_depth_seen;
+    std::atomic<uint64_t> jobs_written;
+    std::atomic<uint64_t> jobs_failed;
+    std::atomic<int64_t> max_write_ms;
+    std::atomic<int64_t> max_submit_wait_ms;
+
+    static std::atomic<FileWriterThread*> active;
+};
+
+#endif // FILE_WRITER_THREAD_H
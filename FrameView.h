@@ -0,0 +1,53 @@
+#ifndef FRAME_VIEW_H
+#define FRAME_VIEW_H
+
+#include <cstdint>
+#include "buffer_constants.h"
+
+// Read-only view of one 128-byte radio frame.
+//
+// The view does not own or copy the bytes.  It normally points straight into
+// the CTS1X receive ring (ibuf), which keeps a mirror of its first CLENG bytes
+// just past IBUF_MAX so that a frame starting near the end of the ring is
+// still contiguous.  Fields are decoded on demand; callers materialize only
+// what they need.
+class FrameView {
+public:
+    explicit FrameView(const unsigned char* frame) : bytes(frame) {}
+
+    const unsigned char* data() const { return bytes; }
+    uint8_t operator[](int offset) const { return bytes[offset]; }
+
+    uint8_t u8(int offset) const { return bytes[offset]; }
+    uint16_t be16(int offset) const {
+        return ((uint16_t)bytes[offset] << 8) | (uint16_t)bytes[offset + 1];
+    }
+    uint32_t be32(int offset) const {
+        return ((uint32_t)bytes[offset] << 24) |
+               ((uint32_t)bytes[offset + 1] << 16) |
+               ((uint32_t)bytes[offset + 2] << 8) |
+               (uint32_t)bytes[offset + 3];
+    }
+
+    // "tS" at the start and "uP" at the end
+    bool has_valid_markers() const {
+        return bytes[0] == 't' && bytes[1] == 'S' &&
+               bytes[CLENG - 2] == 'u' && bytes[CLENG - 1] == 'P';
+    }
+
+    // Basic header (bytes 0-12)
+    uint8_t hops() const { return bytes[2]; }
+    uint32_t source_macid() const { return be32(3); }
+
+    // Command field (byte 45)
+    char command_code() const { return static_cast<char>(bytes[45]); }
+
+    // Data upload ('3') frames: FAST mode is flagged by 0x80 in the hops byte
+    bool is_upload() const { return command_code() == '3'; }
+    bool is_fast_upload() const { return bytes[2] == 0x80; }
+
+private:
+    const unsigned char* bytes;
+};
+
+#endif // FRAME_VIEW_H
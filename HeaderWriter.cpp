@@ -21,19 +21,22 @@ void write_header_log_entry(const CommandResponse* triggering_response, size_t d
     // Build the header string similar to the example format
     std::ostringstream oss;
     
-    // Add timestamp (current time when log entry is written)
+    // Add timestamp (current time when log entry is written).  This runs on
+    // the file writer thread, so localtime_r: the main thread uses
+    // localtime()'s static struct tm at the same time.
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    struct tm* tm_info = localtime(&tv.tv_sec);
+    struct tm tm_info;
+    localtime_r(&tv.tv_sec, &tm_info);
     
     char timestamp[64];
     snprintf(timestamp, sizeof(timestamp), "%04d-%02d-%02d %02d:%02d:%02d,%03ld",
-             tm_info->tm_year + 1900,
-             tm_info->tm_mon + 1,
-             tm_info->tm_mday,
-             tm_info->tm_hour,
-             tm_info->tm_min,
-             tm_info->tm_sec,
+             tm_info.tm_year + 1900,
+             tm_info.tm_mon + 1,
+             tm_info.tm_mday,
+             tm_info.tm_hour,
+             tm_info.tm_min,
+             tm_info.tm_sec,
              tv.tv_usec / 1000);
     
     oss << timestamp << " - ";
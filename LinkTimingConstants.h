@@ -54,12 +54,39 @@ constexpr int UPLOAD_GLOBAL_TIMEOUT_MULTIPLIER = 15;
 // Absolute maximum upload time (8 minutes) - safety limit
 constexpr int UPLOAD_GLOBAL_TIMEOUT_MAX_MS = 480000;
 
+// Per-node link estimator (TCP-style smoothed RTT and variance, RFC 6298)
+// Fed with command-to-first-packet latency and inter-packet arrival gaps;
+// estimated timeout = smoothed + VAR_MULTIPLIER × variance.  The fixed
+// timeouts above remain the floors and the fallback until a node has samples
+constexpr double UPLOAD_RTT_ALPHA = 0.125;         // gain for the smoothed value
+constexpr double UPLOAD_RTT_BETA = 0.25;           // gain for the variance
+constexpr int UPLOAD_RTT_VAR_MULTIPLIER = 4;
+
+// Ceiling for estimated packet/command timeouts (above the 1137 ms field gaps)
+constexpr int UPLOAD_PACKET_TIMEOUT_MAX_MS = 2000;
+
+// Ceiling for the estimated settling time before 0x51
+constexpr int64_t UPLOAD_INIT_STATE_MAX_MS = 500;
+
+// A reply arriving sooner than this after a timeout-triggered retry was
+// already in flight, so the timeout was spurious (floor; half the smoothed
+// RTT is used when larger)
+constexpr int UPLOAD_SPURIOUS_REPLY_MS = 50;
+
 // Maximum segments that can be requested in a single 0x55 command
 // Limited by bitmask size (76 bytes × 7 bits = 532 segments)
 constexpr int UPLOAD_MAX_SEGMENTS_PER_0X55 = 532;
 
+// Maximum 0x55 commands queued back-to-back in one retry burst
+// When more than 532 segments are missing, the missing set is split into
+// bitmap windows that go out together (each frame still waits for the
+// radio's buffer-empty line), so one round trip can cover 4 × 532 = 2128
+// segments - a whole 256×256-sample dataset
+constexpr int UPLOAD_MAX_0X55_WINDOWS_PER_BURST = 4;
+
 // Timeout for upload coordinator state transitions (ms)
 // Time to wait after initializing upload before sending 0x51
+// (floor; raised to the node's smoothed RTT once it has been measured)
 constexpr int64_t UPLOAD_INIT_STATE_TIMEOUT_MS = 120;
 
 // Time to wait after sending 0x51 before sending initial 0x55 data request
@@ -94,21 +121,6 @@ constexpr int UPLOAD_BYTES_PER_SEGMENT = 64;
 // Remote unit formula: data_length = ((descriptor & 0xFF) + 1) * 256 samples
 constexpr int UPLOAD_SAMPLES_PER_DESCRIPTOR_UNIT = 256;
 
-//=============================================================================
-// BITMAP OPTIMIZATION PARAMETERS
-//=============================================================================
-// Parameters for optimizing 0x55 partial upload command bitmaps
-// These control the segment scanning strategy to maximize bitmap density
-
-// Scan stride for finding optimal start segment
-// Uses 28 (a divisor of 532) to align with natural bitmap boundaries
-// 532 = 4 × 7 × 19, so divisors include: 1, 2, 4, 7, 14, 19, 28, 38, 76, 133, 266, 532
-// Using divisor ensures we check natural chunk boundaries after receiving full bitmaps
-constexpr int BITMAP_SCAN_STRIDE = 28;
-
-// Minimum missing segments before using optimization (below this, just use first missing)
-constexpr int BITMAP_OPTIMIZATION_THRESHOLD = 10;
-
 //=============================================================================
 // COMMAND TRANSMISSION TIMING (RF Protocol)
 //=============================================================================
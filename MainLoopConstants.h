@@ -9,12 +9,28 @@
 
 // Configuration file check interval (seconds)
 // How often to check if sampleset configuration has been modified
+// (only when the inotify file watcher is unavailable or disabled)
 constexpr int CONFIG_FILE_CHECK_INTERVAL_SEC = 120;  // 2 minutes
 
+// File watcher debounce (milliseconds, watch.debounce_ms)
+// A watched file must be quiet this long before it is reloaded; matches the
+// TS1X reader's 2 second settle time for freshly written files
+constexpr int FILE_WATCH_DEBOUNCE_MS = 2000;
+
+// File watcher poll interval (milliseconds)
+// How often the main loop drains inotify events; well under the debounce,
+// so reloads are not noticeably delayed
+constexpr int FILE_WATCH_POLL_INTERVAL_MS = 200;
+
 // Database flush interval (seconds)
 // How often to flush accumulated data to persistent storage
 constexpr int DATABASE_FLUSH_INTERVAL_SEC = 3600;  // 1 hour
 
+// Ring overflow report interval (seconds)
+// How often bytes dropped by the UART input, rx, tx and cmd rings since the
+// last report are logged (nothing is logged while no ring overflows)
+constexpr int BUFFER_OVERFLOW_REPORT_INTERVAL_SEC = 60;
+
 // Ping file update frequency (loop iterations)
 // Modulo counter for touching the ping file to indicate system is alive
 constexpr int PING_FILE_UPDATE_MODULO = 1500;
@@ -23,6 +39,11 @@ constexpr int PING_FILE_UPDATE_MODULO = 1500;
 // Delay between retry attempts when waiting for radio to become ready
 constexpr int RADIO_STARTUP_RETRY_DELAY_MS = 200;
 
+// Shutdown wait for queued upload files (milliseconds)
+// How long SIGTERM shutdown waits for the file writer thread to finish
+// uploads that are already queued before exiting
+constexpr int SHUTDOWN_WRITER_FLUSH_TIMEOUT_MS = 5000;
+
 // Main loop fallback delay (microseconds)
 // Used when main_loop_delay_us is 0 or invalid
 constexpr int MAIN_LOOP_FALLBACK_DELAY_US = 10;
@@ -41,9 +62,11 @@ constexpr int PI_BUFFER_MAX_SIZE = 8388608;      // 8 MB maximum
 constexpr int CMD_BUFFER_MIN_SIZE = 1;
 constexpr int CMD_BUFFER_MAX_SIZE = 4096;
 
+// Frames parsed per main-loop iteration (system.max_frames_per_loop)
+constexpr int FRAME_BUDGET_MIN = 1;
+constexpr int FRAME_BUDGET_MAX = 64;             // IBUF_MAX / CLENG
+
 // UART timing limits (microseconds)
-constexpr int TIMER_INTERVAL_MIN_US = 100;
-constexpr int TIMER_INTERVAL_MAX_US = 1000000;   // 1 second
 constexpr int LOOP_DELAY_MIN_US = 0;
 constexpr int LOOP_DELAY_MAX_US = 1000000;       // 1 second
 
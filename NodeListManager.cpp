@@ -8,6 +8,8 @@
 NodeListManager::NodeListManager()
     : current_node_index(0)
     , last_load_attempt(std::chrono::steady_clock::time_point())
+    , change_notifications(false)
+    , load_requested(true)
 {
 }
 
@@ -137,8 +139,21 @@ bool NodeListManager::is_at_end() const
     return node_list.empty() || current_node_index >= node_list.size();
 }
 
+void NodeListManager::set_change_notifications(bool enable)
+{
+    change_notifications = enable;
+    load_requested = true;  // one attempt with the file as it is now
+}
+
 bool NodeListManager::should_attempt_load()
 {
+    if (change_notifications) {
+        // No retry timer: the file watcher calls request_load() when it changes
+        bool requested = load_requested;
+        load_requested = false;
+        return requested;
+    }
+    
     auto now = std::chrono::steady_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
         now - last_load_attempt).count();
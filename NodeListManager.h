@@ -40,7 +40,10 @@ public:
     bool is_at_end() const;
     
     // Automatic reload management
-    bool should_attempt_load();  // Returns true if enough time has passed
+    bool should_attempt_load();  // Returns true if enough time has passed (or, with
+                                 // change notifications, if the file changed)
+    void set_change_notifications(bool enable);  // file watcher reports changes
+    void request_load() { load_requested = true; }  // file changed on disk
     bool check_and_reload_if_at_end();  // Auto-reloads if at end of list
     
     // Node access
@@ -53,6 +56,8 @@ private:
     size_t current_node_index;
     std::string nodelist_filename;
     std::chrono::steady_clock::time_point last_load_attempt;
+    bool change_notifications;
+    bool load_requested;
     
     static const int LOAD_RETRY_INTERVAL_SECONDS = 10;
 };
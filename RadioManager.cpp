@@ -9,8 +9,7 @@
 RadioManager::RadioManager(UartManager* uart_mgr)
     : uart(uart_mgr), radio_error(0), 
       current_rf_channel(DEFAULT_CHANNEL), 
-      current_rf_tx_power(DEFAULT_POWER_LEVEL),
-      interrupt_count(0) {
+      current_rf_tx_power(DEFAULT_POWER_LEVEL) {
 }
 
 RadioManager::~RadioManager() {
@@ -60,14 +59,14 @@ void RadioManager::flush_radio() {
     while (!flush) {
         uart->reset_buffers();
         bcm2835_delayMicroseconds(100000);
-        if (uart->get_input_count() == 0) flush = true;
+        if (uart->get_rx_count() == 0) flush = true;
     }
 }
 
 void RadioManager::wait_on_radio(int expect) {
-    interrupt_count = 0;
-    while (uart->get_input_count() < expect && interrupt_count < 4)
-        bcm2835_delayMicroseconds(100000);
+    // The UART reader thread fills the input ring in the background
+    for (int waited_ms = 0; uart->get_rx_count() < expect && waited_ms < RADIO_REPLY_TIMEOUT_MS; waited_ms++)
+        bcm2835_delayMicroseconds(1000);
 }
 
 void RadioManager::radio_command_mode(int id) {
@@ -103,7 +102,7 @@ void RadioManager::radio_command(char addr, char dat) {
     }
     
     wait_on_radio(1);
-    if (uart->get_input_count() != 1 || uart->get_input_char() != 0x6) {
+    if (uart->get_rx_count() != 1 || uart->get_input_char() != 0x6) {
         radio_error = 1;
     }
     radio_command_mode(0);
@@ -127,7 +126,7 @@ char RadioManager::read_radio(char addr, char id) {
     wait_on_radio(10);
 
     char result = 0;
-    if (uart->get_input_count() >= 3) {
+    if (uart->get_rx_count() >= 3) {
         char ack = uart->get_input_char();
         char addr_echo = uart->get_input_char();
         result = uart->get_input_char();
@@ -196,8 +195,7 @@ bool RadioManager::start() {
     }
 
     uart->open_port(B9600);
-    interrupt_count = 0;
-    while (interrupt_count <= 25);
+    Server_sleep_ms(RADIO_PORT_SETTLE_MS);
 
     // Try to read baud rate
     radio_error = 0;
@@ -384,7 +382,3 @@ bool RadioManager::set_tx_power(uint8_t power) {
     }
     return false;
 }
-
-void RadioManager::handle_uart_interrupt() {
-    uart->receive_bytes();
-}
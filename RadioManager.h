@@ -14,13 +14,16 @@
 #define DEFAULT_POWER_LEVEL 7
 #define DEFAULT_CHANNEL 0
 
+// Radio reply timing
+#define RADIO_REPLY_TIMEOUT_MS 100   // max wait for a command-mode reply
+#define RADIO_PORT_SETTLE_MS 130     // settle time after first opening the port
+
 class RadioManager {
 private:
     UartManager* uart;
     int radio_error;
     uint8_t current_rf_channel;
     uint8_t current_rf_tx_power;
-    volatile int interrupt_count;
 
     // GPIO and hardware control
     bool init_gpio();
@@ -55,12 +58,6 @@ public:
     int get_error() const { return radio_error; }
     void clear_error() { radio_error = 0; }
 
-    // Signal handling (called from interrupt)
-    void handle_uart_interrupt();
-    void increment_interrupt_count() { interrupt_count++; }
-    void reset_interrupt_count() { interrupt_count = 0; }
-    int get_interrupt_count() const { return interrupt_count; }
-    
     // GPIO access for main
     void wait_on_buffer_empty() { wait_on_be(); }
 };
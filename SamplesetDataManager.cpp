@@ -1,22 +1,90 @@
 #include "SamplesetDataManager.h"
+#include "Checksum.h"
+#include "ConfigManager.h"
 #include "logger.h"
 
 #include <fstream>
 #include <sstream>
 #include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cerrno>
 #include <algorithm>
-#include <set>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+#define SAMPLESET_JOURNAL_MAGIC 0x314A5353u   // "SSJ1"
+
+// One journal record: the table entry after a recordSample()
+struct JournalRecord {
+    int64_t timestamp;
+    SamplesetKey key;
+    uint32_t magic;
+    uint32_t crc;           // CRC-32 of the preceding 28 bytes
+};
+
+static_assert(sizeof(JournalRecord) == 32, "JournalRecord must stay 32 bytes");
+
+uint32_t record_crc(const JournalRecord& record) {
+    return Checksum::crc32(reinterpret_cast<const unsigned char*>(&record),
+                           offsetof(JournalRecord, crc));
+}
+
+bool write_all(int fd, const void* data, size_t length) {
+    const char* p = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t n = write(fd, p, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        length -= n;
+    }
+    return true;
+}
+
+// fsync the directory holding path, so a rename or create in it survives a
+// power cut
+bool sync_parent_directory(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." :
+                      slash == 0 ? "/" : path.substr(0, slash);
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+}
+
+} // namespace
 
 SamplesetDataManager::SamplesetDataManager(const std::string& database_path)
-    : database_path_(database_path), dirty_(false) {
+    : database_path_(database_path), dirty_(false),
+      journal_path_(database_path + SAMPLESET_JOURNAL_SUFFIX),
+      journal_fd_(-1),
+      journal_records_(0),
+      unsynced_records_(0) {
+    ConfigManager& cfg = ConfigManager::instance();
+    sync_records_ = std::max(1, cfg.get_sampleset_journal_sync_records());
+    sync_interval_sec_ = std::max(0, cfg.get_sampleset_journal_sync_interval_sec());
+    compact_records_ = std::max(1, cfg.get_sampleset_journal_compact_records());
 }
 
 SamplesetDataManager::~SamplesetDataManager() {
     // Auto-flush on destruction if there are unsaved changes
-    if (dirty_) {
+    if (dirty_ || unsynced_records_ > 0) {
         LOG_INFO_CTX("sampleset_db", "Auto-flushing database on destruction");
         flush();
     }
+    if (journal_fd_ >= 0) {
+        close(journal_fd_);
+    }
 }
 
 bool SamplesetDataManager::initialize() {
@@ -29,29 +97,18 @@ bool SamplesetDataManager::initialize() {
     // Try to load existing data; it's okay if the file doesn't exist yet
     bool result = loadFromFile();
     
+    // Then everything recorded since that snapshot
+    if (!openAndReplayJournal()) {
+        LOG_WARN_CTX("sampleset_db", "Journal unavailable, every flush will rewrite %s",
+                     database_path_.c_str());
+    }
+    
     LOG_INFO_CTX("sampleset_db", "Loaded %zu sampleset entries from database", 
                  sample_times_.size());
     
     return result;
 }
 
-std::string SamplesetDataManager::generateKey(const Sampleset& sampleset) {
-    // Format: nodeid_mask_acdc_maxfreq_resolution_interval
-    // Example: "0x00111578_0x03_DC_0.0_0_10.0"
-    // Note: Priority is excluded as it's a scheduling hint, not a sampling characteristic
-    
-    char buffer[256];
-    snprintf(buffer, sizeof(buffer), "0x%08x_0x%02x_%s_%.1f_%d_%.1f",
-             sampleset.nodeid,
-             sampleset.sampling_mask,
-             sampleset.ac_dc_flag ? "AC" : "DC",
-             sampleset.max_freq,
-             sampleset.resolution,
-             sampleset.interval);
-    
-    return std::string(buffer);
-}
-
 bool SamplesetDataManager::loadFromFile() {
     std::ifstream file(database_path_);
     
@@ -79,8 +136,9 @@ bool SamplesetDataManager::loadFromFile() {
         std::string key;
         time_t timestamp;
         
-        if (iss >> key >> timestamp) {
-            sample_times_[key] = timestamp;
+        SamplesetKey parsed;
+        if ((iss >> key >> timestamp) && SamplesetKey::from_text(key, &parsed)) {
+            sample_times_.set(parsed, timestamp);
             loaded++;
         } else {
             LOG_WARN_CTX("sampleset_db", "Failed to parse line %d: %s", line_num, line.c_str());
@@ -102,12 +160,7 @@ bool SamplesetDataManager::saveToFile() {
     // Write to a temporary file first, then rename for atomicity
     std::string temp_path = database_path_ + ".tmp";
     
-    std::ofstream file(temp_path);
-    if (!file.is_open()) {
-        LOG_ERROR_CTX("sampleset_db", "Failed to open database file for writing: %s", 
-                      temp_path.c_str());
-        return false;
-    }
+    std::ostringstream file;
     
     // Write header
     file << "# Sampleset sampling times database\n";
@@ -116,18 +169,50 @@ bool SamplesetDataManager::saveToFile() {
     file << "# Timestamp: Unix epoch time\n";
     file << "#\n";
     
-    // Write all entries
-    for (const auto& entry : sample_times_) {
+    // Write all entries, sorted by text key as the file always has been
+    std::vector<std::pair<std::string, time_t>> entries;
+    entries.reserve(sample_times_.size());
+    for (const auto& slot : sample_times_.slots()) {
+        if (slot.used) {
+            entries.emplace_back(slot.key.to_text(), slot.time);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    for (const auto& entry : entries) {
         file << entry.first << " " << entry.second << "\n";
     }
     
-    file.close();
+    // The journal is emptied once this returns, so the snapshot must be on
+    // the card before the rename
+    const std::string contents = file.str();
+    int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR_CTX("sampleset_db", "Failed to open database file for writing: %s", 
+                      temp_path.c_str());
+        return false;
+    }
+    bool written = write_all(fd, contents.data(), contents.size()) && fdatasync(fd) == 0;
+    if (close(fd) != 0) {
+        written = false;
+    }
+    if (!written) {
+        LOG_ERROR_CTX("sampleset_db", "Failed to write database file %s: %s",
+                      temp_path.c_str(), strerror(errno));
+        return false;
+    }
     
-    // Atomic rename
+    // Atomic rename, made durable before the caller empties the journal:
+    // otherwise a power cut can bring back the old snapshot next to an
+    // empty journal
     if (std::rename(temp_path.c_str(), database_path_.c_str()) != 0) {
         LOG_ERROR_CTX("sampleset_db", "Failed to rename temp file to database file");
         return false;
     }
+    if (!sync_parent_directory(database_path_)) {
+        LOG_ERROR_CTX("sampleset_db", "Failed to sync directory of %s: %s",
+                      database_path_.c_str(), strerror(errno));
+        return false;
+    }
     
     dirty_ = false;
     LOG_DEBUG_CTX("sampleset_db", "Saved %zu entries to database", sample_times_.size());
@@ -135,29 +220,174 @@ bool SamplesetDataManager::saveToFile() {
     return true;
 }
 
+bool SamplesetDataManager::openAndReplayJournal() {
+    if (journal_fd_ >= 0) {
+        close(journal_fd_);
+    }
+    struct stat st;
+    bool created = stat(journal_path_.c_str(), &st) != 0;
+    journal_fd_ = open(journal_path_.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (journal_fd_ < 0) {
+        LOG_ERROR_CTX("sampleset_db", "Failed to open journal %s: %s",
+                      journal_path_.c_str(), strerror(errno));
+        return false;
+    }
+    if (created && !sync_parent_directory(journal_path_)) {
+        LOG_WARN_CTX("sampleset_db", "Failed to sync directory of new journal %s: %s",
+                     journal_path_.c_str(), strerror(errno));
+    }
+    
+    // Replay records in order; the last one for a key wins
+    JournalRecord record;
+    off_t valid_bytes = 0;
+    size_t replayed = 0;
+    while (true) {
+        ssize_t n = pread(journal_fd_, &record, sizeof(record), valid_bytes);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n != static_cast<ssize_t>(sizeof(record)) ||
+            record.magic != SAMPLESET_JOURNAL_MAGIC ||
+            record.crc != record_crc(record)) {
+            break;
+        }
+        sample_times_.set(record.key, static_cast<time_t>(record.timestamp));
+        valid_bytes += sizeof(record);
+        replayed++;
+    }
+    
+    // Anything past the last good record is a write torn by a power cut
+    if (fstat(journal_fd_, &st) == 0 && st.st_size > valid_bytes) {
+        LOG_WARN_CTX("sampleset_db", "Discarding %lld bytes of torn journal after %zu records",
+                     static_cast<long long>(st.st_size - valid_bytes), replayed);
+        if (ftruncate(journal_fd_, valid_bytes) != 0) {
+            LOG_ERROR_CTX("sampleset_db", "Failed to truncate journal: %s", strerror(errno));
+            close(journal_fd_);
+            journal_fd_ = -1;
+            return false;
+        }
+    }
+    
+    journal_records_ = replayed;
+    unsynced_records_ = 0;
+    if (replayed > 0) {
+        LOG_INFO_CTX("sampleset_db", "Replayed %zu journal records", replayed);
+    }
+    
+    return true;
+}
+
+void SamplesetDataManager::appendJournal(const SamplesetKey& key, time_t timestamp) {
+    if (journal_fd_ < 0) {
+        dirty_ = true;
+        return;
+    }
+    
+    JournalRecord record;
+    record.timestamp = static_cast<int64_t>(timestamp);
+    record.key = key;
+    record.magic = SAMPLESET_JOURNAL_MAGIC;
+    record.crc = record_crc(record);
+    
+    if (!write_all(journal_fd_, &record, sizeof(record))) {
+        LOG_ERROR_CTX("sampleset_db", "Journal write failed (%s), falling back to snapshots",
+                      strerror(errno));
+        close(journal_fd_);
+        journal_fd_ = -1;
+        dirty_ = true;
+        return;
+    }
+    
+    journal_records_++;
+    if (unsynced_records_++ == 0) {
+        first_unsynced_ = std::chrono::steady_clock::now();
+    }
+    if (unsynced_records_ >= sync_records_) {
+        syncJournal();
+    }
+}
+
+bool SamplesetDataManager::syncJournal() {
+    if (journal_fd_ < 0 || unsynced_records_ == 0) {
+        return true;
+    }
+    if (fdatasync(journal_fd_) != 0) {
+        LOG_ERROR_CTX("sampleset_db", "Journal fdatasync failed: %s", strerror(errno));
+        return false;
+    }
+    unsynced_records_ = 0;
+    return true;
+}
+
+void SamplesetDataManager::syncIfDue() {
+    if (unsynced_records_ == 0) {
+        return;
+    }
+    auto waited = std::chrono::steady_clock::now() - first_unsynced_;
+    if (waited >= std::chrono::seconds(sync_interval_sec_)) {
+        syncJournal();
+    }
+}
+
+bool SamplesetDataManager::compact() {
+    if (!saveToFile()) {
+        return false;
+    }
+    
+    // Snapshot now holds everything the journal did.  The journal must
+    // not survive it: if a write failed, records after the failure are only
+    // in the snapshot, and replaying the older ones at the next start would
+    // put those samplesets back in time.
+    if (journal_fd_ >= 0 && ftruncate(journal_fd_, 0) != 0) {
+        LOG_WARN_CTX("sampleset_db", "Failed to truncate journal: %s", strerror(errno));
+        close(journal_fd_);
+        journal_fd_ = -1;
+    }
+    if (journal_fd_ < 0) {
+        // Journal was closed after an error; clear it by path
+        if (truncate(journal_path_.c_str(), 0) != 0 && errno != ENOENT &&
+            unlink(journal_path_.c_str()) != 0 && errno != ENOENT) {
+            LOG_ERROR_CTX("sampleset_db", "Cannot clear stale journal %s: %s",
+                          journal_path_.c_str(), strerror(errno));
+            dirty_ = true;
+            return false;
+        }
+        
+        journal_fd_ = open(journal_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (journal_fd_ >= 0) {
+            // It may have been unlinked and created again
+            sync_parent_directory(journal_path_);
+            LOG_INFO_CTX("sampleset_db", "Journal %s reopened", journal_path_.c_str());
+        }
+    }
+    journal_records_ = 0;
+    unsynced_records_ = 0;
+    return true;
+}
+
 int SamplesetDataManager::refresh(const std::vector<Sampleset>& current_samplesets) {
     LOG_INFO_CTX("sampleset_db", "Refreshing database with %zu current samplesets", 
                  current_samplesets.size());
     
-    // Build a set of valid keys from current samplesets
-    std::set<std::string> valid_keys;
+    // Build a table of valid keys from current samplesets
+    SamplesetTimeTable valid_keys;
+    valid_keys.reserve(current_samplesets.size());
     for (const auto& sampleset : current_samplesets) {
-        std::string key = generateKey(sampleset);
-        valid_keys.insert(key);
+        valid_keys.set(SamplesetKey::from_sampleset(sampleset), 0);
     }
     
-    // Find and remove stale entries (entries not in the valid set)
-    std::vector<std::string> stale_keys;
-    for (const auto& entry : sample_times_) {
-        if (valid_keys.find(entry.first) == valid_keys.end()) {
-            stale_keys.push_back(entry.first);
+    // Find stale entries (entries not in the valid table)
+    std::vector<SamplesetKey> stale_keys;
+    for (const auto& slot : sample_times_.slots()) {
+        if (slot.used && !valid_keys.find(slot.key)) {
+            stale_keys.push_back(slot.key);
         }
     }
     
     // Remove stale entries
     for (const auto& key : stale_keys) {
         sample_times_.erase(key);
-        LOG_DEBUG_CTX("sampleset_db", "Removed stale entry: %s", key.c_str());
+        LOG_DEBUG_CTX("sampleset_db", "Removed stale entry: %s", key.to_text().c_str());
     }
     
     if (!stale_keys.empty()) {
@@ -180,48 +410,45 @@ void SamplesetDataManager::recordSample(const Sampleset& sampleset, time_t times
         timestamp = std::time(nullptr);
     }
     
-    std::string key = generateKey(sampleset);
-    
-    // Check if this is a new entry or update
-    bool is_new = (sample_times_.find(key) == sample_times_.end());
-    
-    sample_times_[key] = timestamp;
-    dirty_ = true;
+    SamplesetKey key = SamplesetKey::from_sampleset(sampleset);
+    bool is_new = sample_times_.set(key, timestamp);
+    appendJournal(key, timestamp);
     
     if (is_new) {
         LOG_DEBUG_CTX("sampleset_db", "Recorded NEW sample: %s at timestamp %ld", 
-                      key.c_str(), timestamp);
+                      key.to_text().c_str(), timestamp);
     } else {
         LOG_DEBUG_CTX("sampleset_db", "Updated sample time: %s at timestamp %ld", 
-                      key.c_str(), timestamp);
+                      key.to_text().c_str(), timestamp);
     }
 }
 
 time_t SamplesetDataManager::getLastSampleTime(const Sampleset& sampleset) const {
-    std::string key = generateKey(sampleset);
-    
-    auto it = sample_times_.find(key);
-    if (it != sample_times_.end()) {
-        return it->second;
+    const time_t* timestamp = sample_times_.find(SamplesetKey::from_sampleset(sampleset));
+    if (timestamp) {
+        return *timestamp;
     }
     
     return 0;  // Never sampled
 }
 
 bool SamplesetDataManager::hasBeenSampled(const Sampleset& sampleset) const {
-    std::string key = generateKey(sampleset);
-    return sample_times_.find(key) != sample_times_.end();
+    return sample_times_.find(SamplesetKey::from_sampleset(sampleset)) != nullptr;
 }
 
 bool SamplesetDataManager::flush() {
-    if (!dirty_) {
-        LOG_DEBUG_CTX("sampleset_db", "Database is clean, no flush needed");
-        return true;
+    if (!dirty_ && journal_records_ < compact_records_) {
+        // Journal covers everything since the snapshot; just make it durable
+        if (unsynced_records_ > 0) {
+            LOG_DEBUG_CTX("sampleset_db", "Syncing %zu journal records", unsynced_records_);
+        }
+        return syncJournal();
     }
     
-    LOG_INFO_CTX("sampleset_db", "Flushing %zu entries to disk", sample_times_.size());
+    LOG_INFO_CTX("sampleset_db", "Compacting %zu journal records into a snapshot of %zu entries",
+                 journal_records_, sample_times_.size());
     
-    bool result = saveToFile();
+    bool result = compact();
     if (result) {
         LOG_INFO_CTX("sampleset_db", "Successfully flushed database to disk");
     } else {
@@ -2,10 +2,14 @@
 #define SAMPLESETDATAMANAGER_H
 
 #include "SamplesetGenerator.h"
+#include "SamplesetKey.h"
 #include <string>
-#include <map>
 #include <ctime>
 #include <vector>
+#include <chrono>
+
+// Journal file, next to the database snapshot
+#define SAMPLESET_JOURNAL_SUFFIX ".journal"
 
 /**
  * Manages a persistent database of sampleset sampling times.
@@ -13,6 +17,18 @@
  * Keeps track of when each sampleset was last sampled, stored in RAM for fast access
  * and periodically persisted to disk. The database is keyed by a unique identifier
  * derived from the sampleset's characteristics (nodeid, mask, type, freq, etc.).
+ * In memory that identifier is a packed SamplesetKey in a flat hash table, so
+ * lookups never format or allocate; the text key form is only used in the file.
+ *
+ * Persistence is a text snapshot (the database file) plus a binary write-ahead
+ * journal (<database>.journal).  Every recordSample() appends one fixed-size,
+ * CRC-checked record to the journal; the journal is fdatasync'd once a batch
+ * of records or a time limit is reached, and flush() folds it into a new
+ * snapshot only once it has grown past the compaction threshold.  The
+ * snapshot is fdatasync'd, renamed into place and its directory fsync'd
+ * before the journal is truncated.  Startup
+ * loads the snapshot and replays the journal, stopping at the first torn or
+ * corrupt record.
  * 
  * This allows detection of stale entries when sampleset configurations change.
  */
@@ -68,11 +84,20 @@ public:
     bool hasBeenSampled(const Sampleset& sampleset) const;
     
     /**
-     * Flush in-memory data to disk immediately
+     * Make everything recorded so far durable: fdatasync the journal, and
+     * rewrite the snapshot if the journal is due for compaction (or the
+     * journal is unavailable)
      * @return true if successful, false on error
      */
     bool flush();
     
+    /**
+     * fdatasync the journal if a sync batch is full or its oldest unsynced
+     * record has waited the sync interval.  Cheap when nothing is pending;
+     * call from the main loop.
+     */
+    void syncIfDue();
+    
     /**
      * Get the number of samplesets currently tracked
      * @return Count of entries in the database
@@ -86,15 +111,6 @@ public:
     void clear();
     
 private:
-    /**
-     * Generate a unique string key for a sampleset based on its characteristics.
-     * Format: "nodeid_mask_acdc_maxfreq_resolution_interval"
-     * Example: "0x00111578_0x03_DC_0.0_0_10.0"
-     * 
-     * Note: Priority is NOT included as it's a scheduling hint, not a sampling characteristic
-     */
-    static std::string generateKey(const Sampleset& sampleset);
-    
     /**
      * Load database from disk file
      * @return true if successful (or file doesn't exist), false on error
@@ -107,9 +123,41 @@ private:
      */
     bool saveToFile();
     
+    /**
+     * Open the journal, replay its records into the table and cut off any
+     * torn tail
+     * @return true if the journal is usable for appends
+     */
+    bool openAndReplayJournal();
+    
+    /**
+     * Append one record; on failure fall back to snapshot-only (dirty_)
+     */
+    void appendJournal(const SamplesetKey& key, time_t timestamp);
+    
+    /**
+     * fdatasync pending journal records
+     */
+    bool syncJournal();
+    
+    /**
+     * Write a fresh snapshot, then empty the journal
+     */
+    bool compact();
+    
     std::string database_path_;                    // Path to persistent storage file
-    std::map<std::string, time_t> sample_times_;   // In-memory database: key -> timestamp
-    bool dirty_;                                    // Flag indicating unsaved changes
+    SamplesetTimeTable sample_times_;              // In-memory database: key -> timestamp
+    bool dirty_;                                    // Snapshot must be rewritten (not covered by journal)
+    
+    std::string journal_path_;                     // Write-ahead journal file
+    int journal_fd_;                               // -1 if the journal could not be opened
+    size_t journal_records_;                       // Records in the journal since the last snapshot
+    size_t unsynced_records_;                      // Records written but not yet fdatasync'd
+    std::chrono::steady_clock::time_point first_unsynced_;
+    
+    size_t sync_records_;                          // fdatasync after this many records
+    int sync_interval_sec_;                        // ... or once the oldest has waited this long
+    size_t compact_records_;                       // Fold into the snapshot at this journal length
 };
 
 #endif // SAMPLESETDATAMANAGER_H
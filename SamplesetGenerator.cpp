@@ -3,11 +3,14 @@
 #include "logger.h"
 
 #include <map>
+#include <unordered_map>
 #include <cstdio>
 #include <algorithm>
 
+namespace {
+
 // Helper structure for grouping channels by their common attributes
-struct SamplesetKey {
+struct ChannelGroupKey {
     uint32_t nodeid;           // Serial number
     std::string channel_type;  // "DC" or "AC"
     double interval;           // Sampling interval
@@ -15,7 +18,7 @@ struct SamplesetKey {
     int resolution;            // Only relevant for AC channels
     
     // Comparison operator needed for std::map
-    bool operator<(const SamplesetKey& other) const {
+    bool operator<(const ChannelGroupKey& other) const {
         if (nodeid != other.nodeid) return nodeid < other.nodeid;
         if (channel_type != other.channel_type) return channel_type < other.channel_type;
         if (interval != other.interval) return interval < other.interval;
@@ -24,15 +27,7 @@ struct SamplesetKey {
     }
 };
 
-// Convert hex string like "0x00111578" to uint32_t
-static uint32_t parseSerial(const std::string& serial_str) {
-    try {
-        return std::stoul(serial_str, nullptr, 16);
-    } catch (const std::exception& e) {
-        LOG_ERROR_CTX("sampleset", "Failed to parse serial: %s", serial_str.c_str());
-        return 0;
-    }
-}
+} // namespace
 
 std::vector<Sampleset> createSamplesets(const std::vector<Ts1xChannel>& ts1x_channels) {
     std::vector<Sampleset> samplesets;
@@ -44,16 +39,16 @@ std::vector<Sampleset> createSamplesets(const std::vector<Ts1xChannel>& ts1x_cha
     
     // Use a map to group channels by their common attributes
     // Key = common attributes, Value = bitmask of channels
-    std::map<SamplesetKey, uint8_t> grouped_channels;
-    std::map<SamplesetKey, uint8_t> grouped_priority;  // Track priority per group
+    std::map<ChannelGroupKey, uint8_t> grouped_channels;
+    std::map<ChannelGroupKey, uint8_t> grouped_priority;  // Track priority per group
     
     int skipped_invalid_serial = 0;
     int skipped_invalid_channel = 0;
     int skipped_echobase = 0;
     
     for (const auto& channel : ts1x_channels) {
-        // Parse serial number from hex string to uint32_t
-        uint32_t nodeid = parseSerial(channel.serial);
+        // Serial number was parsed by the reader
+        uint32_t nodeid = channel.nodeid;
         if (nodeid == 0) {
             LOG_WARN_CTX("sampleset", "Skipping channel with invalid serial: %s", 
                         channel.serial.c_str());
@@ -80,7 +75,7 @@ std::vector<Sampleset> createSamplesets(const std::vector<Ts1xChannel>& ts1x_cha
         
         // Create key for grouping
         // Channels can be combined if they share all these attributes
-        SamplesetKey key;
+        ChannelGroupKey key;
         key.nodeid = nodeid;
         key.channel_type = channel.channel_type;
         key.interval = channel.interval;
@@ -99,7 +94,7 @@ std::vector<Sampleset> createSamplesets(const std::vector<Ts1xChannel>& ts1x_cha
     
     // Convert the grouped channels map into a vector of samplesets
     for (const auto& pair : grouped_channels) {
-        const SamplesetKey& key = pair.first;
+        const ChannelGroupKey& key = pair.first;
         uint8_t mask = pair.second;
         
         Sampleset sampleset;
@@ -133,6 +128,50 @@ std::vector<Sampleset> createSamplesets(const std::vector<Ts1xChannel>& ts1x_cha
     return samplesets;
 }
 
+std::vector<time_t> oldestChannelSampleTimes(const std::vector<Sampleset>& samplesets,
+                                             const std::vector<Ts1xChannel>& ts1x_channels) {
+    std::vector<time_t> oldest(samplesets.size(), 0);
+    
+    // Index channels by node id once, so each sampleset only visits its own
+    // node's channels (serials and timestamps were parsed by the reader)
+    std::unordered_multimap<uint32_t, size_t> channels_by_node;
+    channels_by_node.reserve(ts1x_channels.size());
+    for (size_t i = 0; i < ts1x_channels.size(); i++) {
+        if (ts1x_channels[i].nodeid != 0) {
+            channels_by_node.emplace(ts1x_channels[i].nodeid, i);
+        }
+    }
+    
+    for (size_t s = 0; s < samplesets.size(); s++) {
+        const Sampleset& sampleset = samplesets[s];
+        
+        // Find all channels that contribute to this sampleset
+        auto range = channels_by_node.equal_range(sampleset.nodeid);
+        for (auto it = range.first; it != range.second; ++it) {
+            const Ts1xChannel& channel = ts1x_channels[it->second];
+            
+            // Check if channel type matches
+            if (channel.is_ac != (bool)sampleset.ac_dc_flag) {
+                continue;
+            }
+            
+            // Check if channel is in the sampling mask
+            if (channel.channel_num < 0 || channel.channel_num > 7 ||
+                (sampleset.sampling_mask & (1 << channel.channel_num)) == 0) {
+                continue;
+            }
+            
+            // Invalid or missing timestamps were parsed as 0; skip them
+            time_t channel_time = channel.last_sampled_time;
+            if (channel_time != 0 && (oldest[s] == 0 || channel_time < oldest[s])) {
+                oldest[s] = channel_time;
+            }
+        }
+    }
+    
+    return oldest;
+}
+
 void printSamplesets(const std::vector<Sampleset>& samplesets) {
     LOG_INFO_CTX("sampleset", "=== SAMPLESETS (%zu total) ===", samplesets.size());
     LOG_INFO_CTX("sampleset", "NodeID       | Mask | AC/DC | Max Freq  | Resolution | Interval | Priority | Channels");
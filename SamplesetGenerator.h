@@ -21,6 +21,11 @@ struct Sampleset {
 // Returns a compressed vector of samplesets with channel bitmasks
 std::vector<Sampleset> createSamplesets(const std::vector<Ts1xChannel>& ts1x_channels);
 
+// Oldest last_sampled_time of the channels that make up each sampleset,
+// 0 where none of them has one; result[i] belongs to samplesets[i]
+std::vector<time_t> oldestChannelSampleTimes(const std::vector<Sampleset>& samplesets,
+                                             const std::vector<Ts1xChannel>& ts1x_channels);
+
 // Helper function to print samplesets for debugging
 void printSamplesets(const std::vector<Sampleset>& samplesets);
 
@@ -0,0 +1,224 @@
+#include "SamplesetKey.h"
+
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#define SAMPLESET_KEY_RESOLUTION_MASK 0x007FFFFFu
+#define SAMPLESET_KEY_AC_BIT          0x00800000u
+#define SAMPLESET_KEY_MASK_SHIFT      24
+
+#define SAMPLESET_TABLE_MIN_CAPACITY  64
+
+namespace {
+
+#define SAMPLESET_KEY_MAX_EXACT       1e14    // |value| below this is rounded exactly (10x < 2^52)
+
+// Quantize exactly as the text key's "%.1f" does, without formatting.
+// printf rounds the exact binary value to the nearest tenth, ties to even
+// (0.25 -> "0.2", 0.35 -> "0.3", 156.25 -> "156.2"); llround(value * 10)
+// does not, because value * 10 is itself rounded.  Here 10 * value is kept
+// exactly as p + e: 8 * value and 2 * value are exact, and their sum is
+// taken with its rounding error (Fast2Sum).  Non-finite values give 0
+// and large ones clamp, as the digits printf would print did.
+int32_t to_tenths(double value) {
+    if (!std::isfinite(value)) {
+        return 0;
+    }
+    double a = std::fabs(value);
+    if (a >= SAMPLESET_KEY_MAX_EXACT) {
+        return value < 0 ? -INT32_MAX : INT32_MAX;
+    }
+
+    double high = a * 8.0;
+    double low = a * 2.0;
+    double p = high + low;
+    double e = (high - p) + low;        // 10 * a == p + e exactly
+
+    // Below 2^52 p - floor(p) - 0.5 is exact and, unless zero, larger
+    // than |e|, so e only decides exact halves
+    double t = std::floor(p);
+    double half = (p - t) - 0.5;
+    bool up = half > 0 ||
+              (half == 0 && (e > 0 || (e == 0 && std::fmod(t, 2.0) != 0)));
+    if (up) {
+        t += 1;
+    }
+    if (t > INT32_MAX) {
+        t = INT32_MAX;
+    }
+    int32_t tenths = static_cast<int32_t>(t);
+    return value < 0 ? -tenths : tenths;
+}
+
+uint32_t pack_format(int resolution, bool ac, uint8_t sampling_mask) {
+    return (static_cast<uint32_t>(resolution) & SAMPLESET_KEY_RESOLUTION_MASK) |
+           (ac ? SAMPLESET_KEY_AC_BIT : 0) |
+           (static_cast<uint32_t>(sampling_mask) << SAMPLESET_KEY_MASK_SHIFT);
+}
+
+uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+} // namespace
+
+SamplesetKey SamplesetKey::from_sampleset(const Sampleset& sampleset) {
+    SamplesetKey key;
+    key.nodeid = sampleset.nodeid;
+    key.max_freq_tenths = to_tenths(sampleset.max_freq);
+    key.interval_tenths = to_tenths(sampleset.interval);
+    key.format = pack_format(sampleset.resolution, sampleset.ac_dc_flag != 0,
+                             sampleset.sampling_mask);
+    return key;
+}
+
+bool SamplesetKey::from_text(const std::string& text, SamplesetKey* key) {
+    unsigned int nodeid = 0;
+    unsigned int mask = 0;
+    char acdc[3] = {0};
+    double max_freq = 0.0;
+    int resolution = 0;
+    double interval = 0.0;
+    int consumed = 0;
+
+    if (sscanf(text.c_str(), "0x%x_0x%x_%2[ACD]_%lf_%d_%lf%n",
+               &nodeid, &mask, acdc, &max_freq, &resolution, &interval, &consumed) != 6 ||
+        static_cast<size_t>(consumed) != text.size() || mask > 0xFF ||
+        (strcmp(acdc, "AC") != 0 && strcmp(acdc, "DC") != 0)) {
+        return false;
+    }
+
+    key->nodeid = nodeid;
+    key->max_freq_tenths = to_tenths(max_freq);
+    key->interval_tenths = to_tenths(interval);
+    key->format = pack_format(resolution, acdc[0] == 'A', static_cast<uint8_t>(mask));
+    return true;
+}
+
+std::string SamplesetKey::to_text() const {
+    char buffer[96];
+    snprintf(buffer, sizeof(buffer), "0x%08x_0x%02x_%s_%.1f_%d_%.1f",
+             nodeid,
+             format >> SAMPLESET_KEY_MASK_SHIFT,
+             (format & SAMPLESET_KEY_AC_BIT) ? "AC" : "DC",
+             max_freq_tenths / 10.0,
+             static_cast<int>(format & SAMPLESET_KEY_RESOLUTION_MASK),
+             interval_tenths / 10.0);
+    return std::string(buffer);
+}
+
+size_t SamplesetKey::hash() const {
+    uint64_t a = (static_cast<uint64_t>(nodeid) << 32) | format;
+    uint64_t b = (static_cast<uint64_t>(static_cast<uint32_t>(max_freq_tenths)) << 32) |
+                 static_cast<uint32_t>(interval_tenths);
+    return static_cast<size_t>(mix64(a ^ mix64(b)));
+}
+
+SamplesetTimeTable::SamplesetTimeTable()
+    : count_(0), mask_(0) {
+}
+
+size_t SamplesetTimeTable::probe(const SamplesetKey& key) const {
+    size_t pos = key.hash() & mask_;
+    while (slots_[pos].used && slots_[pos].key != key) {
+        pos = (pos + 1) & mask_;
+    }
+    return pos;
+}
+
+const time_t* SamplesetTimeTable::find(const SamplesetKey& key) const {
+    if (count_ == 0) {
+        return nullptr;
+    }
+    const Slot& slot = slots_[probe(key)];
+    return slot.used ? &slot.time : nullptr;
+}
+
+bool SamplesetTimeTable::set(const SamplesetKey& key, time_t time) {
+    if (slots_.empty() || (count_ + 1) * 4 > slots_.size() * 3) {
+        grow(count_ + 1);
+    }
+
+    Slot& slot = slots_[probe(key)];
+    bool is_new = !slot.used;
+    slot.key = key;
+    slot.time = time;
+    slot.used = true;
+    if (is_new) {
+        count_++;
+    }
+    return is_new;
+}
+
+bool SamplesetTimeTable::erase(const SamplesetKey& key) {
+    if (count_ == 0) {
+        return false;
+    }
+    size_t hole = probe(key);
+    if (!slots_[hole].used) {
+        return false;
+    }
+
+    // Backward-shift: pull later members of the chain into the hole
+    size_t pos = hole;
+    while (true) {
+        pos = (pos + 1) & mask_;
+        if (!slots_[pos].used) {
+            break;
+        }
+        size_t home = slots_[pos].key.hash() & mask_;
+        // Move it if its home is not cyclically within (hole, pos]
+        bool in_range = (hole <= pos) ? (hole < home && home <= pos)
+                                      : (hole < home || home <= pos);
+        if (!in_range) {
+            slots_[hole] = slots_[pos];
+            hole = pos;
+        }
+    }
+    slots_[hole].used = false;
+    count_--;
+    return true;
+}
+
+void SamplesetTimeTable::clear() {
+    for (auto& slot : slots_) {
+        slot.used = false;
+    }
+    count_ = 0;
+}
+
+void SamplesetTimeTable::reserve(size_t count) {
+    if (count * 4 > slots_.size() * 3) {
+        grow(count);
+    }
+}
+
+void SamplesetTimeTable::grow(size_t min_count) {
+    size_t capacity = SAMPLESET_TABLE_MIN_CAPACITY;
+    while (min_count * 4 > capacity * 3) {
+        capacity *= 2;
+    }
+    if (capacity <= slots_.size()) {
+        return;
+    }
+
+    std::vector<Slot> old_slots;
+    old_slots.swap(slots_);
+    slots_.assign(capacity, Slot{SamplesetKey{0, 0, 0, 0}, 0, false});
+    mask_ = capacity - 1;
+    count_ = 0;
+
+    for (const auto& slot : old_slots) {
+        if (slot.used) {
+            slots_[probe(slot.key)] = slot;
+            count_++;
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef SAMPLESETKEY_H
+#define SAMPLESETKEY_H
+
+#include "SamplesetGenerator.h"
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <vector>
+
+/**
+ * SamplesetKey - Packed 16-byte identity of a sampleset for the sample
+ * time database.
+ *
+ * Holds the same fields as the text key the database file has always used
+ * ("nodeid_mask_acdc_maxfreq_resolution_interval"), with max_freq and
+ * interval quantized to the 0.1 the text key printed, digit for digit as
+ * "%.1f" rounds them.  Two samplesets that produced the same text key
+ * produce the same SamplesetKey.  Priority is
+ * not part of the key (it is a scheduling hint, not a sampling
+ * characteristic).
+ *
+ * The text form is only used when reading and writing the database file.
+ */
+struct SamplesetKey {
+    uint32_t nodeid;
+    int32_t max_freq_tenths;    // max_freq × 10, rounded as "%.1f" prints it
+    int32_t interval_tenths;    // interval × 10, rounded as "%.1f" prints it
+    uint32_t format;            // resolution (bits 0-22) | ac/dc (bit 23) | sampling mask (bits 24-31)
+
+    static SamplesetKey from_sampleset(const Sampleset& sampleset);
+
+    /**
+     * Parse a database text key, e.g. "0x00111578_0x03_DC_0.0_0_10.0"
+     * @return false if the text is not a valid key
+     */
+    static bool from_text(const std::string& text, SamplesetKey* key);
+
+    // Database text key; identical to the key format used before packing
+    std::string to_text() const;
+
+    bool operator==(const SamplesetKey& other) const {
+        return nodeid == other.nodeid &&
+               max_freq_tenths == other.max_freq_tenths &&
+               interval_tenths == other.interval_tenths &&
+               format == other.format;
+    }
+    bool operator!=(const SamplesetKey& other) const { return !(*this == other); }
+
+    size_t hash() const;
+};
+
+static_assert(sizeof(SamplesetKey) == 16, "SamplesetKey must stay 16 bytes");
+
+/**
+ * SamplesetTimeTable - SamplesetKey -> time_t, open addressing with linear
+ * probing in one flat array.
+ *
+ * Lookups and updates of existing keys never allocate.  Capacity is a power
+ * of two kept at most 3/4 full; erase uses backward-shift deletion, so
+ * there are no tombstones and probe lengths stay short after refreshes.
+ */
+class SamplesetTimeTable {
+public:
+    struct Slot {
+        SamplesetKey key;
+        time_t time;
+        bool used;
+    };
+
+    SamplesetTimeTable();
+
+    // Pointer to the stored time, or nullptr if key is absent
+    const time_t* find(const SamplesetKey& key) const;
+
+    // Insert or overwrite; returns true if key was new
+    bool set(const SamplesetKey& key, time_t time);
+
+    // Remove key; returns true if it was present
+    bool erase(const SamplesetKey& key);
+
+    void clear();
+    void reserve(size_t count);
+
+    size_t size() const { return count_; }
+
+    // Raw slots for iteration; skip entries with used == false
+    const std::vector<Slot>& slots() const { return slots_; }
+
+private:
+    size_t probe(const SamplesetKey& key) const;   // slot holding key, or the empty slot ending its chain
+    void grow(size_t min_capacity);
+
+    std::vector<Slot> slots_;
+    size_t count_;
+    size_t mask_;
+};
+
+#endif // SAMPLESETKEY_H
@@ -0,0 +1,150 @@
+#include "SamplesetScheduler.h"
+
+#include <cmath>
+
+SamplesetScheduler::SamplesetScheduler()
+    : next_sequence_(0),
+      retry_delay_(0) {
+}
+
+time_t SamplesetScheduler::due_after(time_t sampled_at, double interval) {
+    if (sampled_at == 0) {
+        return 0;  // Never sampled - due now
+    }
+    // Elapsed whole seconds must reach the interval
+    return sampled_at + static_cast<time_t>(std::ceil(interval));
+}
+
+void SamplesetScheduler::rebuild(const std::vector<Sampleset>& samplesets,
+                                 const std::vector<time_t>& last_sample_times) {
+    entries_.clear();
+    entries_.reserve(samplesets.size());
+    heaps_[0].clear();
+    heaps_[1].clear();
+    next_sequence_ = 0;
+
+    for (size_t i = 0; i < samplesets.size(); i++) {
+        Entry entry;
+        entry.interval = samplesets[i].interval;
+        entry.due = due_after(i < last_sample_times.size() ? last_sample_times[i] : 0,
+                              entry.interval);
+        entry.ready = entry.due;
+        entry.sequence = next_sequence_++;
+        entry.heap = samplesets[i].priority ? 0 : 1;
+        entry.position = heaps_[entry.heap].size();
+        entries_.push_back(entry);
+        heaps_[entry.heap].push_back(i);
+    }
+
+    // Bottom-up heapify, O(N)
+    for (auto& heap : heaps_) {
+        for (size_t pos = heap.size() / 2; pos-- > 0; ) {
+            sift_down(heap, pos);
+        }
+    }
+}
+
+bool SamplesetScheduler::before(size_t a, size_t b) const {
+    const Entry& ea = entries_[a];
+    const Entry& eb = entries_[b];
+    if (ea.ready != eb.ready) {
+        return ea.ready < eb.ready;
+    }
+    return ea.sequence < eb.sequence;
+}
+
+void SamplesetScheduler::sift_up(std::vector<size_t>& heap, size_t pos) {
+    size_t index = heap[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!before(index, heap[parent])) {
+            break;
+        }
+        heap[pos] = heap[parent];
+        entries_[heap[pos]].position = pos;
+        pos = parent;
+    }
+    heap[pos] = index;
+    entries_[index].position = pos;
+}
+
+void SamplesetScheduler::sift_down(std::vector<size_t>& heap, size_t pos) {
+    size_t index = heap[pos];
+    size_t count = heap.size();
+    while (true) {
+        size_t child = 2 * pos + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && before(heap[child + 1], heap[child])) {
+            child++;
+        }
+        if (!before(heap[child], index)) {
+            break;
+        }
+        heap[pos] = heap[child];
+        entries_[heap[pos]].position = pos;
+        pos = child;
+    }
+    heap[pos] = index;
+    entries_[index].position = pos;
+}
+
+void SamplesetScheduler::update(size_t index) {
+    Entry& entry = entries_[index];
+    std::vector<size_t>& heap = heaps_[entry.heap];
+    size_t pos = entry.position;
+    if (pos > 0 && before(index, heap[(pos - 1) / 2])) {
+        sift_up(heap, pos);
+    } else {
+        sift_down(heap, pos);
+    }
+}
+
+bool SamplesetScheduler::next_due(time_t now, size_t* index, double* overdue_seconds) {
+    for (auto& heap : heaps_) {
+        if (heap.empty() || entries_[heap[0]].ready > now) {
+            continue;
+        }
+
+        size_t top = heap[0];
+        Entry& entry = entries_[top];
+        *index = top;
+        *overdue_seconds = entry.due ? difftime(now, entry.due) : 0.0;
+
+        // Until record_sample() moves it on, hold it back for the retry
+        // delay so a failing entry does not starve the rest
+        entry.ready = now + retry_delay_;
+        entry.sequence = next_sequence_++;
+        sift_down(heap, 0);
+        return true;
+    }
+    return false;
+}
+
+void SamplesetScheduler::record_sample(size_t index, time_t sampled_at) {
+    if (index >= entries_.size()) {
+        return;
+    }
+    Entry& entry = entries_[index];
+    entry.due = due_after(sampled_at, entry.interval);
+    entry.ready = entry.due;
+    entry.sequence = next_sequence_++;
+    update(index);
+}
+
+time_t SamplesetScheduler::get_due_time(size_t index) const {
+    return index < entries_.size() ? entries_[index].due : 0;
+}
+
+time_t SamplesetScheduler::get_next_due_time() const {
+    time_t next = 0;
+    bool found = false;
+    for (const auto& heap : heaps_) {
+        if (!heap.empty() && (!found || entries_[heap[0]].ready < next)) {
+            next = entries_[heap[0]].ready;
+            found = true;
+        }
+    }
+    return next;
+}
@@ -0,0 +1,96 @@
+#ifndef SAMPLESETSCHEDULER_H
+#define SAMPLESETSCHEDULER_H
+
+#include "SamplesetGenerator.h"
+#include <vector>
+#include <ctime>
+#include <cstdint>
+
+/**
+ * SamplesetScheduler - Next-due ordering for samplesets
+ *
+ * Keeps one indexed binary min-heap per priority class, keyed by the time
+ * each sampleset becomes eligible.  Finding the next due sampleset is a
+ * look at the heap tops; handing one out or recording a sample re-sifts a
+ * single entry, O(log N).  Nothing is formatted or looked up by string.
+ *
+ * Entries are addressed by their index in the sampleset vector the
+ * scheduler was built from; rebuild whenever that vector changes.
+ *
+ * Ordering:
+ * - A due priority sampleset is always returned before a due normal one.
+ * - Within a class the longest-eligible entry goes first.
+ * - An entry that is handed out but never recorded (sampling failed) is
+ *   held back for the retry delay before it is eligible again, so an
+ *   unreachable node - priority or not - cannot keep the head of the queue
+ *   and starve the entries behind it.
+ */
+class SamplesetScheduler {
+public:
+    SamplesetScheduler();
+
+    /**
+     * Seconds a handed-out entry waits before it is handed out again if
+     * no sample is recorded for it (0 = immediately, behind what is due)
+     */
+    void set_retry_delay(int seconds) { retry_delay_ = seconds > 0 ? seconds : 0; }
+
+    /**
+     * Rebuild from the current sampleset list
+     * @param samplesets Active samplesets (index i here is entry i)
+     * @param last_sample_times Last sample time per sampleset, 0 if never sampled
+     */
+    void rebuild(const std::vector<Sampleset>& samplesets,
+                 const std::vector<time_t>& last_sample_times);
+
+    /**
+     * Get the next sampleset that is due at now
+     * @param now Current time
+     * @param index Out: index of the sampleset
+     * @param overdue_seconds Out: seconds past its due time (0 if never sampled)
+     * @return true if one is due, false if everything is up to date
+     */
+    bool next_due(time_t now, size_t* index, double* overdue_seconds);
+
+    /**
+     * Record that entry index was sampled at sampled_at; it next falls due
+     * one interval later
+     */
+    void record_sample(size_t index, time_t sampled_at);
+
+    /**
+     * Time entry index falls due (0 = never sampled, due immediately)
+     */
+    time_t get_due_time(size_t index) const;
+
+    /**
+     * Earliest time any sampleset becomes eligible, 0 if none are scheduled
+     */
+    time_t get_next_due_time() const;
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        time_t due;         // last sample + interval, 0 if never sampled
+        time_t ready;       // heap key: when it may next be handed out
+        uint64_t sequence;  // tie-break, lower first
+        double interval;
+        uint8_t heap;       // 0 = priority, 1 = normal
+        size_t position;    // slot in its heap
+    };
+
+    bool before(size_t a, size_t b) const;
+    void sift_up(std::vector<size_t>& heap, size_t pos);
+    void sift_down(std::vector<size_t>& heap, size_t pos);
+    void update(size_t index);
+
+    static time_t due_after(time_t sampled_at, double interval);
+
+    std::vector<Entry> entries_;
+    std::vector<size_t> heaps_[2];
+    uint64_t next_sequence_;
+    int retry_delay_;
+};
+
+#endif // SAMPLESETSCHEDULER_H
@@ -1,4 +1,5 @@
 #include "SamplesetSupervisor.h"
+#include "ConfigManager.h"
 #include "logger.h"
 
 #include <sys/stat.h>
@@ -13,7 +14,7 @@ SamplesetSupervisor::SamplesetSupervisor(const std::string& ts1x_config_path,
       last_reload_time_(0),
       reload_count_(0),
       initialized_(false),
-      current_index_(0) {
+      last_overdue_seconds_(0.0) {
     
     LOG_INFO_CTX("sampleset_super", "Creating SamplesetSupervisor");
     LOG_INFO_CTX("sampleset_super", "  Config file: %s", ts1x_config_path_.c_str());
@@ -21,6 +22,8 @@ SamplesetSupervisor::SamplesetSupervisor(const std::string& ts1x_config_path,
     
     // Create database manager
     db_manager_ = new SamplesetDataManager(database_path_);
+    
+    scheduler_.set_retry_delay(ConfigManager::instance().get_sampleset_retry_delay_sec());
 }
 
 SamplesetSupervisor::~SamplesetSupervisor() {
@@ -66,7 +69,7 @@ bool SamplesetSupervisor::initialize() {
     reload_count_ = 0;
     initialized_ = true;
     
-    // Initialize round-robin scheduler
+    // Build next-due schedule
     init_index();
     
     LOG_INFO_CTX("sampleset_super", "Initialization complete");
@@ -175,6 +178,9 @@ bool SamplesetSupervisor::reload_configuration() {
     // Flush database after reload
     flush_database();
     
+    // Samplesets may have been added, removed or reordered
+    init_index();
+    
     LOG_INFO_CTX("sampleset_super", "Configuration reloaded successfully");
     LOG_INFO_CTX("sampleset_super", "  Channels: %zu -> %zu", 
                  old_channel_count, channels_.size());
@@ -202,13 +208,47 @@ bool SamplesetSupervisor::flush_database() {
     return result;
 }
 
+void SamplesetSupervisor::sync_database() {
+    if (db_manager_) {
+        db_manager_->syncIfDue();
+    }
+}
+
 void SamplesetSupervisor::record_sample(const Sampleset& sampleset) {
     if (!db_manager_) {
         LOG_ERROR_CTX("sampleset_super", "Database manager not initialized");
         return;
     }
     
-    db_manager_->recordSample(sampleset);
+    time_t now = std::time(nullptr);
+    db_manager_->recordSample(sampleset, now);
+    
+    size_t index = find_sampleset_index(sampleset);
+    if (index < samplesets_.size()) {
+        scheduler_.record_sample(index, now);
+    }
+}
+
+size_t SamplesetSupervisor::find_sampleset_index(const Sampleset& sampleset) const {
+    // Normally the caller holds a pointer from get_sampleset()
+    if (!samplesets_.empty() &&
+        &sampleset >= samplesets_.data() &&
+        &sampleset < samplesets_.data() + samplesets_.size()) {
+        return static_cast<size_t>(&sampleset - samplesets_.data());
+    }
+    
+    for (size_t i = 0; i < samplesets_.size(); i++) {
+        const Sampleset& s = samplesets_[i];
+        if (s.nodeid == sampleset.nodeid &&
+            s.sampling_mask == sampleset.sampling_mask &&
+            s.ac_dc_flag == sampleset.ac_dc_flag &&
+            s.max_freq == sampleset.max_freq &&
+            s.resolution == sampleset.resolution &&
+            s.interval == sampleset.interval) {
+            return i;
+        }
+    }
+    return samplesets_.size();
 }
 
 time_t SamplesetSupervisor::get_last_sample_time(const Sampleset& sampleset) const {
@@ -298,59 +338,53 @@ SamplesetSupervisor::Statistics SamplesetSupervisor::get_statistics() const {
     stats.config_file_modified_time = last_config_mtime_;
     stats.last_reload_time = last_reload_time_;
     stats.reload_count = reload_count_;
+    stats.next_due_time = scheduler_.get_next_due_time();
     
     return stats;
 }
 
 void SamplesetSupervisor::init_index() {
-    current_index_ = 0;
-    LOG_INFO_CTX("sampleset_super", "Round-robin scheduler initialized to index 0");
+    // One database lookup per sampleset here; get_sampleset() never touches it
+    std::vector<time_t> last_times;
+    last_times.reserve(samplesets_.size());
+    for (const auto& sampleset : samplesets_) {
+        last_times.push_back(get_last_sample_time(sampleset));
+    }
+    
+    scheduler_.rebuild(samplesets_, last_times);
+    last_overdue_seconds_ = 0.0;
+    LOG_INFO_CTX("sampleset_super", "Sampleset scheduler built with %zu entries",
+                 scheduler_.size());
 }
 
 const Sampleset* SamplesetSupervisor::get_sampleset() {
     if (!initialized_ || samplesets_.empty()) {
-        //LOG_WARN_CTX("sampleset_super", "get_sampleset called but not initialized or no samplesets");
         return nullptr;
     }
     
-    // Special case: only one sampleset
-    if (samplesets_.size() == 1) {
-        if (is_due_for_sampling(samplesets_[0])) {
-            LOG_DEBUG_CTX("sampleset_super", "Single sampleset is due for sampling");
-            return &samplesets_[0];
-        } else {
-            LOG_DEBUG_CTX("sampleset_super", "Single sampleset not yet due");
-            return nullptr;
-        }
+    size_t index = 0;
+    double overdue = 0.0;
+    if (!scheduler_.next_due(std::time(nullptr), &index, &overdue) ||
+        index >= samplesets_.size()) {
+        return nullptr;
     }
     
-    // Start search at current_index
-    size_t temp_index = current_index_;
-    size_t sampleset_count = samplesets_.size();
+    last_overdue_seconds_ = overdue;
+    const Sampleset& sampleset = samplesets_[index];
     
-    // Search through all samplesets in round-robin fashion
-    for (size_t i = 0; i < sampleset_count; i++) {
-        const Sampleset& sampleset = samplesets_[temp_index];
-        
-        // Check if this sampleset is due for sampling
-        if (is_due_for_sampling(sampleset)) {
-            // Found one! Advance current_index for next call
-            current_index_ = (temp_index + 1) % sampleset_count;
-            
-            LOG_DEBUG_CTX("sampleset_super", 
-                         "Found sampleset at index %zu (0x%08x mask=0x%02x) - advancing to %zu",
-                         temp_index, sampleset.nodeid, sampleset.sampling_mask, current_index_);
-            
-            return &samplesets_[temp_index];
-        }
-        
-        // Not due, advance to next sampleset
-        temp_index = (temp_index + 1) % sampleset_count;
+    if (scheduler_.get_due_time(index) == 0) {
+        LOG_DEBUG_CTX("sampleset_super",
+                     "Next due sampleset at index %zu (0x%08x mask=0x%02x%s) - never sampled",
+                     index, sampleset.nodeid, sampleset.sampling_mask,
+                     sampleset.priority ? " priority" : "");
+    } else {
+        LOG_DEBUG_CTX("sampleset_super",
+                     "Next due sampleset at index %zu (0x%08x mask=0x%02x%s) - %.0fs overdue",
+                     index, sampleset.nodeid, sampleset.sampling_mask,
+                     sampleset.priority ? " priority" : "", overdue);
     }
     
-    // Wrapped around - no samplesets need sampling
-    //LOG_DEBUG_CTX("sampleset_super", "No samplesets need sampling (all up to date)");
-    return nullptr;
+    return &sampleset;
 }
 
 
@@ -366,50 +400,13 @@ void SamplesetSupervisor::populate_database_from_channels() {
     int updated = 0;
     int skipped = 0;
     
-    // For each sampleset, find the OLDEST last_sampled time from its contributing channels
-    for (const auto& sampleset : samplesets_) {
-        time_t oldest_time = 0;
-        bool found_any = false;
-        
-        // Find all channels that contribute to this sampleset
-        for (const auto& channel : channels_) {
-            // Check if this channel matches the sampleset
-            uint32_t channel_nodeid = 0;
-            if (sscanf(channel.serial.c_str(), "0x%x", &channel_nodeid) != 1) {
-                continue;
-            }
-            
-            if (channel_nodeid != sampleset.nodeid) {
-                continue;
-            }
-            
-            // Check if channel type matches
-            bool is_ac = (channel.channel_type == "AC");
-            if (is_ac != (bool)sampleset.ac_dc_flag) {
-                continue;
-            }
-            
-            // Check if channel is in the sampling mask
-            uint8_t channel_bit = (1 << channel.channel_num);
-            if ((sampleset.sampling_mask & channel_bit) == 0) {
-                continue;
-            }
-            
-            // This channel contributes to this sampleset
-            // Parse the last_sampled timestamp
-            time_t channel_time = parse_timestamp(channel.last_sampled);
-            
-            if (channel_time == 0) {
-                // Invalid or missing timestamp, skip
-                continue;
-            }
-            
-            // Track the oldest timestamp
-            if (!found_any || channel_time < oldest_time) {
-                oldest_time = channel_time;
-                found_any = true;
-            }
-        }
+    // For each sampleset, the OLDEST last_sampled time from its contributing channels
+    std::vector<time_t> oldest_times = oldestChannelSampleTimes(samplesets_, channels_);
+    
+    for (size_t i = 0; i < samplesets_.size(); i++) {
+        const Sampleset& sampleset = samplesets_[i];
+        time_t oldest_time = oldest_times[i];
+        bool found_any = oldest_time != 0;
         
         // If we found a valid timestamp, update the database
         if (found_any) {
@@ -449,31 +446,3 @@ void SamplesetSupervisor::populate_database_from_channels() {
         flush_database();
     }
 }
-
-time_t SamplesetSupervisor::parse_timestamp(const std::string& timestamp_str) const {
-    // API file format: "2025-10-25 22:10:11.000"
-    // We'll parse up to seconds and ignore milliseconds
-    
-    if (timestamp_str.empty() || timestamp_str == "-") {
-        return 0;
-    }
-    
-    struct tm tm = {};
-    // Try to parse the timestamp
-    const char* result = strptime(timestamp_str.c_str(), "%Y-%m-%d %H:%M:%S", &tm);
-    
-    if (result == nullptr) {
-        // Failed to parse
-        LOG_DEBUG_CTX("sampleset_super", "Failed to parse timestamp: %s", timestamp_str.c_str());
-        return 0;
-    }
-    
-    // Convert to Unix timestamp
-    time_t timestamp = mktime(&tm);
-    if (timestamp == -1) {
-        LOG_DEBUG_CTX("sampleset_super", "mktime() failed for timestamp: %s", timestamp_str.c_str());
-        return 0;
-    }
-    
-    return timestamp;
-}
@@ -3,6 +3,7 @@
 
 #include "SamplesetGenerator.h"
 #include "SamplesetDataManager.h"
+#include "SamplesetScheduler.h"
 #include "Ts1xSamplingReader.h"
 #include <string>
 #include <vector>
@@ -63,13 +64,20 @@ public:
     bool reload_configuration();
     
     /**
-     * Flush database to disk immediately.
+     * Flush database to disk immediately: syncs the journal, and rewrites
+     * the database file when the journal is due for compaction.
      * Call periodically (e.g., every hour) or before shutdown.
      * 
      * @return true if successful, false on error
      */
     bool flush_database();
     
+    /**
+     * Sync recently recorded sample times to disk once their batch or
+     * interval is up.  Cheap when nothing is pending; call every loop pass.
+     */
+    void sync_database();
+    
     /**
      * Record that a sampleset was sampled at the current time
      * @param sampleset The sampleset that was just sampled
@@ -147,30 +155,42 @@ public:
         time_t config_file_modified_time;
         time_t last_reload_time;
         int reload_count;
+        time_t next_due_time;          // Earliest eligible time (0 = none scheduled)
     };
     Statistics get_statistics() const;
     
     /**
-     * Initialize the round-robin index to start at the first sampleset.
-     * Call this after initialization or when you want to reset the scheduler.
+     * Rebuild the next-due schedule from the current samplesets and database.
+     * Called after initialization and every configuration reload.
      */
     void init_index();
     
     /**
-     * Get the next sampleset that needs sampling using round-robin scheduling.
+     * Get the next sampleset that needs sampling.
      * 
-     * This function scans through samplesets starting at the current index,
-     * looking for one that:
-     * - Has never been sampled, OR
-     * - Has been sampled but interval has elapsed
+     * Samplesets are kept in a min-heap ordered by next-due time (see
+     * SamplesetScheduler), so this is O(log N) regardless of how many
+     * samplesets are configured.  A due priority sampleset is returned
+     * before any normal one; otherwise the longest-overdue goes first.
+     * Never-sampled samplesets are due immediately.
      * 
-     * Returns nullptr if no sampleset needs sampling (all are up to date).
-     * On success, advances current_index for the next call.
+     * If the returned sampleset is not recorded with record_sample() (the
+     * sample failed), it is held back for sampleset_retry_delay_sec
+     * (config.txt, default 60) before it is returned again, so an
+     * unreachable node cannot starve the samplesets due behind it.  When
+     * nothing else is due this is a plain wait: with a single sampleset,
+     * each failure delays the next attempt by the full retry delay.
      * 
      * @return Pointer to the next sampleset needing sampling, or nullptr if none
      */
     const Sampleset* get_sampleset();
     
+    /**
+     * Seconds the sampleset last returned by get_sampleset() was past due
+     * (0 if it had never been sampled)
+     */
+    double get_last_overdue_seconds() const { return last_overdue_seconds_; }
+    
 private:
     /**
      * Get the modification time of the configuration file
@@ -192,11 +212,9 @@ private:
     void populate_database_from_channels();
     
     /**
-     * Parse a timestamp string from the API file format.
-     * @param timestamp_str Timestamp in format "YYYY-MM-DD HH:MM:SS.mmm"
-     * @return Unix epoch time, or 0 if parsing fails
+     * Index of sampleset in samplesets_, or samplesets_.size() if absent
      */
-    time_t parse_timestamp(const std::string& timestamp_str) const;
+    size_t find_sampleset_index(const Sampleset& sampleset) const;
     
     std::string ts1x_config_path_;     // Path to TS1X sampling config file
     std::string database_path_;        // Path to sampleset database file
@@ -212,7 +230,8 @@ private:
     
     bool initialized_;                 // Whether initialize() has been called
     
-    size_t current_index_;             // Current position in round-robin scheduler
+    SamplesetScheduler scheduler_;     // Next-due ordering over samplesets_
+    double last_overdue_seconds_;      // Overdue time of the last sampleset handed out
 };
 
 #endif // SAMPLESETSUPERVISOR_H
@@ -100,6 +100,26 @@ void SessionManager::initialize_config_broadcaster(const std::string& config_dir
     }
 }
 
+void SessionManager::set_file_change_notifications(bool enable)
+{
+    nodelist_mgr->set_change_notifications(enable);
+    config_broadcaster.SetFileListCaching(enable);
+}
+
+void SessionManager::on_nodelist_changed()
+{
+    // An empty list is loaded right away; a loaded one is re-read at the
+    // end of the current pass as before
+    LOG_INFO_CTX("session_mgr", "Node list file changed");
+    nodelist_mgr->request_load();
+}
+
+void SessionManager::on_config_files_changed()
+{
+    LOG_INFO_CTX("session_mgr", "Config files directory changed");
+    config_broadcaster.InvalidateConfigFiles();
+}
+
 void SessionManager::broadcast_config_files()
 {
     if (!config_broadcast_enabled) {
@@ -176,86 +196,99 @@ void SessionManager::handle_response(const CommandResponse& response)
 
 void SessionManager::process(CommandResponse* response)
 {
-    if (!monitor_mode) {  // Monitor mode: skip TX processing
-        if (response != nullptr) {
-            // Log combined state information when processing a response
-            LOG_INFO_CTX("session_mgr", "Processing response | SessionMgr: %s | UploadMgr: %s",
-                         state_tracker.state_to_string(state_tracker.get_state()),
-                         upload_coord->get_upload_manager()->state_to_string());
-            
-            SessionState current_state = state_tracker.get_state();
+    upload_coord->poll_file_writes();
+    
+    if (response != nullptr) {
+        dispatch_response(response);
+    }
+    
+    // Run the state machine
+    process_state_machine();
+}
+
+bool SessionManager::dispatch_response(const CommandResponse* response)
+{
+    if (monitor_mode) {  // Monitor mode: skip TX processing
+        return false;
+    }
+
+    SessionState state_before = state_tracker.get_state();
+
+    // Log combined state information when processing a response
+    LOG_INFO_CTX("session_mgr", "Processing response | SessionMgr: %s | UploadMgr: %s",
+                 state_tracker.state_to_string(state_tracker.get_state()),
+                 upload_coord->get_upload_manager()->state_to_string());
+    
+    SessionState current_state = state_tracker.get_state();
+    
+    // Handle ACK responses ('1') from any state
+    if (response->command_code == CMD_ACK_INIT) {
+        // Let UploadCoordinator handle the response and decide on state transitions
+        upload_coord->handle_r_command_response(*response, state_tracker);
+        
+        // Notify command manager that ACK was received (stops retries)
+        if (current_state == STATE_COMMAND_SEQUENCE) {
+            cmd_seq_mgr->record_ack_received();
             
-            // Handle ACK responses ('1') from any state
-            if (response->command_code == CMD_ACK_INIT) {
-                // Let UploadCoordinator handle the response and decide on state transitions
-                upload_coord->handle_r_command_response(*response, state_tracker);
-                
-                // Notify command manager that ACK was received (stops retries)
-                if (current_state == STATE_COMMAND_SEQUENCE) {
-                    cmd_seq_mgr->record_ack_received();
-                    
-                    // Check if upload was initiated (node has data)
-                    if (state_tracker.get_state() == STATE_DATA_UPLOAD_INIT) {
-                        // Upload starting - cancel any settling delay
-                        awaiting_settling = false;
-                        LOG_INFO_CTX("session_mgr", 
-                                    "Node 0x%08x has data - initiating upload (cancelled settling)",
-                                    current_macid);
-                    } else {
-                        // ACK received but no data - we'll move to next node after settling
-                        LOG_INFO_CTX("session_mgr",
-                                    "Node 0x%08x ACK received with NO data - will move to next node after settling",
-                                    current_macid);
-                    }
-                }
-                
-                // Update nodelist if needed
-                if (upload_coord->has_pending_upload()) {
-                    NodeInfo* node = nodelist_mgr->find_node_by_macid(response->source_macid);
-                    if (node) {
-                        node->has_data_ready = true;
-                    }
-                    current_macid = response->source_macid;
-                }
+            // Check if upload was initiated (node has data)
+            if (state_tracker.get_state() == STATE_DATA_UPLOAD_INIT) {
+                // Upload starting - cancel any settling delay
+                awaiting_settling = false;
+                LOG_INFO_CTX("session_mgr", 
+                            "Node 0x%08x has data - initiating upload (cancelled settling)",
+                            current_macid);
+            } else {
+                // ACK received but no data - we'll move to next node after settling
+                LOG_INFO_CTX("session_mgr",
+                            "Node 0x%08x ACK received with NO data - will move to next node after settling",
+                            current_macid);
             }
-            // Handle upload data packets ('3')
-            else if (current_state == STATE_DATA_UPLOAD_ACTIVE || 
-                     current_state == STATE_DATA_UPLOAD_RETRY) {
-                // During upload, only process upload data packets (command '3')
-                // Ignore ACK_INIT responses (command '1') which may arrive during settling period
-                if (response->command_code == CMD_DATA_UPLOAD) {
-                    upload_coord->get_upload_manager()->process_upload_response(*response);
-                    
-                    // Don't bypass state machine - transition to COMPLETE state
-                    // Let process_state_machine() handle file writing and dwell logic
-                    if (upload_coord->get_upload_manager()->is_complete()) {
-                        state_tracker.transition_state(STATE_DATA_UPLOAD_COMPLETE,
-                                                      "All segments received");
-                    }
-                    // Note: Stuck segment detection and retry logic is handled by
-                    // UploadCoordinator's process_upload_active() method via timeout tracking
-                }
-                else if (response->command_code == CMD_ACK_INIT) {
-                    // Ignore stray '1' responses during upload settling period
-                    LOG_INFO_CTX("session_mgr", "Ignoring stray ACK_INIT ('1') during upload state");
-                }
-                else {
-                    LOG_INFO_CTX("session_mgr", "Received unexpected command code: '%c' (0x%02x) during upload",
-                                response->command_code, response->command_code);
-                }
+        }
+        
+        // Update nodelist if needed
+        if (upload_coord->has_pending_upload()) {
+            NodeInfo* node = nodelist_mgr->find_node_by_macid(response->source_macid);
+            if (node) {
+                node->has_data_ready = true;
             }
-            else {
-                // Unexpected command code in other states
-                if (response->command_code != CMD_ACK_INIT && response->command_code != CMD_DATA_UPLOAD) {
-                    LOG_INFO_CTX("session_mgr", "Received unexpected command code: '%c' (0x%02x)",
-                                response->command_code, response->command_code);
-                }
+            current_macid = response->source_macid;
+        }
+    }
+    // Handle upload data packets ('3')
+    else if (current_state == STATE_DATA_UPLOAD_ACTIVE || 
+             current_state == STATE_DATA_UPLOAD_RETRY) {
+        // During upload, only process upload data packets (command '3')
+        // Ignore ACK_INIT responses (command '1') which may arrive during settling period
+        if (response->command_code == CMD_DATA_UPLOAD) {
+            upload_coord->get_upload_manager()->process_upload_response(*response);
+            
+            // Don't bypass state machine - transition to COMPLETE state
+            // Let process_state_machine() handle file writing and dwell logic
+            if (upload_coord->get_upload_manager()->is_complete()) {
+                state_tracker.transition_state(STATE_DATA_UPLOAD_COMPLETE,
+                                              "All segments received");
             }
+            // Note: Stuck segment detection and retry logic is handled by
+            // UploadCoordinator's process_upload_active() method via timeout tracking
+        }
+        else if (response->command_code == CMD_ACK_INIT) {
+            // Ignore stray '1' responses during upload settling period
+            LOG_INFO_CTX("session_mgr", "Ignoring stray ACK_INIT ('1') during upload state");
+        }
+        else {
+            LOG_INFO_CTX("session_mgr", "Received unexpected command code: '%c' (0x%02x) during upload",
+                        response->command_code, response->command_code);
         }
     }
-    
-    // Run the state machine
-    process_state_machine();
+    else {
+        // Unexpected command code in other states
+        if (response->command_code != CMD_ACK_INIT && response->command_code != CMD_DATA_UPLOAD) {
+            LOG_INFO_CTX("session_mgr", "Received unexpected command code: '%c' (0x%02x)",
+                        response->command_code, response->command_code);
+        }
+    }
+
+    return state_tracker.get_state() != state_before;
 }
 
 void SessionManager::process_state_machine()
@@ -308,10 +341,12 @@ void SessionManager::process_state_machine()
                 if (!has_nodelist && has_samplesets) {
                     const Sampleset* sampleset = g_sampleset_supervisor->get_sampleset();
                     if (sampleset != nullptr) {
-                        LOG_INFO_CTX("session_mgr", "Mode 3: Sampling sampleset - Node 0x%08x, mask=0x%02x, %s",
+                        LOG_INFO_CTX("session_mgr", "Mode 3: Sampling sampleset - Node 0x%08x, mask=0x%02x, %s%s (overdue %.0fs)",
                                     sampleset->nodeid,
                                     sampleset->sampling_mask,
-                                    sampleset->ac_dc_flag ? "AC" : "DC");
+                                    sampleset->ac_dc_flag ? "AC" : "DC",
+                                    sampleset->priority ? ", priority" : "",
+                                    g_sampleset_supervisor->get_last_overdue_seconds());
                         
                         if (sample_sampleset(*sampleset)) {
                             g_sampleset_supervisor->record_sample(*sampleset);
@@ -339,10 +374,12 @@ void SessionManager::process_state_machine()
                             const Sampleset* sampleset = g_sampleset_supervisor->get_sampleset();
                             if (sampleset != nullptr) {
                                 LOG_INFO_CTX("session_mgr", 
-                                            "Mode 4: Sampling sampleset before reloading nodelist - Node 0x%08x, mask=0x%02x, %s (potential dwell %d/%d)",
+                                            "Mode 4: Sampling sampleset before reloading nodelist - Node 0x%08x, mask=0x%02x, %s%s (overdue %.0fs, potential dwell %d/%d)",
                                             sampleset->nodeid,
                                             sampleset->sampling_mask,
                                             sampleset->ac_dc_flag ? "AC" : "DC",
+                                            sampleset->priority ? ", priority" : "",
+                                            g_sampleset_supervisor->get_last_overdue_seconds(),
                                             sampleset_dwell_count + 1,
                                             max_sampleset_dwell_count);
                                 
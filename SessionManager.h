@@ -27,6 +27,9 @@ public:
     // Session control
     void handle_response(const CommandResponse& response);
     void process(CommandResponse* response = nullptr);
+    // Deliver a parsed response without running the state machine.
+    // Returns true if the session state changed.
+    bool dispatch_response(const CommandResponse* response);
     void reset_session();
     
     // Config broadcasting
@@ -39,6 +42,13 @@ public:
     void broadcast_config_files();
     bool check_periodic_broadcast();
     
+    // File change notifications (main loop's FileWatcher).  Once enabled the
+    // node list is only re-tried and the config directory only re-read
+    // when the watcher reports a change.
+    void set_file_change_notifications(bool enable);
+    void on_nodelist_changed();
+    void on_config_files_changed();
+    
     // Getters
     SessionState get_state() const { return state_tracker.get_state(); }
     SessionResult get_result() const { return state_tracker.get_result(); }
@@ -82,10 +82,11 @@ void StateLogger::write_timestamp() {
     if (!log_file) return;
     
     time_t now = time(nullptr);
-    struct tm* tm_info = localtime(&now);
+    struct tm tm_info;
+    localtime_r(&now, &tm_info);
     
     char timestamp[64];
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", tm_info);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm_info);
     
     fprintf(log_file, "[%s] ", timestamp);
 }
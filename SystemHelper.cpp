@@ -3,7 +3,6 @@
 #include "UartManager.h"
 #include "RadioManager.h"
 #include "logger.h"
-#include <sys/time.h>
 
 SystemHelper::SystemHelper(UartManager* uart_mgr, RadioManager* radio_mgr)
     : uart_manager(uart_mgr), 
@@ -19,11 +18,14 @@ SystemHelper::~SystemHelper()
 
 void SystemHelper::check_uart(pi_buffer* tx_buffer, pi_buffer* rx_buffer, pi_buffer* cmd_buffer)
 {
-    // Handle TX
-    while (!tx_buffer->empty()) {
-        char ch = tx_buffer->get_char();
-        uart_manager->transmit_char(ch);
-        buffer_modulo++;
+    // Handle TX - one write per 128-byte radio frame
+    const char* region;
+    size_t len;
+    while ((len = tx_buffer->peek(&region)) > 0) {
+        if (len > static_cast<size_t>(128 - buffer_modulo)) len = 128 - buffer_modulo;
+        uart_manager->transmit_frame(reinterpret_cast<const uint8_t*>(region), len);
+        tx_buffer->consume(len);
+        buffer_modulo += len;
         if (buffer_modulo == 128) {
             buffer_modulo = 0;
             radio_manager->wait_on_buffer_empty();
@@ -31,9 +33,10 @@ void SystemHelper::check_uart(pi_buffer* tx_buffer, pi_buffer* rx_buffer, pi_buf
     }
 
     // Handle RX - transfer from UART manager to rx_buffer
-    while (uart_manager->get_input_count() != uart_manager->get_output_count()) {
-        char ch = uart_manager->get_input_char();
-        rx_buffer->add_char(ch);
+    char chunk[RXUARTBUFF];
+    size_t n;
+    while ((n = uart_manager->read_input(chunk, sizeof(chunk))) > 0) {
+        rx_buffer->write(chunk, n);
     }
 
     // Handle commands
@@ -57,16 +60,6 @@ void SystemHelper::check_uart(pi_buffer* tx_buffer, pi_buffer* rx_buffer, pi_buf
     }
 }
 
-void SystemHelper::setup_timer(long int useconds)
-{
-    struct itimerval timer;
-    timer.it_interval.tv_usec = useconds;
-    timer.it_interval.tv_sec = 0;
-    timer.it_value.tv_usec = useconds;
-    timer.it_value.tv_sec = 0;
-    setitimer(ITIMER_REAL, &timer, NULL);
-}
-
 void SystemHelper::reset_radio_check_timestamp()
 {
     radio_check_tstamp = std::chrono::system_clock::now();
@@ -78,12 +71,4 @@ uint64_t SystemHelper::get_seconds_since_last_radio_check()
     auto elapsed_seconds = std::chrono::duration_cast<std::chrono::seconds>(
         curr_time - radio_check_tstamp);
     return elapsed_seconds.count();
-}
-
-void SystemHelper::handle_uart_interrupt()
-{
-    if (radio_manager) {
-        radio_manager->handle_uart_interrupt();
-        radio_manager->increment_interrupt_count();
-    }
 }
\ No newline at end of file
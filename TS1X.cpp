@@ -8,12 +8,15 @@
 
 CTS1X::CTS1X()
 {
-    ibuf = new char[IBUF_MAX];
+    ibuf = new char[IBUF_ALLOC];
     command_count = 0;
     icnt = 0;
     ocnt = 0;
     command_buffer = nullptr;  // Initialize to nullptr
     tx_buffer=nullptr;
+    resync_discarded_bytes = 0;
+    frame_budget = DEFAULT_FRAME_BUDGET;
+    peak_backlog_bytes = 0;
     
     // Initialize helpers - pass nullptr for command_buffer, will be set later
     utility = nullptr;  // Don't create yet
@@ -64,54 +67,60 @@ int CTS1X::get_ibuf_count(){
 
 void CTS1X::go_main(bool m_verbose)
 {
-    int sv_delta = get_ibuf_count();
-
-    if (sv_delta < CLENG) {
-        if (session_mgr) {
-            session_mgr->process(nullptr);  // No response
-        }
-        return;
+    int backlog = get_ibuf_count();
+    if (backlog > peak_backlog_bytes) {
+        peak_backlog_bytes = backlog;
     }
 
     // Warning if buffer is getting full
-    if (sv_delta > (int)(((float)IBUF_MAX) * 0.8)) {  // 80% full
+    if (backlog > (int)(((float)IBUF_MAX) * 0.8)) {  // 80% full
         LOG_WARN_CTX("ts1x_core","RX buffer is %d%% full (%d/%d bytes)", 
-                 (sv_delta * 100) / IBUF_MAX, sv_delta, IBUF_MAX);
+                 (backlog * 100) / IBUF_MAX, backlog, IBUF_MAX);
     }
 
-    // Check if we have a valid command header
-    if (utility->is_valid_command_header()) {
-        command_count++;
-
-        cmd_processor->print_command();
-
-        CommandResponse parsed_response = cmd_processor->parse_response();
-        
-        if (parsed_response.packet_valid ){
-            // Device is alive but no data
-            LOG_INFO_CTX("ts1x_core", "Node 0x%08x alive", parsed_response.source_macid);
-            cmd_processor->print_response(parsed_response);
-            if (session_mgr) {
-                session_mgr->process(&parsed_response);
+    // Parse every complete frame available (up to the budget), then run the
+    // session state machine once.  A frame that changes the session state
+    // gets a tick of its own so the next frame sees the new state.
+    int frames = 0;
+    while (frames < frame_budget && get_ibuf_count() >= CLENG) {
+        if (utility->is_valid_command_header()) {
+            command_count++;
+            frames++;
+
+            cmd_processor->print_command();
+
+            CommandResponse parsed_response = cmd_processor->parse_response();
+            
+            if (parsed_response.packet_valid ){
+                // Device is alive but no data
+                LOG_INFO_CTX("ts1x_core", "Node 0x%08x alive", parsed_response.source_macid);
+                cmd_processor->print_response(parsed_response);
+                if (session_mgr && session_mgr->dispatch_response(&parsed_response)) {
+                    session_mgr->process(nullptr);
+                }
             }
+            utility->move_buffer(CLENG);
+        } else {
+            // Not a valid command - skip straight to the next candidate frame
+            int discarded = utility->resync();
+            resync_discarded_bytes += discarded;
+            LOG_WARN_CTX("ts1x_core", "RX resync: discarded %d bytes (%llu total)",
+                         discarded, (unsigned long long)resync_discarded_bytes);
         }
-        else{
-            session_mgr->process(nullptr);
-        }
-        //printf("accept command; old/new cnt %d, ", get_ibuf_count());
-        utility->move_buffer(CLENG);
-        //printf("%d\n", get_ibuf_count());
-    } else {
-        // Not a valid command, move forward by 1 and try again
-        char trash_char=ibuf[ocnt];
-        //printf("trash char old/new cnt %d, ", get_ibuf_count());
-        utility->move_buffer(1);
-        //printf("%d char %02x (%c)\n", get_ibuf_count(),trash_char, isprint(trash_char) ? trash_char : '.');
-
-        // Process session state machine without response
-        if (session_mgr) {
-            session_mgr->process(nullptr);
-        }
+    }
+
+    if (frames > 1) {
+        LOG_DEBUG_CTX("ts1x_core", "Processed %d frames, backlog %d -> %d bytes",
+                      frames, backlog, get_ibuf_count());
+    }
+    if (frames == frame_budget && get_ibuf_count() >= CLENG) {
+        LOG_WARN_CTX("ts1x_core", "Frame budget (%d) exhausted, %d bytes still queued "
+                     "(backlog %d bytes at start, peak %d)",
+                     frame_budget, get_ibuf_count(), backlog, peak_backlog_bytes);
+    }
+
+    if (session_mgr) {
+        session_mgr->process(nullptr);
     }
 }
 
@@ -135,6 +144,22 @@ void CTS1X::scia_xmit(int ch)
     }
 }
 
+void CTS1X::scia_xmit_frame(const unsigned char* data, int length)
+{
+    if (!tx_buffer) {
+        LOG_ERROR_CTX("ts1x_core", "TX buffer not initialized!");
+        return;
+    }
+    if (tx_buffer->write(reinterpret_cast<const char*>(data), length) != static_cast<size_t>(length)) {
+        LOG_ERROR_CTX("ts1x_core", "TX buffer full!");
+    }
+}
+
+void CTS1X::set_frame_budget(int frames)
+{
+    frame_budget = frames > 0 ? frames : 1;
+}
+
 void CTS1X::set_tx_buffer(pi_buffer* tx_buffer_ptr){
     tx_buffer=tx_buffer_ptr;
 }
@@ -15,6 +15,7 @@ class Utility;
 #define RSSI_DELAY 165
 #define RSSI_INCREMENT 5
 #define BROADCAST_INTERVAL 8
+#define DEFAULT_FRAME_BUDGET 16   // max frames parsed per go_main() call
 
 
 class CTS1X
@@ -42,10 +43,16 @@ public:
     CommandProcessor* get_command_processor() { return cmd_processor; }
 
     void scia_xmit(int ch);
+    void scia_xmit_frame(const unsigned char* data, int length);
     
     pi_buffer* command_buffer;
 
     int get_ibuf_count();
+    uint64_t get_resync_discarded_bytes() const { return resync_discarded_bytes; }
+
+    // Batch frame processing
+    void set_frame_budget(int frames);
+    int get_frame_budget() const { return frame_budget; }
 
 
 protected:
@@ -53,6 +60,9 @@ protected:
     int ocnt;
     char* ibuf;
     int command_count;    
+    uint64_t resync_discarded_bytes;
+    int frame_budget;
+    int peak_backlog_bytes;   // largest backlog seen at the start of go_main()
     SessionManager* session_mgr;
     CommandProcessor* cmd_processor;
     Utility* utility;
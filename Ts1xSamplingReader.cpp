@@ -10,6 +10,43 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <time.h>
+#include <cstdlib>
+
+time_t parseTs1xTimestamp(const std::string& timestamp_str) {
+    // API file format: "2025-10-25 22:10:11.000"
+    // We'll parse up to seconds and ignore milliseconds
+    
+    if (timestamp_str.empty() || timestamp_str == "-") {
+        return 0;
+    }
+    
+    struct tm tm = {};
+    const char* result = strptime(timestamp_str.c_str(), "%Y-%m-%d %H:%M:%S", &tm);
+    if (result == nullptr) {
+        LOG_DEBUG_CTX("ts1x_reader", "Failed to parse timestamp: %s", timestamp_str.c_str());
+        return 0;
+    }
+    
+    // Convert to Unix timestamp
+    time_t timestamp = mktime(&tm);
+    if (timestamp == -1) {
+        LOG_DEBUG_CTX("ts1x_reader", "mktime() failed for timestamp: %s", timestamp_str.c_str());
+        return 0;
+    }
+    
+    return timestamp;
+}
+
+// Convert hex string like "0x00111578" to a node id, 0 if invalid
+static uint32_t parseSerial(const std::string& serial_str) {
+    const char* begin = serial_str.c_str();
+    char* end = nullptr;
+    unsigned long value = strtoul(begin, &end, 16);
+    if (end == begin || value > 0xFFFFFFFFUL) {
+        return 0;
+    }
+    return static_cast<uint32_t>(value);
+}
 
 // Parse a line from the file into a Ts1xChannel
 static bool parseLine(const std::string& line, Ts1xChannel& channel, int line_num) {
@@ -67,6 +104,10 @@ static bool parseLine(const std::string& line, Ts1xChannel& channel, int line_nu
         channel.external_input = tokens[13];
         channel.external_name = tokens[14];
         
+        channel.nodeid = parseSerial(channel.serial);
+        channel.is_ac = (channel.channel_type == "AC");
+        channel.last_sampled_time = parseTs1xTimestamp(channel.last_sampled);
+        
         return true;
     } catch (const std::exception& e) {
         LOG_ERROR_CTX("ts1x_reader", "Error parsing line %d: %s", line_num, e.what());
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <ctime>
 
 // Structure to hold TS1X/StormX channel sampling configuration data
 struct Ts1xChannel {
@@ -21,8 +23,17 @@ struct Ts1xChannel {
     int is_demod;               // Demodulation flag (0 or 1)
     std::string external_input; // External input flag ("True" or "False")
     std::string external_name;  // External input name (or "-")
+    
+    // Parsed once when the file is read
+    uint32_t nodeid;            // serial as a number, 0 if it is not valid hex
+    bool is_ac;                 // channel_type == "AC"
+    time_t last_sampled_time;   // last_sampled as epoch time, 0 if missing or invalid
 };
 
+// Parse an API file timestamp "YYYY-MM-DD HH:MM:SS[.mmm]" (local time)
+// Returns epoch time, or 0 if empty, "-" or unparseable
+time_t parseTs1xTimestamp(const std::string& timestamp_str);
+
 // Read and parse the TS1X sampling configuration file
 // Returns a vector of Ts1xChannel structures
 // On error, logs the error and returns whatever could be parsed (possibly empty)
@@ -1,15 +1,22 @@
 #include "UartManager.h"
 #include "logger.h"
+#include "pi_server_sleep.h"
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <linux/serial.h>
 #include <string.h>
 #include <cctype>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 UartManager::UartManager() 
-    : uart_filestream(-1), input_count(0), output_count(0) {
-    memset(input_buffer, 0, UART_IBUF_MAX);
+    : uart_filestream(-1), input_ring(UART_IBUF_MAX),
+      reader_running(false), epoll_fd(-1), stop_event_fd(-1) {
 }
 
 UartManager::~UartManager() {
@@ -100,10 +107,18 @@ bool UartManager::open_port(unsigned int baud, bool standard_rate) {
     }
 
     LOG_INFO_CTX("uart_manager", "serial port opened id %d", uart_filestream);
+
+    if (!start_reader()) {
+        LOG_ERROR_CTX("uart_manager", "Unable to start UART reader thread");
+        close(uart_filestream);
+        uart_filestream = -1;
+        return false;
+    }
     return true;
 }
 
 void UartManager::close_port() {
+    stop_reader();
     if (uart_filestream >= 0) {
         tcflush(uart_filestream, TCIOFLUSH);
         close(uart_filestream);
@@ -127,44 +142,177 @@ void UartManager::transmit_char(char ch) {
 }
 
 void UartManager::transmit_bytes(int length, char* data) {
-    for (int i = 0; i < length; i++) {
-        transmit_char(data[i]);
+    if (length > 0) {
+        transmit_frame(reinterpret_cast<const uint8_t*>(data), length);
+    }
+}
+
+// Write a whole frame with as few write() calls as the driver allows.
+// The port is non-blocking, so a full kernel TX buffer shows up as EAGAIN;
+// wait for POLLOUT and carry on from where the partial write stopped.
+bool UartManager::transmit_frame(const uint8_t* data, size_t length) {
+    if (uart_filestream < 0)
+        return false;
+
+    size_t sent = 0;
+    while (sent < length) {
+        ssize_t count = write(uart_filestream, data + sent, length - sent);
+        if (count > 0) {
+            sent += count;
+            continue;
+        }
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd;
+            pfd.fd = uart_filestream;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            int ready = poll(&pfd, 1, UART_TX_POLL_TIMEOUT_MS);
+            if (ready > 0 || (ready < 0 && errno == EINTR))
+                continue;
+            LOG_ERROR_CTX("uart_manager", "UART TX stalled, dropped %zu of %zu bytes",
+                          length - sent, length);
+            return false;
+        }
+        LOG_ERROR_CTX("uart_manager", "UART TX error: %s", strerror(errno));
+        return false;
     }
+    return true;
 }
 
+// Drain everything the kernel currently holds into input_ring.
+// Called from the reader thread only.
 int UartManager::receive_bytes() {
     if (uart_filestream == -1)
         return 0;
 
-    unsigned char rx_buffer[RXUARTBUFF];
-    int rx_length = read(uart_filestream, (void*)rx_buffer, RXUARTBUFF);
+    int total = 0;
+    while (true) {
+        char* region;
+        size_t space = input_ring.write_region(&region);
 
-    if (rx_length > 0) {
-        for (int i = 0; i < rx_length; i++) {
-            char ch=rx_buffer[i];
-            //printf("uart add to rx buffer (%d,%d) %d: %02x (%c)\n",input_count,output_count,i,ch,isprint(ch) ? ch : '.');
-            input_buffer[input_count++] = ch;
-            input_count &= UART_IBUF_MASK;
+        int rx_length;
+        if (space > 0) {
+            // Read straight into the contiguous free region of the ring
+            rx_length = read(uart_filestream, region, space);
+            if (rx_length > 0) {
+                input_ring.commit(rx_length);
+                total += rx_length;
+            }
+        } else {
+            // Consumer has fallen behind; keep the fd drained and count the loss
+            unsigned char discard[RXUARTBUFF];
+            rx_length = read(uart_filestream, discard, RXUARTBUFF);
+            if (rx_length > 0) {
+                if (input_ring.get_overflow_events() == 0) {
+                    LOG_WARN_CTX("uart_manager", "UART input ring full, dropping bytes");
+                }
+                input_ring.note_overflow(rx_length);
+            }
         }
-    }
-    return rx_length;
-}
 
-char UartManager::get_input_char() {
-    char ch = input_buffer[output_count++];
-    //printf("uart take from rx buffer (%d,%d) %x\n",input_count,output_count,ch);
-    output_count &= UART_IBUF_MASK;
-    return ch;
+        if (rx_length <= 0) {
+            if (rx_length < 0 && errno == EINTR) continue;
+            break;
+        }
+    }
+    return total;
 }
 
-
+// Discard everything received so far.  Only the consumer index moves, so this
+// is safe while the reader thread is running.
 void UartManager::reset_buffers() {
-    input_count = 0;
-    output_count = 0;
+    input_ring.discard_all();
 }
 
 void UartManager::flush_buffers() {
     if (uart_filestream >= 0) {
         tcflush(uart_filestream, TCIOFLUSH);
     }
-}
\ No newline at end of file
+}
+
+bool UartManager::start_reader() {
+    if (reader_running.load()) {
+        return true;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    stop_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd < 0 || stop_event_fd < 0) {
+        LOG_ERROR_CTX("uart_manager", "epoll/eventfd setup failed: %s", strerror(errno));
+        stop_reader();
+        return false;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = uart_filestream;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, uart_filestream, &ev) < 0) {
+        LOG_ERROR_CTX("uart_manager", "epoll_ctl(uart) failed: %s", strerror(errno));
+        stop_reader();
+        return false;
+    }
+    ev.data.fd = stop_event_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_event_fd, &ev) < 0) {
+        LOG_ERROR_CTX("uart_manager", "epoll_ctl(stop) failed: %s", strerror(errno));
+        stop_reader();
+        return false;
+    }
+
+    // Process signals stay with the main thread
+    sigset_t all_signals, old_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &old_signals);
+    reader_running.store(true);
+    reader_thread = std::thread(&UartManager::reader_loop, this);
+    pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+
+    LOG_INFO_CTX("uart_manager", "UART reader thread started on fd %d", uart_filestream);
+    return true;
+}
+
+void UartManager::stop_reader() {
+    if (reader_running.exchange(false)) {
+        uint64_t one = 1;
+        if (write(stop_event_fd, &one, sizeof(one)) < 0) {
+            LOG_ERROR_CTX("uart_manager", "Unable to signal UART reader thread");
+        }
+    }
+    if (reader_thread.joinable()) {
+        reader_thread.join();
+    }
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+    if (stop_event_fd >= 0) {
+        close(stop_event_fd);
+        stop_event_fd = -1;
+    }
+}
+
+void UartManager::reader_loop() {
+    struct epoll_event events[2];
+
+    while (reader_running.load(std::memory_order_relaxed)) {
+        int n = epoll_wait(epoll_fd, events, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR_CTX("uart_manager", "epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.fd == stop_event_fd) {
+                return;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                LOG_ERROR_CTX("uart_manager", "UART fd error (events 0x%x)", events[i].events);
+                Server_sleep_ms(100);  // level-triggered; don't spin on a dead port
+            }
+            receive_bytes();
+        }
+    }
+}
@@ -2,41 +2,64 @@
 #define UART_MANAGER_H
 
 #include <termios.h>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include "pi_buffer.h"
 
 // UART buffer settings
 #define RXUARTBUFF 1024
-#define UART_IBUF_MASK 0xFFF
 #define UART_IBUF_MAX 4096
+#define UART_TX_POLL_TIMEOUT_MS 1000
 
+// UartManager owns the serial port and a dedicated reader thread.
+//
+// The reader thread blocks in epoll on the UART fd and copies whatever the
+// kernel has into input_ring as soon as it arrives.  input_ring is a
+// single-producer/single-consumer pi_buffer: the reader thread is the only
+// producer and the protocol (main) thread the only consumer.
 class UartManager {
 private:
     int uart_filestream;
-    char input_buffer[UART_IBUF_MAX];
-    int input_count;
-    int output_count;
+    pi_buffer input_ring;
+
+    // Reader thread
+    std::thread reader_thread;
+    std::atomic<bool> reader_running;
+    int epoll_fd;
+    int stop_event_fd;
 
     bool setup_serial_baudrate(unsigned int baud, bool standard_rate);
+    bool start_reader();
+    void stop_reader();
+    void reader_loop();
 
 public:
     UartManager();
     ~UartManager();
 
     bool open_port(unsigned int baud, bool standard_rate = true);
+    // Stops and joins the reader thread, then closes the fd.  Call from the
+    // main thread's shutdown path, never from a signal handler.
     void close_port();
     bool is_open() const { return uart_filestream >= 0; }
     int get_fd() const { return uart_filestream; }
 
-    // Buffer access
-    int get_input_count() const { return input_count; }
-    int get_output_count() const { return output_count; }
-    char get_input_char();
+    // Buffer access (consumer side)
+    int get_rx_count() const { return input_ring.get_count(); }
+    uint64_t get_rx_overflow_bytes() const { return input_ring.get_overflow_bytes(); }
+    uint64_t get_rx_overflow_events() const { return input_ring.get_overflow_events(); }
+    char get_input_char() { return input_ring.get_char(); }
+    size_t read_input(char* data, size_t len) { return input_ring.read(data, len); }
     void reset_buffers();
 
     // UART operations
     void transmit_char(char ch);
     void transmit_bytes(int length, char* data);
+    bool transmit_frame(const uint8_t* data, size_t length);
     int receive_bytes();
     void flush_buffers();
 };
 
-#endif // UART_MANAGER_H
\ No newline at end of file
+#endif // UART_MANAGER_H
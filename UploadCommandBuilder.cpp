@@ -3,7 +3,6 @@
 #include <cstring>
 #include <cstdio>
 #include <algorithm>
-#include <unordered_set>
 #include <cmath>
 
 UploadCommandBuilder::UploadCommandBuilder()
@@ -83,106 +82,121 @@ std::vector<uint8_t> UploadCommandBuilder::build_full_upload_command(
     
     return cmd_buffer;
 }
-/**
- * Count how many missing segments fall within a bitmap window
- * 
- * @param start_segment Starting segment of the window
- * @param missing_segments List of missing segment numbers (must be sorted)
- * @param max_segments_per_bitmap Size of bitmap window (532)
- * @return Number of missing segments in range [start_segment, start_segment + max_segments_per_bitmap)
- */
-int UploadCommandBuilder::count_segments_in_window(
-    int start_segment,
-    const std::vector<int>& missing_segments,
-    int max_segments_per_bitmap) const
-{
-    int end_segment = start_segment + max_segments_per_bitmap;
-    int count = 0;
-    
-    for (int seg : missing_segments) {
-        if (seg < start_segment) continue;
-        if (seg >= end_segment) break;
-        count++;
-    }
-    
-    return count;
-}
-
 /**
  * Find optimal starting segment for 0x55 partial upload command
  * 
- * Strategy: Scan systematic positions across the entire segment space to find
- * the region with the highest concentration of missing segments. This ensures
- * consistent performance regardless of packet loss patterns.
+ * Strategy: some best window always starts on a missing segment, so try
+ * each missing[i] as the start and advance a second index j past the last
+ * missing segment inside [missing[i], missing[i] + max_segments_per_bitmap).
+ * Both indices only move forward, so this is a single pass over the list
+ * and finds the exact densest window, not an approximation on a grid.
  * 
- * Early exit: If we find a window that captures all missing segments or fills
- * the bitmap completely, return immediately (can't do better).
+ * Early exit: once a window captures all remaining missing segments or
+ * fills the bitmap completely, nothing later can do better.
  * 
  * @param missing_segments List of missing segment numbers (must be sorted)
- * @param total_segments Total number of segments in the upload
  * @param max_segments_per_bitmap Maximum segments per 0x55 command (532)
+ * @param out_covered Optional: missing segments covered by the chosen window
  * @return Optimal starting segment, or -1 if no missing segments
  */
 int UploadCommandBuilder::find_optimal_start_segment(
     const std::vector<int>& missing_segments,
-    int total_segments,
-    int max_segments_per_bitmap) const
+    int max_segments_per_bitmap,
+    int* out_covered) const
 {
     if (missing_segments.empty()) {
+        if (out_covered) *out_covered = 0;
         return -1;
     }
     
-    // If few segments remaining, just use first missing (no optimization needed)
-    if (missing_segments.size() < LinkTiming::BITMAP_OPTIMIZATION_THRESHOLD) {
-        return missing_segments[0];
-    }
-    
-    int best_start = missing_segments[0];
-    int best_count = 0;
-    
-    const int scan_stride = LinkTiming::BITMAP_SCAN_STRIDE;  // 28
     const int total_missing = missing_segments.size();
-    
-    // Calculate the maximum possible count we could achieve
-    // It's the minimum of: total missing segments OR bitmap capacity
     const int max_possible_count = std::min(total_missing, max_segments_per_bitmap);
     
-    // Strategy: Scan systematic positions across the entire segment space
-    // This ensures consistent ~19 evaluations (532÷28 or ~19) regardless of where
-    // missing segments happen to fall due to random packet loss
+    int best_start = missing_segments[0];
+    int best_count = 0;
     
-    // Phase 1: Scan every scan_stride-th position (0, 28, 56, 84, 112, ...)
-    // This provides systematic coverage across the entire segment space
-    for (int scan_pos = 0; scan_pos < total_segments; scan_pos += scan_stride) {
-        int count = count_segments_in_window(scan_pos, missing_segments, 
-                                            max_segments_per_bitmap);
+    int j = 0;
+    for (int i = 0; i < total_missing; i++) {
+        const int window_end = missing_segments[i] + max_segments_per_bitmap;
+        if (j < i) j = i;
+        while (j < total_missing && missing_segments[j] < window_end) {
+            j++;
+        }
         
+        const int count = j - i;
         if (count > best_count) {
-            best_start = scan_pos;
+            best_start = missing_segments[i];
             best_count = count;
-            
-            // Early exit: If we've captured all missing segments OR filled the bitmap,
-            // we've found the perfect solution - no need to keep searching
             if (best_count >= max_possible_count) {
-                return best_start;
+                break;
             }
         }
+        
+        // Windows starting later can only hold what is left
+        if (total_missing - i - 1 <= best_count) {
+            break;
+        }
+    }
+    
+    if (out_covered) *out_covered = best_count;
+    return best_start;
+}
+
+
+int UploadCommandBuilder::plan_partial_windows(
+    const std::vector<int>& missing_segments,
+    int max_segments_per_bitmap,
+    int max_windows,
+    std::vector<int>& out_starts) const
+{
+    out_starts.clear();
+    if (missing_segments.empty() || max_windows <= 0) {
+        return 0;
+    }
+    
+    // Minimal covering: open a window at the first uncovered missing
+    // segment and skip everything it spans
+    std::vector<int> counts;
+    const int total_missing = missing_segments.size();
+    for (int i = 0; i < total_missing; ) {
+        const int start = missing_segments[i];
+        int j = i;
+        while (j < total_missing && missing_segments[j] < start + max_segments_per_bitmap) {
+            j++;
+        }
+        out_starts.push_back(start);
+        counts.push_back(j - i);
+        i = j;
     }
     
-    // Phase 2: Check first missing segment (if we haven't already found perfect solution)
-    // This is often optimal for sequential loss patterns (e.g., timeout after segment N)
-    int first_count = count_segments_in_window(missing_segments[0], missing_segments,
-                                              max_segments_per_bitmap);
+    if ((int)out_starts.size() <= max_windows) {
+        return total_missing;
+    }
     
-    if (first_count > best_count) {
-        best_start = missing_segments[0];
-        best_count = first_count;
-        
-        // Note: No need to check for perfect here - if first was perfect,
-        // Phase 1 would have found it (since we always check scan position 0)
+    // Too many windows for one burst
+    if (max_windows == 1) {
+        int covered = 0;
+        out_starts.assign(1, find_optimal_start_segment(missing_segments, max_segments_per_bitmap,
+                                                        &covered));
+        return covered;
     }
     
-    return best_start;
+    // Keep the densest windows of the covering (earliest first on ties)
+    std::vector<int> order(out_starts.size());
+    for (size_t k = 0; k < order.size(); k++) order[k] = k;
+    std::stable_sort(order.begin(), order.end(),
+                     [&counts](int a, int b) { return counts[a] > counts[b]; });
+    order.resize(max_windows);
+    std::sort(order.begin(), order.end());
+    
+    std::vector<int> chosen;
+    int covered = 0;
+    for (int k : order) {
+        chosen.push_back(out_starts[k]);
+        covered += counts[k];
+    }
+    out_starts.swap(chosen);
+    return covered;
 }
 
 
@@ -194,12 +208,9 @@ std::vector<uint8_t> UploadCommandBuilder::build_partial_upload_command(
     int *total_segments_used
     ) const
 {
-    std::vector<uint8_t> cmd_buffer(128, 0x30);  // Initialize with padding
-    
     // OPTIMIZATION: Find better start segment based on density
     int optimized_start = find_optimal_start_segment(
         missing_segments,
-        total_segments,
         LinkTiming::UPLOAD_MAX_SEGMENTS_PER_0X55
     );
     
@@ -208,6 +219,20 @@ std::vector<uint8_t> UploadCommandBuilder::build_partial_upload_command(
         start_segment = optimized_start;
     }
     
+    return build_partial_upload_command_at(macid, start_segment, missing_segments,
+                                           total_segments, total_segments_used);
+}
+
+std::vector<uint8_t> UploadCommandBuilder::build_partial_upload_command_at(
+    uint32_t macid,
+    int start_segment,
+    const std::vector<int>& missing_segments,
+    int total_segments,
+    int *total_segments_used
+    ) const
+{
+    std::vector<uint8_t> cmd_buffer(128, 0x30);  // Initialize with padding
+    
     int idx = 0;
     
     // Header
@@ -255,7 +280,10 @@ std::vector<uint8_t> UploadCommandBuilder::build_partial_upload_command(
     
     // Build bitmask (76 bytes) starting from the optimized segment
     unsigned char bitmask[76];
-    *total_segments_used=build_segment_bitmask(bitmask, start_segment, missing_segments, total_segments);
+    int segments_used = build_segment_bitmask(bitmask, start_segment, missing_segments, total_segments);
+    if (total_segments_used) {
+        *total_segments_used = segments_used;
+    }
     memcpy(&cmd_buffer[idx], bitmask, 76);
     idx += 76;
     
@@ -276,8 +304,9 @@ int UploadCommandBuilder::build_segment_bitmask(
     memset(bitmask, 0x01, 76);
     int total_segments_used=0;
     
-    // Create a set for O(1) lookup of missing segments
-    std::unordered_set<int> missing_set(missing_segments.begin(), missing_segments.end());
+    // Walk the sorted missing list alongside the bitmap
+    auto next_missing = std::lower_bound(missing_segments.begin(), missing_segments.end(),
+                                         start_segment);
     
     int current_segment = start_segment;
     
@@ -295,7 +324,8 @@ int UploadCommandBuilder::build_segment_bitmask(
             }
             
             // Check if this segment is missing
-            if (missing_set.find(current_segment) != missing_set.end()) {
+            if (next_missing != missing_segments.end() && *next_missing == current_segment) {
+                ++next_missing;
                 // Segment is missing - set the bit to 1
                 byte_value |= (1 << bit);
                 total_segments_used++;
@@ -29,42 +29,62 @@ public:
         int total_segments,
         int* out_segments_used = nullptr) const;
     
-private:
     /**
-     * Find optimal starting segment for 0x55 partial upload command
+     * Build a 0x55 partial upload command whose bitmap starts exactly at
+     * start_segment (no start optimization)
+     */
+    std::vector<uint8_t> build_partial_upload_command_at(
+        uint32_t macid,
+        int start_segment,
+        const std::vector<int>& missing_segments,
+        int total_segments,
+        int* out_segments_used = nullptr) const;
+    
+    /**
+     * Split the missing set into bitmap windows for one retry burst
      * 
-     * Scans systematic positions across the entire segment space to find
-     * the region with the highest concentration of missing segments.
+     * If max_windows windows can cover every missing segment, returns the
+     * minimal covering (greedy from the first missing segment, which is
+     * optimal for fixed-width windows).  Otherwise returns the max_windows
+     * densest windows of that covering (or, for a single window, the exact
+     * densest window).  Windows never overlap.
      * 
      * @param missing_segments List of missing segment numbers (must be sorted)
-     * @param total_segments Total number of segments in the upload
      * @param max_segments_per_bitmap Maximum segments per 0x55 command (532)
-     * @return Optimal starting segment, or -1 if no missing segments
+     * @param max_windows Maximum windows in the burst
+     * @param out_starts Ascending window start segments
+     * @return Number of missing segments covered by the windows
      */
-    int find_optimal_start_segment(
+    int plan_partial_windows(
         const std::vector<int>& missing_segments,
-        int total_segments,
-        int max_segments_per_bitmap) const;
+        int max_segments_per_bitmap,
+        int max_windows,
+        std::vector<int>& out_starts) const;
     
+private:
     /**
-     * Count how many missing segments fall within a bitmap window
+     * Find optimal starting segment for 0x55 partial upload command
+     * 
+     * Slides a bitmap-sized window over the sorted missing list (two
+     * pointers) and returns the start that covers the most missing
+     * segments; the earliest such start wins ties.  O(missing).
      * 
-     * @param start_segment Starting segment of the window
      * @param missing_segments List of missing segment numbers (must be sorted)
-     * @param max_segments_per_bitmap Size of bitmap window (532)
-     * @return Number of missing segments in range [start_segment, start_segment + max_segments_per_bitmap)
+     * @param max_segments_per_bitmap Maximum segments per 0x55 command (532)
+     * @param out_covered Optional: missing segments covered by the chosen window
+     * @return Optimal starting segment, or -1 if no missing segments
      */
-    int count_segments_in_window(
-        int start_segment,
+    int find_optimal_start_segment(
         const std::vector<int>& missing_segments,
-        int max_segments_per_bitmap) const;
+        int max_segments_per_bitmap,
+        int* out_covered = nullptr) const;
     
     /**
      * Build the segment bitmask for a 0x55 command
      * 
      * @param bitmask Output buffer for bitmap bytes (must be at least 76 bytes)
      * @param start_segment First segment number in the bitmap
-     * @param missing_segments List of missing segment numbers
+     * @param missing_segments List of missing segment numbers (must be sorted)
      * @param total_segments Total segments in upload
      * @return Number of segments represented in the bitmask
      */
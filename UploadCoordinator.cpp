@@ -4,6 +4,7 @@
 #include "SessionTimeoutTracker.h"
 #include "ConfigManager.h"
 #include "WriteOutputFiles.h"
+#include "FileWriterThread.h"
 #include "LinkTimingConstants.h"
 #include "logger.h"
 #include "StateLogger.h"
@@ -18,10 +19,12 @@ UploadCoordinator::UploadCoordinator(CTS1X* core)
       r_command_received_ack(false)
 {
     upload_mgr = new UploadManager(core);
+    file_writer = new FileWriterThread(ConfigManager::instance().get_upload_writer_queue_depth());
 }
 
 UploadCoordinator::~UploadCoordinator()
 {
+    delete file_writer;  // writes anything still queued
     delete upload_mgr;
 }
 
@@ -55,6 +58,8 @@ void UploadCoordinator::log_upload_result(bool success, uint32_t macid, const st
     int total = upload_mgr->get_total_segments();
     int retries = upload_mgr->get_retry_count();
     double link_rate = upload_mgr->get_link_rate_percent();
+    unsigned timeouts = upload_mgr->get_session_timeouts();
+    unsigned spurious = upload_mgr->get_session_spurious_retries();
     
     // Calculate completion percentage
     double completion_pct = (total > 0) ? (100.0 * received / total) : 0.0;
@@ -65,21 +70,23 @@ void UploadCoordinator::log_upload_result(bool success, uint32_t macid, const st
     
     // Single unified log line - easily greppable with "UPLOAD_RESULT:"
     LOG_STATE("UPLOAD_RESULT: %s | Node: 0x%08X | Duration: %d.%03d s | "
-              "Segments: %d/%d (%.1f%%) | Retries: %d | Link: %.1f%% | Reason: %s",
+              "Segments: %d/%d (%.1f%%) | Retries: %d | Timeouts: %u (%u spurious) | Link: %.1f%% | Reason: %s",
               success ? "SUCCESS" : "FAILED",
               macid,
               duration_sec, duration_ms_part,
               received, total, completion_pct,
               retries,
+              timeouts, spurious,
               link_rate,
               reason.c_str());
     LOG_INFO_CTX("upload_coord","UPLOAD_RESULT: %s | Node: 0x%08X | Duration: %d.%03d s | "
-              "Segments: %d/%d (%.1f%%) | Retries: %d | Link: %.1f%% | Reason: %s",
+              "Segments: %d/%d (%.1f%%) | Retries: %d | Timeouts: %u (%u spurious) | Link: %.1f%% | Reason: %s",
               success ? "SUCCESS" : "FAILED",
               macid,
               duration_sec, duration_ms_part,
               received, total, completion_pct,
               retries,
+              timeouts, spurious,
               link_rate,
               reason.c_str());
 }
@@ -143,23 +150,42 @@ void UploadCoordinator::complete_upload_and_write_files(uint32_t macid,
     // Log unified upload result - SINGLE SOURCE OF TRUTH
     log_upload_result(true, macid, completion_path);
     
-    // Write output files
-    std::string root_filehandler = ConfigManager::instance().get_root_filehandler();
-    std::string config_files_dir = ConfigManager::instance().get_config_files_directory();
-    std::string ts1_data_files = ConfigManager::instance().get_ts1_data_files();
-    std::vector<int16_t> upload_data = upload_mgr->get_data();
     const CommandResponse* trigger_response = upload_mgr->get_triggering_response();
-    
-    OutputFileInfo file_info = write_output_files(root_filehandler, config_files_dir, 
-                                                   ts1_data_files, upload_data, trigger_response);
-    
-    // Log the written filenames
-    if (file_info.success) {
-        LOG_STATE("FILES WRITTEN: DC=%s | DATA=%s", 
-                  file_info.dc_filename.c_str(),
-                  file_info.data_filename.c_str());
-    } else {
+    if (!trigger_response) {
+        LOG_ERROR_CTX("upload_coord", "No triggering response for node 0x%08X - cannot write files", macid);
         LOG_STATE("FILE WRITE ERROR: Failed to write output files for node 0x%08X", macid);
+        return;
+    }
+    
+    // Hand the samples and header to the writer thread; the files are
+    // reported by poll_file_writes() once written
+    FileWriteJob job;
+    job.macid = macid;
+    upload_mgr->take_data(job.samples);
+    job.trigger = *trigger_response;
+    job.root_filehandler = ConfigManager::instance().get_root_filehandler();
+    job.config_files_directory = ConfigManager::instance().get_config_files_directory();
+    job.ts1_data_files = ConfigManager::instance().get_ts1_data_files();
+    file_writer->submit(std::move(job));
+}
+
+void UploadCoordinator::poll_file_writes()
+{
+    FileWriteResult result;
+    while (file_writer->poll_result(result)) {
+        // Log the written filenames
+        if (result.files.success) {
+            LOG_STATE("FILES WRITTEN: DC=%s | DATA=%s", 
+                      result.files.dc_filename.c_str(),
+                      result.files.data_filename.c_str());
+        } else {
+            LOG_STATE("FILE WRITE ERROR: Failed to write output files for node 0x%08X", result.macid);
+        }
+        LOG_INFO_CTX("upload_coord", "Files for node 0x%08X written in %lld ms after %lld ms queued "
+                     "(queue depth %zu, max %zu, slowest write %lld ms)",
+                     result.macid, (long long)result.write_ms, (long long)result.wait_ms,
+                     result.queue_depth, file_writer->get_max_queue_depth(),
+                     (long long)file_writer->get_max_write_ms());
     }
 }
 
@@ -186,7 +212,7 @@ void UploadCoordinator::process_upload_init(SessionStateTracker& state_tracker,
                          "starting %lld ms settling before 0x51",
                          current_macid, pending_upload_data_length,
                          (pending_upload_data_length + 31) / 32,
-                         LinkTiming::UPLOAD_INIT_STATE_TIMEOUT_MS);
+                         (long long)upload_mgr->get_init_settle_ms());
             
             // Log to state logger
             LOG_STATE("UPLOAD START: Node 0x%08X | Samples: %d | Segments: %d",
@@ -210,7 +236,7 @@ void UploadCoordinator::process_upload_init(SessionStateTracker& state_tracker,
         // Wait for settling delay, then send 0x51
         int64_t elapsed_ms = timeout_tracker.get_elapsed_ms();
         
-        if (elapsed_ms >= LinkTiming::UPLOAD_INIT_STATE_TIMEOUT_MS) {
+        if (elapsed_ms >= upload_mgr->get_init_settle_ms()) {
             LOG_INFO_CTX("upload_coord", "Settling complete, sending 0x51 command (after %lld ms)", 
                         elapsed_ms);
             if (upload_mgr->send_init_command()) {
@@ -239,6 +265,7 @@ void UploadCoordinator::evaluate_and_handle_timeout(SessionStateTracker& state_t
     
     // Check for timeout using adaptive timeout
     if (ms_since_packet > adaptive_timeout) {
+        upload_mgr->note_timeout();
         std::string reason;
         LOG_INFO_CTX("upload_coord", 
                   "Packet timeout: waited %" PRId64 " ms (threshold: %d ms)",
@@ -449,6 +476,7 @@ void UploadCoordinator::process_upload_retry(SessionStateTracker& state_tracker,
     if (upload_mgr->get_ms_since_last_packet() > retry_timeout) {
         LOG_WARN_CTX("upload_coord", "No response to 0x55 retry after %d ms, re-sending", 
                     retry_timeout);
+        upload_mgr->note_timeout();
         
         // Check if we've exceeded max retries
         if (upload_mgr->get_retry_count() >= upload_mgr->get_max_retries()) {
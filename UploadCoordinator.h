@@ -8,6 +8,7 @@
 
 class CTS1X;  // Forward declaration
 class UploadManager;
+class FileWriterThread;
 class SessionTimeoutTracker;
 
 class UploadCoordinator
@@ -56,9 +57,12 @@ public:
     // Touch alive file for a node
     void touch_alive_file(uint32_t macid);
     
-    // Complete upload and write files
+    // Complete upload and queue its files for the writer thread
     void complete_upload_and_write_files(uint32_t macid, const std::string& completion_path);
     
+    // Report uploads the writer thread has finished (call every loop pass)
+    void poll_file_writes();
+    
 private:
     // Unified upload result logging - single source of truth for all upload outcomes
     void log_upload_result(bool success, uint32_t macid, const std::string& reason);
@@ -70,6 +74,7 @@ private:
     // State
     CTS1X* ts1x_core;
     UploadManager* upload_mgr;
+    FileWriterThread* file_writer;
     
     // Upload response tracking
     CommandResponse pending_upload_response;
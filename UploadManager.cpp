@@ -15,7 +15,8 @@ UploadManager::UploadManager(CTS1X* core)
       retry_count(0),
       max_retries(LinkTiming::UPLOAD_MAX_RETRY_COUNT),
       retry_timeout_ms(LinkTiming::UPLOAD_RETRY_TIMEOUT_MS),
-      triggering_response(nullptr)
+      segments_per_packet(1),
+      has_triggering_response(false)
 {
     LOG_INFO_CTX("upload_mgr", "UploadManager initialized (max_retries=%d, retry_timeout=%d ms)", 
                  max_retries, retry_timeout_ms);
@@ -23,11 +24,6 @@ UploadManager::UploadManager(CTS1X* core)
 
 UploadManager::~UploadManager()
 {
-    // Clean up stored response if it exists
-    if (triggering_response) {
-        delete triggering_response;
-        triggering_response = nullptr;
-    }
 }
 
 const char* UploadManager::state_to_string(UploadState state) const
@@ -79,6 +75,8 @@ void UploadManager::transition_state(UploadState new_state, const std::string& r
 void UploadManager::reset()
 {
     segment_tracker.reset();
+    active_windows.clear();
+    segments_per_packet = 1;
     timeout_manager.reset();
     statistics.reset();
     
@@ -88,11 +86,8 @@ void UploadManager::reset()
     upload_length = 0;
     retry_count = 0;
     
-    // Clean up stored response
-    if (triggering_response) {
-        delete triggering_response;
-        triggering_response = nullptr;
-    }
+    // Drop stored response
+    has_triggering_response = false;
 }
 
 void UploadManager::reset_for_retry()
@@ -102,6 +97,7 @@ void UploadManager::reset_for_retry()
     
     segment_tracker.reset();
     segment_tracker.initialize(total_segments);
+    active_windows.clear();
     
     retry_count++;  // Increment retry counter
     
@@ -135,6 +131,16 @@ void UploadManager::reset_packet_timer()
     timeout_manager.reset_packet_timer();
 }
 
+void UploadManager::note_timeout()
+{
+    timeout_manager.on_timeout();
+}
+
+int64_t UploadManager::get_init_settle_ms() const
+{
+    return timeout_manager.get_init_settle_ms();
+}
+
 int64_t UploadManager::get_expected_upload_time_ms() const
 {
     return timeout_manager.get_expected_upload_time_ms(segment_tracker.get_total_count());
@@ -188,12 +194,20 @@ bool UploadManager::start_full_upload(uint32_t macid, uint32_t start_addr, uint3
     // Initialize segment tracker
     segment_tracker.initialize(total_segs);
     
-    // Start timeout tracking
-    timeout_manager.start_session(total_segs);
+    // Start timeout tracking (picks up what we learned about this node)
+    timeout_manager.start_session(macid, total_segs);
+    const LinkEstimate* link = timeout_manager.get_link_estimate();
+    if (link && link->reply.valid()) {
+        LOG_INFO_CTX("upload_mgr", "Link estimate for 0x%08x: reply %.0f±%.0f ms (%u), gap %.0f±%.0f ms (%u), %u timeouts, %u spurious",
+                     macid, link->reply.smoothed_ms, link->reply.variance_ms, link->reply.samples,
+                     link->gap.smoothed_ms, link->gap.variance_ms, link->gap.samples,
+                     link->timeouts, link->spurious_retries);
+    }
     
     // Store a copy of the triggering response for file writing later
     if (triggering_resp) {
-        triggering_response = new CommandResponse(*triggering_resp);
+        triggering_response = *triggering_resp;
+        has_triggering_response = true;
     }
     
     transition_state(UPLOAD_INIT, "Upload session initialized");
@@ -231,19 +245,20 @@ bool UploadManager::send_init_command_0x55()
     // At this point, segment_tracker has all segments marked as not received (missing)
     
     int start_segment = 0;  // Always start from segment 0
-    std::vector<int> missing = segment_tracker.get_missing_segments();
+    segment_tracker.get_missing_segments(missing_scratch);
     
     // Build command using command builder (with automatic optimization)
     int total_segments_used;
     std::vector<uint8_t> cmd = command_builder.build_partial_upload_command(
         current_macid,
         start_segment,
-        missing,
+        missing_scratch,
         segment_tracker.get_total_count(),
         &total_segments_used);
 
     // Send command
     ts1x_core->send_command(cmd.data(), cmd.size());
+    timeout_manager.on_command_sent(false);
     
     transition_state(UPLOAD_COMMAND_SENT, "Sent 0x55 upload init command (partial mode)");
     
@@ -269,6 +284,7 @@ bool UploadManager::send_upload_command_0x51(uint32_t start_addr, uint32_t lengt
     
     // Send command
     ts1x_core->send_command(cmd.data(), cmd.size());
+    timeout_manager.on_command_sent(false);
     
     transition_state(UPLOAD_COMMAND_SENT, "Sent 0x51 upload init command");
     
@@ -296,15 +312,14 @@ bool UploadManager::send_partial_upload()
         return false;  // Already complete
     }
     
-    // Get missing segments
-    std::vector<int> missing = segment_tracker.get_missing_segments();
+    // First missing segment and count come straight from the bitset
+    int first_missing = segment_tracker.get_first_missing();
     
-    if (missing.empty()) {
+    if (first_missing < 0) {
         return false;  // Nothing missing
     }
     
-    int first_missing = missing[0];
-    int missing_count = (int)missing.size();
+    int missing_count = segment_tracker.get_missing_count();
     
     // Track statistics
     statistics.on_segments_requested(missing_count);
@@ -325,34 +340,68 @@ bool UploadManager::send_partial_upload()
 bool UploadManager::send_upload_command_0x55(uint32_t start_addr)
 {
     // Get missing segments
-    std::vector<int> missing = segment_tracker.get_missing_segments();
+    segment_tracker.get_missing_segments(missing_scratch);
+    collapse_to_packets(missing_scratch);
     
     // Convert byte address to segment number
     int start_segment = start_addr / LinkTiming::UPLOAD_BYTES_PER_SEGMENT;
 
-    // Build command using OPTIMIZED command builder
-    // The command builder will automatically find the best start_segment
-    // to maximize bitmap density - no manual override logic needed!
-    int total_segments_used;
-    std::vector<uint8_t> cmd = command_builder.build_partial_upload_command(
-        current_macid,
-        start_segment,
-        missing,
-        segment_tracker.get_total_count(),
-        &total_segments_used);
+    // Report windows from the previous burst that drew no packets at all
+    for (const UploadWindow& w : active_windows) {
+        if (w.received == 0) {
+            LOG_INFO_CTX("upload_mgr", "0x55 window %d-%d got no packets (%d requested) - command likely lost",
+                         w.start_segment, w.end_segment - 1, w.requested);
+        }
+    }
+
+    // Split the missing set into as few bitmap windows as possible; when
+    // more than 532 segments are missing they all go out in this burst
+    // instead of one window per timeout cycle
+    int covered = command_builder.plan_partial_windows(
+        missing_scratch,
+        LinkTiming::UPLOAD_MAX_SEGMENTS_PER_0X55,
+        LinkTiming::UPLOAD_MAX_0X55_WINDOWS_PER_BURST,
+        window_starts);
+    if (window_starts.empty()) {
+        return false;
+    }
+
+    // Queue the commands back-to-back; the TX service waits for the
+    // radio's buffer-empty line after each 128-byte frame
+    active_windows.clear();
+    for (int window_start : window_starts) {
+        int segments_used = 0;
+        std::vector<uint8_t> cmd = command_builder.build_partial_upload_command_at(
+            current_macid,
+            window_start,
+            missing_scratch,
+            segment_tracker.get_total_count(),
+            &segments_used);
+        ts1x_core->send_command(cmd.data(), cmd.size());
+        
+        UploadWindow w;
+        w.start_segment = window_start;
+        w.end_segment = window_start + LinkTiming::UPLOAD_MAX_SEGMENTS_PER_0X55;
+        w.requested = segments_used;
+        w.received = 0;
+        active_windows.push_back(w);
+    }
     
-    // Send command
-    ts1x_core->send_command(cmd.data(), cmd.size());
+    // A burst sent while data was flowing is a timeout-triggered retry
+    timeout_manager.on_command_sent(current_state == UPLOAD_RECEIVING ||
+                                    current_state == UPLOAD_RETRY_PARTIAL);
     
     transition_state(UPLOAD_RETRY_PARTIAL, "Sent 0x55 partial upload request");
     retry_count++;
     
-    LOG_INFO_CTX("upload_mgr", "Sent 0x55 partial upload (retry %d/%d): start_seg=%d, %d segments missing",
-                 retry_count, max_retries, start_segment, get_missing_segments());
+    LOG_INFO_CTX("upload_mgr", "Sent 0x55 partial upload (retry %d/%d): %zu window(s) from seg %d, requesting %d of %d missing segments (hint start_seg=%d)",
+                 retry_count, max_retries, window_starts.size(), window_starts[0],
+                 covered, get_missing_segments(), start_segment);
     
     // Log to state logger with details
-    LOG_STATE("TX: 0x55 partial upload | Retry: %d/%d | Missing: %d segments | First missing: %d",
-              retry_count, max_retries, get_missing_segments(), start_segment);
+    LOG_STATE("TX: 0x55 partial upload | Retry: %d/%d | Missing: %d segments | Windows: %zu | Requested: %d | First window: %d",
+              retry_count, max_retries, get_missing_segments(), window_starts.size(),
+              covered, window_starts[0]);
     
     return true;
 }
@@ -375,6 +424,7 @@ bool UploadManager::process_upload_response(const CommandResponse& response)
     }
     
     uint16_t segment_addr = response.upload_segment_addr;
+    int segment_count = response.upload_segment_count > 0 ? response.upload_segment_count : 1;
     int total_segments = segment_tracker.get_total_count();
     
     if (segment_addr >= total_segments) {
@@ -384,36 +434,54 @@ bool UploadManager::process_upload_response(const CommandResponse& response)
         return true;  // Not an error, just ignore it
     }
     
-    // Check if already received
-    if (segment_tracker.is_received(segment_addr)) {
+    // FAST packets carry a segment pair; from now on request by pair
+    if (segment_count > segments_per_packet) {
+        segments_per_packet = segment_count;
+        LOG_INFO_CTX("upload_mgr", "Node sends %d segments per packet - requesting by packet from now on",
+                     segments_per_packet);
+    }
+    
+    // Store the segment data (the tail of a FAST pair may be out of range
+    // or a duplicate; only new in-range segments are stored)
+    int stored = segment_tracker.mark_received_range(segment_addr, segment_count, response.upload_data);
+    
+    if (stored == 0) {
         LOG_WARN_CTX("upload_mgr", "Duplicate segment %d", segment_addr);
         return true;
     }
     
-    // Store the segment data
-    bool stored = segment_tracker.mark_received(segment_addr, response.upload_data);
-    
-    if (stored) {
-        
-        // Reset timeout timer - we just received a packet
-        reset_packet_timer();
-        
-        transition_state(UPLOAD_RECEIVING, "Received upload data segment");
-        
-        LOG_INFO_CTX("upload_mgr", "Received %s segment %d (%d/%d)", 
-                      response.is_fast_mode ? "Fast" : "Slow",
-                      segment_addr, segment_tracker.get_received_count(), 
-                      segment_tracker.get_total_count());
-        
-        // Log progress every 10 segments
-        if (segment_tracker.get_received_count() % 10 == 0) {
-            LOG_INFO_CTX("upload_mgr", "Upload progress: %d/%d segments (%.1f%%)",
-                         segment_tracker.get_received_count(), 
-                         segment_tracker.get_total_count(),
-                         100.0 * segment_tracker.get_received_count() / segment_tracker.get_total_count());
+    timeout_manager.on_packet_received();
+    
+    // Credit the 0x55 window (if any) this packet was requested in
+    int request_addr = segment_addr - (segment_addr % segments_per_packet);
+    for (UploadWindow& w : active_windows) {
+        if (request_addr >= w.start_segment && request_addr < w.end_segment) {
+            if (++w.received == w.requested) {
+                LOG_DEBUG_CTX("upload_mgr", "0x55 window %d-%d complete (%d packets)",
+                              w.start_segment, w.end_segment - 1, w.requested);
+            }
+            break;
         }
     }
     
+    // Reset timeout timer - we just received a packet
+    reset_packet_timer();
+    
+    transition_state(UPLOAD_RECEIVING, "Received upload data segment");
+    
+    LOG_INFO_CTX("upload_mgr", "Received %s segment %d (%d new) (%d/%d)", 
+                  response.is_fast_mode ? "Fast" : "Slow",
+                  segment_addr, stored, segment_tracker.get_received_count(), 
+                  segment_tracker.get_total_count());
+    
+    // Log progress every 10 segments
+    if (segment_tracker.get_received_count() % 10 == 0) {
+        LOG_INFO_CTX("upload_mgr", "Upload progress: %d/%d segments (%.1f%%)",
+                     segment_tracker.get_received_count(), 
+                     segment_tracker.get_total_count(),
+                     100.0 * segment_tracker.get_received_count() / segment_tracker.get_total_count());
+    }
+    
     return true;
 }
 
@@ -427,7 +495,25 @@ bool UploadManager::has_failed() const
     return (retry_count >= max_retries);
 }
 
-std::vector<int16_t> UploadManager::get_data() const
+// With multi-segment (FAST) packets one request bit fetches the whole
+// packet, so keep only the first segment of each packet that still has a
+// missing segment.  The list stays sorted.
+void UploadManager::collapse_to_packets(std::vector<int>& missing) const
+{
+    if (segments_per_packet <= 1) {
+        return;
+    }
+    size_t out = 0;
+    for (size_t i = 0; i < missing.size(); i++) {
+        int packet_start = missing[i] - (missing[i] % segments_per_packet);
+        if (out == 0 || missing[out - 1] != packet_start) {
+            missing[out++] = packet_start;
+        }
+    }
+    missing.resize(out);
+}
+
+void UploadManager::take_data(std::vector<int16_t>& out)
 {
-    return segment_tracker.get_all_data();
+    segment_tracker.take_data(out);
 }
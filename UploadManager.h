@@ -41,7 +41,9 @@ public:
     bool send_partial_upload();
 
     // Get the response that triggered this upload
-    const CommandResponse* get_triggering_response() const { return triggering_response; }
+    const CommandResponse* get_triggering_response() const {
+        return has_triggering_response ? &triggering_response : nullptr;
+    }
 
     // Decode data length from descriptor field
     static uint32_t decode_data_length_from_descriptor(uint16_t descriptor);
@@ -66,6 +68,7 @@ public:
     int get_total_segments() const { return segment_tracker.get_total_count(); }
     int get_received_segments() const { return segment_tracker.get_received_count(); }
     int get_missing_segments() const { return segment_tracker.get_missing_count(); }
+    int get_active_window_count() const { return (int)active_windows.size(); }
     int get_retry_count() const { return retry_count; }
     int get_max_retries() const { return max_retries; }
     int get_retry_timeout_ms() const { return retry_timeout_ms; }
@@ -77,9 +80,17 @@ public:
     int64_t get_ms_since_last_packet() const;
     int64_t get_ms_since_upload_start() const;
     void reset_packet_timer();
+    void note_timeout();                    // a packet/reply timeout was declared
+    int64_t get_init_settle_ms() const;     // settling before 0x51 for this node
+    
+    // Timeout accounting (per session, and since startup)
+    uint32_t get_session_timeouts() const { return timeout_manager.get_session_timeouts(); }
+    uint32_t get_session_spurious_retries() const { return timeout_manager.get_session_spurious_retries(); }
+    uint64_t get_total_timeouts() const { return timeout_manager.get_total_timeouts(); }
+    uint64_t get_total_spurious_retries() const { return timeout_manager.get_total_spurious_retries(); }
     
-    // Get the uploaded data
-    std::vector<int16_t> get_data() const;
+    // Move the uploaded samples into out (the manager is left empty)
+    void take_data(std::vector<int16_t>& out);
     
     // Reset for new upload
     void reset();
@@ -116,13 +127,19 @@ private:
     
     // Component managers (internal helpers)
     UploadSegmentTracker segment_tracker;
+    std::vector<int> missing_scratch;      // reused by every 0x55 build
+    std::vector<int> window_starts;        // reused by every 0x55 burst
+    std::vector<UploadWindow> active_windows;  // windows of the last 0x55 burst
+    int segments_per_packet;               // 2 once the node has sent FAST packets
+    void collapse_to_packets(std::vector<int>& missing) const;
     UploadTimeoutManager timeout_manager;
     UploadRetryStrategy retry_strategy;
     UploadCommandBuilder command_builder;
     UploadStatistics statistics;
 
     // Store the response that triggered the upload (for file output)
-    CommandResponse* triggering_response;
+    CommandResponse triggering_response;
+    bool has_triggering_response;
     
     // Helper for sending 0x51 and 0x55
     bool send_init_command_0x55();  // Initial 0x55 (all segments missing)
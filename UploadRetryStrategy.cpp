@@ -62,7 +62,7 @@ RetryDecision UploadRetryStrategy::evaluate(
         if (missing > MAX_SEGMENTS_PER_0X55) {
             char buffer[256];
             snprintf(buffer, sizeof(buffer),
-                     "Missing %d segments (>%d but <%d%% of total) - partial uploads worthwhile, may need multiple 0x55",
+                     "Missing %d segments (>%d but <%d%% of total) - partial upload as a burst of multiple 0x55 windows",
                      missing, MAX_SEGMENTS_PER_0X55, 80);
             original_reason = buffer;
         } else {
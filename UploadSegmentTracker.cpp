@@ -14,78 +14,100 @@ UploadSegmentTracker::~UploadSegmentTracker()
 void UploadSegmentTracker::initialize(int total_segs)
 {
     reset();
+    if (total_segs <= 0) {
+        return;
+    }
     total_segments = total_segs;
-    
-    // Pre-allocate segment vector
-    segments.clear();
-    segments.reserve(total_segments);
-    for (int i = 0; i < total_segments; i++) {
-        segments.push_back(UploadSegment(i));
+
+    // Every segment starts out missing; clear the unused tail of the last word
+    missing_bits.assign((total_segments + 63) / 64, ~0ULL);
+    if (total_segments % 64) {
+        missing_bits.back() = (1ULL << (total_segments % 64)) - 1;
     }
+
+    samples.assign((size_t)total_segments * UPLOAD_SEGMENT_SAMPLES, 0);
 }
 
-bool UploadSegmentTracker::mark_received(int segment_num, const int16_t data[32])
+bool UploadSegmentTracker::mark_received(int segment_num, const int16_t data[UPLOAD_SEGMENT_SAMPLES])
 {
     if (segment_num < 0 || segment_num >= total_segments) {
         return false;  // Out of range
     }
-    
-    if (segments[segment_num].received) {
+
+    uint64_t bit = 1ULL << (segment_num & 63);
+    uint64_t& word = missing_bits[segment_num >> 6];
+    if (!(word & bit)) {
         return false;  // Already received (duplicate)
     }
-    
+
     // Copy data
-    for (int i = 0; i < 32; i++) {
-        segments[segment_num].data[i] = data[i];
-    }
-    
-    segments[segment_num].received = true;
+    memcpy(&samples[(size_t)segment_num * UPLOAD_SEGMENT_SAMPLES], data,
+           UPLOAD_SEGMENT_SAMPLES * sizeof(int16_t));
+
+    word &= ~bit;
     segments_received++;
-    
+
     return true;
 }
 
+int UploadSegmentTracker::mark_received_range(int first_segment, int count, const int16_t* data)
+{
+    int stored = 0;
+    for (int k = 0; k < count; k++) {
+        if (mark_received(first_segment + k, data + k * UPLOAD_SEGMENT_SAMPLES)) {
+            stored++;
+        }
+    }
+    return stored;
+}
+
 bool UploadSegmentTracker::is_received(int segment_num) const
 {
     if (segment_num < 0 || segment_num >= total_segments) {
         return false;
     }
-    return segments[segment_num].received;
+    return !(missing_bits[segment_num >> 6] & (1ULL << (segment_num & 63)));
 }
 
 std::vector<int> UploadSegmentTracker::get_missing_segments() const
 {
     std::vector<int> missing;
-    for (int i = 0; i < total_segments; i++) {
-        if (!segments[i].received) {
-            missing.push_back(i);
-        }
-    }
+    get_missing_segments(missing);
     return missing;
 }
 
-bool UploadSegmentTracker::is_complete() const
+void UploadSegmentTracker::get_missing_segments(std::vector<int>& out) const
 {
-    return (segments_received == total_segments) && (total_segments > 0);
+    out.clear();
+    out.reserve(get_missing_count());
+    for (size_t w = 0; w < missing_bits.size(); w++) {
+        uint64_t word = missing_bits[w];
+        while (word) {
+            out.push_back((int)(w * 64) + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
 }
 
-std::vector<int16_t> UploadSegmentTracker::get_all_data() const
+int UploadSegmentTracker::get_first_missing() const
 {
-    std::vector<int16_t> result;
-    result.reserve(total_segments * 32);
-    
-    for (const auto& segment : segments) {
-        for (int i = 0; i < 32; i++) {
-            result.push_back(segment.data[i]);
+    for (size_t w = 0; w < missing_bits.size(); w++) {
+        if (missing_bits[w]) {
+            return (int)(w * 64) + __builtin_ctzll(missing_bits[w]);
         }
     }
-    
-    return result;
+    return -1;
+}
+
+bool UploadSegmentTracker::is_complete() const
+{
+    return (segments_received == total_segments) && (total_segments > 0);
 }
 
 void UploadSegmentTracker::reset()
 {
-    segments.clear();
+    missing_bits.clear();
+    samples.clear();
     total_segments = 0;
     segments_received = 0;
 }
@@ -5,51 +5,67 @@
 #include <vector>
 #include <cstring>
 
-// Upload segment (32 samples = 64 bytes)
-struct UploadSegment {
-    uint16_t address;       // Segment number (0, 1, 2, ...)
-    bool received;
-    int16_t data[32];       // 32x 16-bit samples
-    
-    UploadSegment(uint16_t addr) : address(addr), received(false) {
-        memset(data, 0, sizeof(data));
-    }
-};
+// Samples per upload segment (32 samples = 64 bytes)
+#define UPLOAD_SEGMENT_SAMPLES 32
 
+// Tracks which segments of an upload have arrived.
+//
+// Missing segments are kept as set bits in 64-bit words, so counting and
+// walking them is a popcount/ctz scan rather than a pass over every
+// segment.  Sample data lands directly in one preallocated contiguous
+// buffer (segment n at offset n * UPLOAD_SEGMENT_SAMPLES); the bitmap keeps
+// its capacity across uploads, the sample buffer is handed off with
+// take_data() once the upload is complete.
 class UploadSegmentTracker
 {
 public:
     UploadSegmentTracker();
     ~UploadSegmentTracker();
-    
+
     // Initialize for a new upload
     void initialize(int total_segments);
-    
+
     // Mark a segment as received and store its data
-    bool mark_received(int segment_num, const int16_t data[32]);
-    
+    bool mark_received(int segment_num, const int16_t data[UPLOAD_SEGMENT_SAMPLES]);
+
+    // Mark count consecutive segments starting at first_segment; data holds
+    // count × UPLOAD_SEGMENT_SAMPLES samples.  Segments out of range or
+    // already received are skipped.  Returns the number newly stored.
+    int mark_received_range(int first_segment, int count, const int16_t* data);
+
     // Check if a segment has been received
     bool is_received(int segment_num) const;
-    
-    // Get list of missing segment numbers
+
+    // Get list of missing segment numbers (ascending)
     std::vector<int> get_missing_segments() const;
-    
+
+    // Same, reusing the caller's vector to avoid reallocating on every retry
+    void get_missing_segments(std::vector<int>& out) const;
+
+    // First missing segment, or -1 if none
+    int get_first_missing() const;
+
     // Get counts
     int get_received_count() const { return segments_received; }
     int get_total_count() const { return total_segments; }
     int get_missing_count() const { return total_segments - segments_received; }
-    
+
     // Check if all segments received
     bool is_complete() const;
-    
-    // Get all data as a contiguous vector
-    std::vector<int16_t> get_all_data() const;
-    
+
+    // All samples, in segment order (segments not yet received read as 0)
+    const std::vector<int16_t>& get_all_data() const { return samples; }
+
+    // Hand the sample buffer to out by swap; the tracker gets out's old
+    // buffer and must be reset before the next upload
+    void take_data(std::vector<int16_t>& out) { out.swap(samples); }
+
     // Reset for new upload
     void reset();
-    
+
 private:
-    std::vector<UploadSegment> segments;
+    std::vector<uint64_t> missing_bits;   // bit set = segment still missing
+    std::vector<int16_t> samples;
     int total_segments;
     int segments_received;
 };
@@ -2,8 +2,42 @@
 #include "UploadTypes.h"
 #include "LinkTimingConstants.h"
 #include <algorithm>
+#include <cmath>
+
+//=============================================================================
+// DelayEstimate
+//=============================================================================
+
+void DelayEstimate::add_sample(double sample_ms)
+{
+    if (samples == 0) {
+        smoothed_ms = sample_ms;
+        variance_ms = sample_ms / 2.0;
+    } else {
+        variance_ms = (1.0 - LinkTiming::UPLOAD_RTT_BETA) * variance_ms +
+                      LinkTiming::UPLOAD_RTT_BETA * std::fabs(smoothed_ms - sample_ms);
+        smoothed_ms = (1.0 - LinkTiming::UPLOAD_RTT_ALPHA) * smoothed_ms +
+                      LinkTiming::UPLOAD_RTT_ALPHA * sample_ms;
+    }
+    samples++;
+}
+
+int DelayEstimate::timeout_ms() const
+{
+    if (samples == 0) {
+        return 0;
+    }
+    return (int)std::ceil(smoothed_ms + LinkTiming::UPLOAD_RTT_VAR_MULTIPLIER * variance_ms);
+}
+
+//=============================================================================
+// UploadTimeoutManager
+//=============================================================================
 
 UploadTimeoutManager::UploadTimeoutManager()
+    : current_link(nullptr),
+      total_timeouts(0),
+      total_spurious_retries(0)
 {
     reset();
 }
@@ -12,10 +46,60 @@ UploadTimeoutManager::~UploadTimeoutManager()
 {
 }
 
-void UploadTimeoutManager::start_session(int total_segments)
+void UploadTimeoutManager::start_session(uint32_t macid, int total_segments)
 {
     session_start_time = std::chrono::steady_clock::now();
     last_packet_time = session_start_time;
+    current_link = &link_estimates[macid];
+}
+
+void UploadTimeoutManager::on_command_sent(bool after_timeout)
+{
+    // Karn's rule: if the previous command is still unanswered, a reply can
+    // not be attributed to either one, so it is not used as an RTT sample
+    reply_ambiguous = awaiting_reply;
+    awaiting_reply = true;
+    command_after_timeout = after_timeout;
+    streaming = false;
+    command_time = std::chrono::steady_clock::now();
+}
+
+void UploadTimeoutManager::on_packet_received()
+{
+    auto now = std::chrono::steady_clock::now();
+    
+    if (awaiting_reply) {
+        double latency_ms = std::chrono::duration<double, std::milli>(now - command_time).count();
+        double spurious_ms = LinkTiming::UPLOAD_SPURIOUS_REPLY_MS;
+        if (current_link && current_link->reply.valid()) {
+            spurious_ms = std::max(spurious_ms, current_link->reply.smoothed_ms / 2.0);
+        }
+        
+        if (command_after_timeout && latency_ms < spurious_ms) {
+            // Too fast to be a reply to the retry: the link was still
+            // delivering when we timed out
+            session_spurious_retries++;
+            total_spurious_retries++;
+            if (current_link) current_link->spurious_retries++;
+        } else if (!reply_ambiguous && current_link) {
+            current_link->reply.add_sample(latency_ms);
+        }
+        awaiting_reply = false;
+        reply_ambiguous = false;
+    } else if (streaming && current_link) {
+        current_link->gap.add_sample(
+            std::chrono::duration<double, std::milli>(now - last_arrival_time).count());
+    }
+    
+    streaming = true;
+    last_arrival_time = now;
+}
+
+void UploadTimeoutManager::on_timeout()
+{
+    session_timeouts++;
+    total_timeouts++;
+    if (current_link) current_link->timeouts++;
 }
 
 void UploadTimeoutManager::reset_packet_timer()
@@ -46,7 +130,18 @@ int64_t UploadTimeoutManager::get_ms_since_session_start() const
 int UploadTimeoutManager::get_adaptive_timeout_ms(UploadState state, double completion_rate) const
 {
     if (state == UPLOAD_COMMAND_SENT) {
-        return LinkTiming::UPLOAD_INITIAL_TIMEOUT_MS;
+        // Waiting for the reply to a command: reply-latency estimate
+        int estimated = current_link ? current_link->reply.timeout_ms() : 0;
+        return std::min(std::max(estimated, LinkTiming::UPLOAD_INITIAL_TIMEOUT_MS),
+                        LinkTiming::UPLOAD_PACKET_TIMEOUT_MAX_MS);
+    }
+    
+    // Streaming: once the node's inter-packet gaps have been measured they
+    // decide, bounded by the floor below and UPLOAD_PACKET_TIMEOUT_MAX_MS
+    if (current_link && current_link->gap.valid()) {
+        int estimated = current_link->gap.timeout_ms();
+        return std::min(std::max(estimated, LinkTiming::UPLOAD_MIN_PACKET_TIMEOUT_MS),
+                        LinkTiming::UPLOAD_PACKET_TIMEOUT_MAX_MS);
     }
     
     // For normal reception - enforce minimum timeout to handle 1+ second gaps
@@ -76,6 +171,16 @@ int UploadTimeoutManager::get_adaptive_timeout_ms(UploadState state, double comp
     return adaptive_timeout;
 }
 
+int64_t UploadTimeoutManager::get_init_settle_ms() const
+{
+    // ACKs from the previous command take about one reply latency to clear
+    int64_t settle = LinkTiming::UPLOAD_INIT_STATE_TIMEOUT_MS;
+    if (current_link && current_link->reply.valid()) {
+        settle = std::max(settle, (int64_t)std::ceil(current_link->reply.smoothed_ms));
+    }
+    return std::min(settle, LinkTiming::UPLOAD_INIT_STATE_MAX_MS);
+}
+
 int64_t UploadTimeoutManager::get_expected_upload_time_ms(int total_segments) const
 {
     // Assume 95% packet loss rate (5% success)
@@ -104,4 +209,11 @@ void UploadTimeoutManager::reset()
 {
     session_start_time = std::chrono::steady_clock::time_point();
     last_packet_time = std::chrono::steady_clock::time_point();
+    current_link = nullptr;
+    awaiting_reply = false;
+    reply_ambiguous = false;
+    command_after_timeout = false;
+    streaming = false;
+    session_timeouts = 0;
+    session_spurious_retries = 0;
 }
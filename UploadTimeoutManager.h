@@ -3,41 +3,98 @@
 
 #include <chrono>
 #include <cstdint>
+#include <unordered_map>
 #include "UploadTypes.h"
 
 // Note: All timing constants moved to LinkTimingConstants.h
 // Do not add timing constants here - use LinkTiming:: namespace instead
 
+// Smoothed value and mean deviation of one kind of delay (RFC 6298)
+struct DelayEstimate {
+    double smoothed_ms;
+    double variance_ms;
+    uint32_t samples;
+
+    DelayEstimate() : smoothed_ms(0.0), variance_ms(0.0), samples(0) {}
+
+    void add_sample(double sample_ms);
+    bool valid() const { return samples > 0; }
+    // smoothed + K × variance, or 0 without samples
+    int timeout_ms() const;
+};
+
+// What we have learned about one node's link; kept across upload sessions
+struct LinkEstimate {
+    DelayEstimate reply;            // command sent -> first packet back
+    DelayEstimate gap;              // packet -> next packet while streaming
+    uint32_t timeouts;              // packet/command timeouts declared
+    uint32_t spurious_retries;      // timeouts proven early by a fast reply
+
+    LinkEstimate() : timeouts(0), spurious_retries(0) {}
+};
+
 class UploadTimeoutManager
 {
 public:
     UploadTimeoutManager();
     ~UploadTimeoutManager();
-    
-    // Start tracking for a new upload session
-    void start_session(int total_segments);
-    
+
+    // Start tracking for a new upload session with node macid
+    void start_session(uint32_t macid, int total_segments);
+
     // Reset packet timer (called when we receive a packet)
     void reset_packet_timer();
-    
+
+    // Link estimator events
+    void on_command_sent(bool after_timeout);   // 0x51/0x55 queued for TX
+    void on_packet_received();                  // new segment stored
+    void on_timeout();                          // caller gave up waiting
+
     // Get elapsed time
     int64_t get_ms_since_last_packet() const;
     int64_t get_ms_since_session_start() const;
-    
-    // Adaptive timeout based on state and progress
+
+    // Adaptive timeout based on state, progress and the node's estimates
     int get_adaptive_timeout_ms(UploadState state, double completion_rate) const;
-    
+
+    // Settling time before 0x51 for the current node
+    int64_t get_init_settle_ms() const;
+
     // Expected upload time calculations
     int64_t get_expected_upload_time_ms(int total_segments) const;
     int64_t get_global_timeout_ms(int total_segments) const;
     bool check_global_timeout(int total_segments) const;
-    
-    // Reset for new session
+
+    // Counters for the current session and since startup
+    uint32_t get_session_timeouts() const { return session_timeouts; }
+    uint32_t get_session_spurious_retries() const { return session_spurious_retries; }
+    uint64_t get_total_timeouts() const { return total_timeouts; }
+    uint64_t get_total_spurious_retries() const { return total_spurious_retries; }
+    const LinkEstimate* get_link_estimate() const { return current_link; }
+
+    // Reset for new session (learned estimates are kept)
     void reset();
-    
+
 private:
     std::chrono::steady_clock::time_point session_start_time;
     std::chrono::steady_clock::time_point last_packet_time;
+
+    // Per-node estimates, keyed by MAC id
+    std::unordered_map<uint32_t, LinkEstimate> link_estimates;
+    LinkEstimate* current_link;
+
+    // Reply tracking for the most recent command
+    std::chrono::steady_clock::time_point command_time;
+    std::chrono::steady_clock::time_point last_arrival_time;
+    bool awaiting_reply;
+    bool reply_ambiguous;       // an earlier command is also unanswered (Karn)
+    bool command_after_timeout;
+    bool streaming;             // at least one packet since the last command
+
+    uint32_t session_timeouts;
+    uint32_t session_spurious_retries;
+    uint64_t total_timeouts;
+    uint64_t total_spurious_retries;
 };
 
 #endif // UPLOAD_TIMEOUT_MANAGER_H
@@ -17,4 +17,12 @@ enum RetryDecision {
     DECISION_RETRY_PARTIAL  // Send 0x55 (partial upload)
 };
 
+// One 0x55 bitmap window of a partial-upload burst
+struct UploadWindow {
+    int start_segment;      // First segment covered by the bitmap
+    int end_segment;        // One past the last segment covered
+    int requested;          // Packets flagged in the bitmap
+    int received;           // Requested packets that have arrived since
+};
+
 #endif // UPLOAD_TYPES_H
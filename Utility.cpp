@@ -7,6 +7,7 @@
 #include <string>
 #include <cstdio>
 #include <cctype>
+#include <cstring>
 Utility::Utility(char* buffer, int* icnt, int* ocnt, pi_buffer* cmd_buffer)
     : ibuf(buffer), icnt(icnt), ocnt(ocnt), command_buffer(cmd_buffer) {}
 
@@ -38,7 +39,10 @@ void Utility::init_rf_channel() {
 }
 
 void Utility::rx_char(char ch) {
-    ibuf[(*icnt) & IBUF_MASK] = ch;
+    int idx = (*icnt) & IBUF_MASK;
+    ibuf[idx] = ch;
+    // Mirror the start of the ring past its end so any frame is contiguous
+    if (idx < CLENG) ibuf[IBUF_MAX + idx] = ch;
     (*icnt)++;
     *icnt=(*icnt) & IBUF_MASK;
 }
@@ -65,3 +69,32 @@ bool Utility::is_valid_command_header()
     return true;
 }
 
+int Utility::resync()
+{
+    int count = (*icnt - *ocnt) & IBUF_MASK;
+    int skipped = 0;
+
+    // Candidate starts are positions with at least CLENG bytes behind them.
+    // memchr finds each 't' in one pass over a contiguous stretch of the
+    // ring; the mirror past IBUF_MAX lets the "S"/"uP" checks read straight
+    // across the wrap.
+    while (count - skipped >= CLENG) {
+        int pos = (*ocnt + skipped) & IBUF_MASK;
+        int chunk = count - skipped - CLENG + 1;
+        if (chunk > IBUF_MAX - pos) chunk = IBUF_MAX - pos;
+
+        const char* hit = static_cast<const char*>(memchr(ibuf + pos, 't', chunk));
+        if (!hit) {
+            skipped += chunk;
+            continue;
+        }
+        skipped += hit - (ibuf + pos);
+        if (hit[1] == 'S' && hit[CLENG - 2] == 'u' && hit[CLENG - 1] == 'P') {
+            break;
+        }
+        skipped++;
+    }
+
+    move_buffer(skipped);
+    return skipped;
+}
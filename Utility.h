@@ -14,6 +14,10 @@ public:
     int make_pointer(int i1, int i2);
     bool is_valid_command_header();
     void move_buffer(int loc);
+
+    // Skip to the next candidate frame ("tS" ... "uP") in the buffered data.
+    // Returns the number of bytes discarded.
+    int resync();
     
 
 private:
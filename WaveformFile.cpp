@@ -0,0 +1,257 @@
+#include "WaveformFile.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// ===== Text =====
+
+// Format value as "%.6e" but with a 3-digit exponent (e.g. "e-004");
+// returns the length written (no newline)
+static int format_3digit_exp(char* out, size_t size, double value) {
+    int len = snprintf(out, size, "%.6e", value);
+    
+    // If exponent is only 2 digits (e.g., "e-04"), expand to 3 (e.g., "e-004")
+    char* e_pos = (char*)memchr(out, 'e', len);
+    if (e_pos && (out + len) - e_pos == 4 && (size_t)len + 1 < size) {
+        e_pos[5] = '\0';
+        e_pos[4] = e_pos[3];
+        e_pos[3] = e_pos[2];
+        e_pos[2] = '0';
+        len++;
+    }
+    return len;
+}
+
+// Sample lines are a pure function of (sample - mean) for a given scale,
+// and that difference lies in [-65535, 65535], so each distinct value is
+// formatted once and then copied.
+// Entry layout: length byte (0 = not formatted yet) + text + '\n'.
+#define SAMPLE_LINE_STRIDE 16
+#define SAMPLE_DELTA_RANGE 65535
+
+static const char* sample_line(int delta, double scale, int* len) {
+    static thread_local std::vector<char> cache;
+    static thread_local double cache_scale = 0.0;
+    static thread_local char uncached[64];
+    
+    if (delta < -SAMPLE_DELTA_RANGE || delta > SAMPLE_DELTA_RANGE) {
+        int n = format_3digit_exp(uncached, sizeof(uncached) - 1, delta * scale);
+        uncached[n] = '\n';
+        *len = n + 1;
+        return uncached;
+    }
+    if (cache.empty() || cache_scale != scale) {
+        cache.assign((size_t)(2 * SAMPLE_DELTA_RANGE + 1) * SAMPLE_LINE_STRIDE, 0);
+        cache_scale = scale;
+    }
+    
+    char* entry = &cache[(size_t)(delta + SAMPLE_DELTA_RANGE) * SAMPLE_LINE_STRIDE];
+    if (entry[0] == 0) {
+        char text[64];
+        int n = format_3digit_exp(text, sizeof(text), delta * scale);
+        if (n + 2 > SAMPLE_LINE_STRIDE) {
+            // Only for scales that print more than 14 characters
+            memcpy(uncached, text, n);
+            uncached[n] = '\n';
+            *len = n + 1;
+            return uncached;
+        }
+        memcpy(entry + 1, text, n);
+        entry[n + 1] = '\n';
+        entry[0] = (char)(n + 1);
+    }
+    *len = entry[0];
+    return entry + 1;
+}
+
+// Append printf-style text to out
+static void append_format(std::string& out, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void append_format(std::string& out, const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (n > 0) {
+        out.append(line, std::min((size_t)n, sizeof(line) - 1));
+    }
+}
+
+std::string render_waveform_text(const WaveformHeader& h, const int16_t* samples) {
+    std::string contents;
+    contents.reserve(1024 + (size_t)h.sample_count * SAMPLE_LINE_STRIDE);
+    
+    // Header
+    append_format(contents, ";PodID %08x\n", h.pod_id);
+    append_format(contents, ";Date Year(%d) Month(%d) Day(%02d) Hour(%02d) Minutes(%02d) Seconds(%02d)\n",
+                  h.year, h.month, h.day, h.hour, h.min, h.sec);
+    append_format(contents, ";FSampleRate %f\n", h.sample_rate);
+    append_format(contents, ";Channels %d\n", h.channels);
+    append_format(contents, ";nStart_channel %d\n", h.start_channel);
+    append_format(contents, ";Units %d\n", h.units);
+    append_format(contents, ";echobase %08x\n", h.echobase);
+    append_format(contents, ";Agc %d\n", h.agc);
+    append_format(contents, ";Samples %zu\n", (size_t)h.sample_count);
+    append_format(contents, ";RMS %f\n", h.rms);
+    append_format(contents, ";channelIds -2 -1\n");
+    
+    // Samples: (sample - mean) * scale in %.6e with a 3-digit exponent
+    for (uint32_t i = 0; i < h.sample_count; i++) {
+        int len;
+        const char* line = sample_line(samples[i] - h.mean, h.scale, &len);
+        contents.append(line, len);
+    }
+    return contents;
+}
+
+// ===== Binary =====
+
+static void put_u16(unsigned char* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_u32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static void put_f64(unsigned char* p, double d) {
+    uint64_t v;
+    memcpy(&v, &d, sizeof(v));
+    for (int i = 0; i < 8; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uint16_t get_u16(const unsigned char* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static double get_f64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    double d;
+    memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+std::string render_waveform_binary(const WaveformHeader& h, const int16_t* samples) {
+    std::string contents(WAVEFORM_BINARY_HEADER_SIZE + (size_t)h.sample_count * 2, '\0');
+    unsigned char* p = (unsigned char*)&contents[0];
+    
+    memcpy(p, WAVEFORM_BINARY_MAGIC, 4);
+    put_u16(p + 4, WAVEFORM_BINARY_VERSION);
+    put_u16(p + 6, WAVEFORM_BINARY_HEADER_SIZE);
+    put_u32(p + 8, h.pod_id);
+    put_u32(p + 12, h.echobase);
+    put_u16(p + 16, h.year);
+    p[18] = h.month;
+    p[19] = h.day;
+    p[20] = h.hour;
+    p[21] = h.min;
+    p[22] = h.sec;
+    p[23] = h.start_channel;
+    put_f64(p + 24, h.sample_rate);
+    put_f64(p + 32, h.rms);
+    put_f64(p + 40, h.scale);
+    put_u32(p + 48, (uint32_t)h.mean);
+    put_u32(p + 52, h.sample_count);
+    p[56] = h.channels;
+    p[57] = h.units;
+    p[58] = h.agc;
+    
+    unsigned char* out = p + WAVEFORM_BINARY_HEADER_SIZE;
+    for (uint32_t i = 0; i < h.sample_count; i++) {
+        put_u16(out + 2 * i, (uint16_t)samples[i]);
+    }
+    return contents;
+}
+
+bool read_waveform_binary(const std::string& path, WaveformHeader& h,
+                          std::vector<int16_t>& samples, std::string* error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        *error = "cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const unsigned char* p = (const unsigned char*)contents.data();
+    
+    if (contents.size() < 8 || memcmp(p, WAVEFORM_BINARY_MAGIC, 4) != 0) {
+        *error = "not a waveform file (bad magic)";
+        return false;
+    }
+    uint16_t version = get_u16(p + 4);
+    uint16_t header_size = get_u16(p + 6);
+    if (version != WAVEFORM_BINARY_VERSION || header_size < WAVEFORM_BINARY_HEADER_SIZE) {
+        *error = "unsupported waveform file version " + std::to_string(version);
+        return false;
+    }
+    if (contents.size() < header_size) {
+        *error = "truncated header";
+        return false;
+    }
+    
+    h.pod_id = get_u32(p + 8);
+    h.echobase = get_u32(p + 12);
+    h.year = get_u16(p + 16);
+    h.month = p[18];
+    h.day = p[19];
+    h.hour = p[20];
+    h.min = p[21];
+    h.sec = p[22];
+    h.start_channel = p[23];
+    h.sample_rate = get_f64(p + 24);
+    h.rms = get_f64(p + 32);
+    h.scale = get_f64(p + 40);
+    h.mean = (int32_t)get_u32(p + 48);
+    h.sample_count = get_u32(p + 52);
+    h.channels = p[56];
+    h.units = p[57];
+    h.agc = p[58];
+    
+    if (contents.size() - header_size < (size_t)h.sample_count * 2) {
+        *error = "truncated samples (header says " + std::to_string(h.sample_count) + ")";
+        return false;
+    }
+    samples.resize(h.sample_count);
+    const unsigned char* in_samples = p + header_size;
+    for (uint32_t i = 0; i < h.sample_count; i++) {
+        samples[i] = (int16_t)get_u16(in_samples + 2 * i);
+    }
+    return true;
+}
+
+// ===== Output =====
+
+bool write_whole_file(const std::string& path, const std::string& contents) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        return false;
+    }
+    size_t done = 0;
+    while (done < contents.size()) {
+        ssize_t n = write(fd, contents.data() + done, contents.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            return false;
+        }
+        done += n;
+    }
+    return close(fd) == 0;
+}
@@ -0,0 +1,76 @@
+#ifndef WAVEFORM_FILE_H
+#define WAVEFORM_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Waveform file formats
+ *
+ * Text (legacy): ";"-prefixed header lines followed by one
+ * "%.6e"-with-3-digit-exponent line per sample, ~15 bytes per sample.
+ *
+ * Binary (.wfb): 64-byte little-endian header, then the raw samples as
+ * little-endian int16.  The text file is exactly
+ * render_waveform_text(header, samples), so it can be regenerated from the
+ * binary file at any time (see tools/wfb2txt.cpp).
+ *
+ * Binary header layout:
+ *   0  char[4] magic "TSWF"     24 f64 sample_rate
+ *   4  u16 version (1)          32 f64 rms
+ *   6  u16 header size (64)     40 f64 scale (units per count)
+ *   8  u32 pod_id (unit id)     48 i32 mean (subtracted before scaling)
+ *  12  u32 echobase             52 u32 sample_count
+ *  16  u16 year                 56 u8 channels, u8 units, u8 agc
+ *  18  u8 month, day, hour,     59 reserved (zero) up to 64
+ *      min, sec
+ *  23  u8 start_channel
+ */
+
+#define WAVEFORM_BINARY_MAGIC "TSWF"
+#define WAVEFORM_BINARY_VERSION 1
+#define WAVEFORM_BINARY_HEADER_SIZE 64
+#define WAVEFORM_BINARY_EXTENSION ".wfb"
+#define WAVEFORM_TEXT_EXTENSION ".txt"
+
+// Everything the text header shows, plus what the sample lines need
+struct WaveformHeader {
+    uint32_t pod_id;
+    uint32_t echobase;
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t min;
+    uint8_t sec;
+    uint8_t start_channel;
+    uint8_t channels;
+    uint8_t units;
+    uint8_t agc;
+    double sample_rate;
+    double rms;
+    double scale;
+    int32_t mean;
+    uint32_t sample_count;
+
+    WaveformHeader()
+        : pod_id(0), echobase(0), year(0), month(0), day(0), hour(0), min(0), sec(0),
+          start_channel(0), channels(1), units(0), agc(1),
+          sample_rate(0.0), rms(0.0), scale(0.0), mean(0), sample_count(0) {}
+};
+
+// Legacy text file contents
+std::string render_waveform_text(const WaveformHeader& header, const int16_t* samples);
+
+// Binary file contents
+std::string render_waveform_binary(const WaveformHeader& header, const int16_t* samples);
+
+// Parse a binary file; false (with *error set) if it is not a valid .wfb
+bool read_waveform_binary(const std::string& path, WaveformHeader& header,
+                          std::vector<int16_t>& samples, std::string* error);
+
+// Create/truncate path and write contents with one write()
+bool write_whole_file(const std::string& path, const std::string& contents);
+
+#endif // WAVEFORM_FILE_H
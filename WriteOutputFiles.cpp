@@ -93,7 +93,7 @@ OutputFileInfo write_output_files(
     
     LOG_INFO_CTX("file_writer", "  Active Channels: %s", channels.c_str());
     LOG_INFO_CTX("file_writer", "  Sample Rate: %s (code=%d)", 
-                 triggering_response->descriptor_sample_rate_str.c_str(),
+                 triggering_response->descriptor_sample_rate_str,
                  sample_rate_code);
     LOG_INFO_CTX("file_writer", "  Mode: %s", rms_only ? "RMS Only" : "Raw Data");
     
@@ -1,3 +1,4 @@
 #define IBUF_MAX 8192  // Must be power of 2
 #define IBUF_MASK (IBUF_MAX-1)
-#define CLENG 128
\ No newline at end of file
+#define CLENG 128
+#define IBUF_ALLOC (IBUF_MAX+CLENG)  // ring plus mirror of its first CLENG bytes
@@ -1,11 +1,387 @@
 // logger.cpp
 #include "logger.h"
 #include <iostream>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <strings.h>
+#include <mutex>
+#include <unordered_map>
 
 // Static variables for logger instances
 static SimpleLogger* g_logger_instance = nullptr;
 static SimpleLogger* g_header_logger_instance = nullptr;
 
+// Level table: context overrides on top of a default threshold.  Bumping
+// the generation makes every LogSite re-read its threshold.
+static std::mutex g_level_mutex;
+static std::unordered_map<std::string, int> g_context_levels;
+static int g_default_level = LOG_LEVEL_DEBUG;
+std::atomic<unsigned> g_log_level_generation{1};
+
+// ===== SimpleLogger =====
+
+SimpleLogger::SimpleLogger(const char* path, size_t max_size_kb, int num_files,
+                           bool mirror_to_console)
+    : log_fd(-1), max_file_size(max_size_kb * 1024), max_files(num_files),
+      current_size(0), console_mirror(mirror_to_console),
+      enqueue_pos(0), dequeue_pos(0), written_pos(0),
+      dropped_records(0), reported_drops(0),
+      writer_running(false), writer_idle(false), wake_fd(-1),
+      cached_second(-1), batch_len(0)
+{
+    memset(log_path, 0, sizeof(log_path));
+    strncpy(log_path, path, sizeof(log_path) - 1);
+    cached_timestamp[0] = '\0';
+
+    slots = new LogRecord[LOG_RING_SLOTS];
+    for (size_t i = 0; i < LOG_RING_SLOTS; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    batch = new char[LOG_BATCH_BYTES];
+
+    open_log();
+
+    // Without the eventfd the idle writer still polls every
+    // LOG_WRITER_IDLE_MS; records just wait longer
+    wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    // The writer must never run a signal handler: a handler that calls
+    // flush() would wait on this thread.
+    sigset_t all_signals, old_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &old_signals);
+    writer_running.store(true);
+    writer_thread = std::thread(&SimpleLogger::writer_loop, this);
+    pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+}
+
+SimpleLogger::~SimpleLogger() {
+    writer_running.store(false);
+    wake_writer();
+    if (writer_thread.joinable()) {
+        writer_thread.join();
+    }
+    if (wake_fd >= 0) {
+        close(wake_fd);
+    }
+    if (log_fd >= 0) {
+        close(log_fd);
+    }
+    delete[] batch;
+    delete[] slots;
+}
+
+void SimpleLogger::open_log() {
+    log_fd = open(log_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    current_size = 0;
+    if (log_fd >= 0) {
+        struct stat st;
+        if (fstat(log_fd, &st) == 0) {
+            current_size = static_cast<size_t>(st.st_size);
+        }
+    }
+}
+
+void SimpleLogger::rotate_logs() {
+    if (log_fd >= 0) {
+        close(log_fd);
+        log_fd = -1;
+    }
+
+    // Rotate existing log files
+    char old_name[300], new_name[300];
+    for (int i = max_files - 1; i > 0; i--) {
+        snprintf(old_name, sizeof(old_name), "%s.%d", log_path, i - 1);
+        snprintf(new_name, sizeof(new_name), "%s.%d", log_path, i);
+        rename(old_name, new_name);
+    }
+
+    // Move current log to .0
+    snprintf(new_name, sizeof(new_name), "%s.0", log_path);
+    rename(log_path, new_name);
+
+    // Open new log file
+    open_log();
+}
+
+// ---- Producer side (any thread) ----
+
+// Claim the next free slot, or count a drop and return nullptr when full
+LogRecord* SimpleLogger::claim_slot(size_t* claimed) {
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        LogRecord* rec = &slots[pos & (LOG_RING_SLOTS - 1)];
+        size_t seq = rec->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                *claimed = pos;
+                return rec;
+            }
+        } else if (diff < 0) {
+            // Ring full: the writer has fallen behind
+            dropped_records.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void SimpleLogger::publish_slot(LogRecord* rec, size_t pos) {
+    rec->sequence.store(pos + 1, std::memory_order_release);
+    if (writer_idle.load(std::memory_order_relaxed)) {
+        wake_writer();
+    }
+}
+
+void SimpleLogger::enqueue(const char* level, const char* context, const char* format, va_list args) {
+    size_t pos;
+    LogRecord* rec = claim_slot(&pos);
+    if (!rec) return;
+
+    gettimeofday(&rec->tv, NULL);
+    rec->level = level;
+    rec->context = context;
+    int n = vsnprintf(rec->text, sizeof(rec->text), format, args);
+    if (n < 0) n = 0;
+    if (n >= (int)sizeof(rec->text)) n = sizeof(rec->text) - 1;
+    rec->length = static_cast<uint16_t>(n);
+
+    publish_slot(rec, pos);
+}
+
+void SimpleLogger::enqueue_raw(const char* line) {
+    size_t pos;
+    LogRecord* rec = claim_slot(&pos);
+    if (!rec) return;
+
+    size_t n = strlen(line);
+    if (n >= sizeof(rec->text)) n = sizeof(rec->text) - 1;
+    memcpy(rec->text, line, n);
+    rec->text[n] = '\0';
+    rec->length = static_cast<uint16_t>(n);
+    rec->level = nullptr;
+    rec->context = nullptr;
+
+    publish_slot(rec, pos);
+}
+
+// Only write(2) on the eventfd: no lock, callable from any context
+void SimpleLogger::wake_writer() {
+    if (wake_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(wake_fd, &one, sizeof(one));
+        (void)n;  // EAGAIN means a wakeup is already pending
+    }
+}
+
+void SimpleLogger::flush() {
+    if (!writer_thread.joinable() || writer_thread.get_id() == std::this_thread::get_id()) {
+        return;
+    }
+    size_t target = enqueue_pos.load(std::memory_order_acquire);
+    wake_writer();
+    struct timespec one_ms = {0, 1000000};
+    for (int waited = 0; waited < LOG_FLUSH_TIMEOUT_MS; waited++) {
+        if (written_pos.load(std::memory_order_acquire) >= target) {
+            return;
+        }
+        nanosleep(&one_ms, NULL);
+    }
+}
+
+// ---- Consumer side (writer thread only) ----
+
+void SimpleLogger::writer_loop() {
+    while (true) {
+        bool running = writer_running.load();
+        size_t n = drain();
+        if (n > 0) {
+            continue;
+        }
+        if (!running) {
+            break;
+        }
+
+        writer_idle.store(true);
+        // A producer that publishes just before the idle flag is set does
+        // not wake us; that record waits at most one idle period
+        struct pollfd pfd = {wake_fd, POLLIN, 0};
+        if (poll(&pfd, 1, LOG_WRITER_IDLE_MS) > 0) {
+            uint64_t count;
+            ssize_t n = read(wake_fd, &count, sizeof(count));
+            (void)n;
+        }
+        writer_idle.store(false);
+    }
+}
+
+// Move every published record into the batch and write it out.
+// Returns the number of records consumed.
+size_t SimpleLogger::drain() {
+    size_t count = 0;
+
+    uint64_t drops = dropped_records.load(std::memory_order_relaxed);
+    if (drops != reported_drops) {
+        LogRecord note;
+        gettimeofday(&note.tv, NULL);
+        note.level = "WARN";
+        note.context = "logger";
+        int len = snprintf(note.text, sizeof(note.text), "%llu log records dropped (ring full, %llu total)",
+                           (unsigned long long)(drops - reported_drops),
+                           (unsigned long long)drops);
+        note.length = static_cast<uint16_t>(len);
+        append_record(note);
+        reported_drops = drops;
+    }
+
+    while (true) {
+        LogRecord& rec = slots[dequeue_pos & (LOG_RING_SLOTS - 1)];
+        size_t seq = rec.sequence.load(std::memory_order_acquire);
+        if (seq != dequeue_pos + 1) {
+            break;  // empty, or the next record is still being filled
+        }
+        append_record(rec);
+        rec.sequence.store(dequeue_pos + LOG_RING_SLOTS, std::memory_order_release);
+        dequeue_pos++;
+        count++;
+    }
+
+    write_batch();
+    written_pos.store(dequeue_pos, std::memory_order_release);
+    return count;
+}
+
+void SimpleLogger::append_record(const LogRecord& rec) {
+    if (!rec.level) {
+        append_line(rec.text, rec.length);
+        return;
+    }
+
+    if (rec.tv.tv_sec != cached_second) {
+        struct tm tm_info;
+        localtime_r(&rec.tv.tv_sec, &tm_info);
+        strftime(cached_timestamp, sizeof(cached_timestamp), "%Y-%m-%d %H:%M:%S", &tm_info);
+        cached_second = rec.tv.tv_sec;
+    }
+
+    char line[LOG_RECORD_TEXT + 128];
+    int len = snprintf(line, sizeof(line), "%s,%03ld - %s - %s - %.*s",
+                       cached_timestamp, (long)(rec.tv.tv_usec / 1000),
+                       rec.context, rec.level, (int)rec.length, rec.text);
+    if (len < 0) return;
+    if (len >= (int)sizeof(line)) len = sizeof(line) - 1;
+    append_line(line, len);
+}
+
+void SimpleLogger::append_line(const char* line, size_t len) {
+    if (batch_len + len + 1 > LOG_BATCH_BYTES) {
+        write_batch();
+    }
+    // Rotate at a line boundary once the file would reach its limit
+    if (current_size + batch_len >= max_file_size) {
+        write_batch();
+        rotate_logs();
+    }
+    memcpy(batch + batch_len, line, len);
+    batch[batch_len + len] = '\n';
+    batch_len += len + 1;
+}
+
+static void write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+void SimpleLogger::write_batch() {
+    if (batch_len == 0) return;
+    if (log_fd >= 0) {
+        write_all(log_fd, batch, batch_len);
+    }
+    if (console_mirror) {
+        write_all(STDERR_FILENO, batch, batch_len);
+    }
+    current_size += batch_len;
+    batch_len = 0;
+}
+
+// ===== Level filtering =====
+
+void set_default_log_level(int level) {
+    std::lock_guard<std::mutex> lock(g_level_mutex);
+    g_default_level = level;
+    g_log_level_generation.fetch_add(1, std::memory_order_release);
+}
+
+void set_log_level(const std::string& context, int level) {
+    std::lock_guard<std::mutex> lock(g_level_mutex);
+    g_context_levels[context] = level;
+    g_log_level_generation.fetch_add(1, std::memory_order_release);
+}
+
+void clear_log_levels() {
+    std::lock_guard<std::mutex> lock(g_level_mutex);
+    g_context_levels.clear();
+    g_default_level = LOG_LEVEL_DEBUG;
+    g_log_level_generation.fetch_add(1, std::memory_order_release);
+}
+
+int get_log_level(const char* context) {
+    std::lock_guard<std::mutex> lock(g_level_mutex);
+    if (context) {
+        auto it = g_context_levels.find(context);
+        if (it != g_context_levels.end()) {
+            return it->second;
+        }
+    }
+    return g_default_level;
+}
+
+bool parse_log_level(const std::string& name, int* level) {
+    static const char* const names[] = { "DEBUG", "INFO", "WARN", "ERROR", "CRITICAL", "OFF" };
+    for (int i = LOG_LEVEL_DEBUG; i <= LOG_LEVEL_OFF; i++) {
+        if (strcasecmp(name.c_str(), names[i]) == 0) {
+            *level = i;
+            return true;
+        }
+    }
+    if (strcasecmp(name.c_str(), "WARNING") == 0) {
+        *level = LOG_LEVEL_WARN;
+        return true;
+    }
+    return false;
+}
+
+const char* log_level_name(int level) {
+    switch (level) {
+        case LOG_LEVEL_DEBUG:    return "DEBUG";
+        case LOG_LEVEL_INFO:     return "INFO";
+        case LOG_LEVEL_WARN:     return "WARN";
+        case LOG_LEVEL_ERROR:    return "ERROR";
+        case LOG_LEVEL_CRITICAL: return "CRITICAL";
+        case LOG_LEVEL_OFF:      return "OFF";
+        default:                 return "UNKNOWN";
+    }
+}
+
+// ===== Instances =====
+
 SimpleLogger* get_logger() {
     return g_logger_instance;
 }
@@ -14,11 +390,11 @@ SimpleLogger* get_header_logger() {
     return g_header_logger_instance;
 }
 
-void init_logger(const std::string& log_directory) {
+void init_logger(const std::string& log_directory, bool console_mirror) {
     if (!g_logger_instance) {
         std::cout << "Initializing logger..." << std::endl;
         std::string main_log_path = log_directory + "/pi_server.log";
-        g_logger_instance = new SimpleLogger(main_log_path.c_str(), 5120*4, 10);
+        g_logger_instance = new SimpleLogger(main_log_path.c_str(), 5120*4, 10, console_mirror);
         if (g_logger_instance) {
             std::cout << "Main logger created at: " << (void*)g_logger_instance << std::endl;
             std::cout << "Main logger path: " << main_log_path << std::endl;
@@ -26,12 +402,12 @@ void init_logger(const std::string& log_directory) {
             std::cout << "ERROR: Failed to create main logger!" << std::endl;
         }
     }
-    
+
     if (!g_header_logger_instance) {
         std::cout << "Initializing header logger..." << std::endl;
         std::string header_log_path = log_directory + "/header.log";
-        // Header log: 5MB max size, keep 10 rotated files
-        g_header_logger_instance = new SimpleLogger(header_log_path.c_str(), 5120*4, 10);
+        // Header log: 5MB max size, keep 10 rotated files (file only, never mirrored)
+        g_header_logger_instance = new SimpleLogger(header_log_path.c_str(), 5120*4, 10, false);
         if (g_header_logger_instance) {
             std::cout << "Header logger created at: " << (void*)g_header_logger_instance << std::endl;
             std::cout << "Header logger path: " << header_log_path << std::endl;
@@ -39,17 +415,23 @@ void init_logger(const std::string& log_directory) {
             std::cout << "ERROR: Failed to create header logger!" << std::endl;
         }
     }
-    
+
     std::cout << "Logger initialization complete" << std::endl;
 }
 
+void flush_logger() {
+    if (g_logger_instance) g_logger_instance->flush();
+    if (g_header_logger_instance) g_header_logger_instance->flush();
+}
+
 void cleanup_logger() {
+    // Destructors drain whatever is still queued before closing the files
     if (g_logger_instance) {
         std::cout << "Cleaning up main logger..." << std::endl;
         delete g_logger_instance;
         g_logger_instance = nullptr;
     }
-    
+
     if (g_header_logger_instance) {
         std::cout << "Cleaning up header logger..." << std::endl;
         delete g_header_logger_instance;
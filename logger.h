@@ -3,105 +3,100 @@
 
 #include <stdio.h>
 #include <stdarg.h>
-#include <time.h>
+#include <stdint.h>
 #include <sys/time.h>
-#include <string.h>
-#include <pthread.h>
+#include <atomic>
+#include <thread>
 #include <string>
 
+// Log ring settings
+#define LOG_RING_SLOTS 1024          // records per logger, power of two
+#define LOG_RECORD_TEXT 1000         // formatted message bytes per record
+#define LOG_BATCH_BYTES 65536        // writer thread output batch
+#define LOG_WRITER_IDLE_MS 50        // writer wakeup period when idle
+#define LOG_FLUSH_TIMEOUT_MS 1000    // upper bound for flush()
+
+// One queued log line.  The message is formatted by the caller into text;
+// the timestamp is captured by the caller but rendered by the writer thread.
+// context and level must point to storage that outlives the record (string
+// literals at every call site).
+struct LogRecord {
+    std::atomic<size_t> sequence;
+    struct timeval tv;
+    const char* level;      // nullptr for raw lines
+    const char* context;
+    uint16_t length;
+    char text[LOG_RECORD_TEXT];
+};
+
+// SimpleLogger queues records into a bounded multi-producer/single-consumer
+// ring and returns immediately; a background writer thread drains the ring,
+// renders the lines into one batch and write()s it out, so callers never
+// touch the file.  File size is tracked from the bytes written, not ftell().
+//
+// When the ring is full new records are dropped and counted; the writer
+// reports the count in the log once space is available again.
+//
+// Producers never take a lock: the idle writer is woken through an eventfd.
+// flush() and flush_logger() only write that eventfd and sleep, so they are
+// async-signal-safe.  The LOG_* calls format with vsnprintf and are not;
+// signal handlers should set a flag and leave logging to the main loop.
 class SimpleLogger {
 private:
-    FILE* log_file;
+    // Output file
+    int log_fd;
     char log_path[256];
     size_t max_file_size;
     int max_files;
-    pthread_mutex_t log_mutex;
-
-    void rotate_logs() {
-        fclose(log_file);
+    size_t current_size;
+    bool console_mirror;
+
+    // Record ring (Vyukov bounded queue, single consumer)
+    LogRecord* slots;
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) size_t dequeue_pos;
+    std::atomic<size_t> written_pos;
+    std::atomic<uint64_t> dropped_records;
+    uint64_t reported_drops;
+
+    // Writer thread
+    std::thread writer_thread;
+    std::atomic<bool> writer_running;
+    std::atomic<bool> writer_idle;
+    int wake_fd;                // eventfd the idle writer polls
+
+    // Writer-side timestamp cache
+    time_t cached_second;
+    char cached_timestamp[32];
+
+    char* batch;
+    size_t batch_len;
+
+    void open_log();
+    void rotate_logs();
+    LogRecord* claim_slot(size_t* claimed);
+    void publish_slot(LogRecord* rec, size_t pos);
+    void enqueue(const char* level, const char* context, const char* format, va_list args);
+    void enqueue_raw(const char* line);
+    void writer_loop();
+    size_t drain();
+    void append_record(const LogRecord& rec);
+    void append_line(const char* line, size_t len);
+    void write_batch();
+    void wake_writer();
 
-        // Rotate existing log files
-        char old_name[300], new_name[300];
-        for (int i = max_files - 1; i > 0; i--) {
-            snprintf(old_name, sizeof(old_name), "%s.%d", log_path, i - 1);
-            snprintf(new_name, sizeof(new_name), "%s.%d", log_path, i);
-            rename(old_name, new_name);
-        }
-
-        // Move current log to .0
-        snprintf(new_name, sizeof(new_name), "%s.0", log_path);
-        rename(log_path, new_name);
-
-        // Open new log file
-        log_file = fopen(log_path, "a");
-    }
-
-    void check_rotation() {
-        if (log_file) {
-            fseek(log_file, 0, SEEK_END);
-            long size = ftell(log_file);
-            if (size >= (long)max_file_size) {
-                rotate_logs();
-            }
-        }
-    }
-
-    
     void log_internal(const char* level, const char* context, const char* format, va_list args) {
-        pthread_mutex_lock(&log_mutex);
-
-        check_rotation();
-
-        if (!log_file) {
-            pthread_mutex_unlock(&log_mutex);
-            return;
-        }
-
-        // Get timestamp with milliseconds
-        struct timeval tv;
-        gettimeofday(&tv, NULL);
-        struct tm* tm_info = localtime(&tv.tv_sec);
-
-        char timestamp[64];
-        strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", tm_info);
-
-        // Write log entry
-        va_list args2;
-        va_copy(args2, args);
-
-        /* file */
-        fprintf(log_file, "%s,%03ld - %s - %s - ",
-                timestamp, tv.tv_usec / 1000, context, level);
-        vfprintf(log_file, format, args);
-        fprintf(log_file, "\n");
-        fflush(log_file);
-
-        /* console (stderr) */
-        fprintf(stderr, "%s,%03ld - %s - %s - ",
-                timestamp, tv.tv_usec / 1000, context, level);
-        vfprintf(stderr, format, args2);
-        fprintf(stderr, "\n");
-        fflush(stderr);
-
-        va_end(args2);
-
-        pthread_mutex_unlock(&log_mutex);
+        enqueue(level, context, format, args);
     }
 
 public:
-    SimpleLogger(const char* path, size_t max_size_kb = 256, int num_files = 5)
-        : max_file_size(max_size_kb * 1024), max_files(num_files) {
-        strncpy(log_path, path, sizeof(log_path) - 1);
-        log_file = fopen(log_path, "a");
-        pthread_mutex_init(&log_mutex, NULL);
-    }
+    SimpleLogger(const char* path, size_t max_size_kb = 256, int num_files = 5,
+                 bool mirror_to_console = true);
+    ~SimpleLogger();
+
+    SimpleLogger(const SimpleLogger&) = delete;
+    SimpleLogger& operator=(const SimpleLogger&) = delete;
 
-    ~SimpleLogger() {
-        if (log_file) {
-            fclose(log_file);
-        }
-        pthread_mutex_destroy(&log_mutex);
-    }
     void debug(const char* format, ...) {
         va_list args;
         va_start(args, format);
@@ -171,20 +166,17 @@ public:
         log_internal("CRITICAL", context, format, args);
         va_end(args);
     }
-    
+
     // Raw write method for header logger (writes directly without timestamp/level formatting)
     void write_raw(const char* line) {
-        pthread_mutex_lock(&log_mutex);
-        
-        check_rotation();
-        
-        if (log_file) {
-            fprintf(log_file, "%s\n", line);
-            fflush(log_file);
-        }
-        
-        pthread_mutex_unlock(&log_mutex);
+        enqueue_raw(line);
     }
+
+    // Block until everything queued so far has been written (bounded wait).
+    // Lock-free; safe from a signal handler.
+    void flush();
+
+    uint64_t get_dropped_count() const { return dropped_records.load(std::memory_order_relaxed); }
 };
 
 // Get logger instance (defined in logger.cpp)
@@ -193,60 +185,100 @@ SimpleLogger* get_logger();
 // Get header logger instance (defined in logger.cpp)
 SimpleLogger* get_header_logger();
 
-// Initialize logger - call this once in main() with log directory from config
-void init_logger(const std::string& log_directory = "/srv/UPTIMEDRIVE/logs");
+// Initialize logger - call this once in main() with log directory from config.
+// console_mirror also copies main log lines to stderr.
+void init_logger(const std::string& log_directory = "/srv/UPTIMEDRIVE/logs",
+                 bool console_mirror = true);
+void flush_logger();        // async-signal-safe, see SimpleLogger::flush()
 void cleanup_logger();
 
-// Standard macros (default context: pi_server)
-#define LOG_DEBUG(...) do { \
-    SimpleLogger* logger = get_logger(); \
-    if (logger) logger->debug(__VA_ARGS__); \
-} while(0)
+// ===== Level filtering =====
+//
+// Every context has a threshold (the default unless overridden with
+// set_log_level).  Each macro call site caches its context's threshold in a
+// static LogSite and re-resolves it only when a level changes, so a
+// suppressed call costs one atomic compare and never evaluates its
+// arguments.  Building with -DLOG_DISABLE_DEBUG removes DEBUG calls entirely.
+
+enum LogLevel {
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_CRITICAL,
+    LOG_LEVEL_OFF
+};
 
-#define LOG_INFO(...) do { \
-    SimpleLogger* logger = get_logger(); \
-    if (logger) logger->info(__VA_ARGS__); \
-} while(0)
+// Thread-safe; take effect at every call site on its next use
+void set_default_log_level(int level);
+void set_log_level(const std::string& context, int level);
+void clear_log_levels();                  // drop overrides, default to DEBUG
+int get_log_level(const char* context);
 
-#define LOG_WARN(...) do { \
-    SimpleLogger* logger = get_logger(); \
-    if (logger) logger->warn(__VA_ARGS__); \
-} while(0)
+// "DEBUG", "info", ... -> LogLevel; false if unrecognized
+bool parse_log_level(const std::string& name, int* level);
+const char* log_level_name(int level);
 
-#define LOG_ERROR(...) do { \
-    SimpleLogger* logger = get_logger(); \
-    if (logger) logger->error(__VA_ARGS__); \
-} while(0)
+extern std::atomic<unsigned> g_log_level_generation;
 
-#define LOG_CRITICAL(...) do { \
-    SimpleLogger* logger = get_logger(); \
-    if (logger) logger->critical(__VA_ARGS__); \
-} while(0)
+struct LogSite {
+    const char* context;
+    std::atomic<unsigned> generation;
+    std::atomic<int> threshold;
+    explicit LogSite(const char* ctx) : context(ctx), generation(0), threshold(LOG_LEVEL_DEBUG) {}
+};
 
-// Context macros (custom context)
-#define LOG_DEBUG_CTX(context, ...) do { \
-    SimpleLogger* logger = get_logger(); \
-    if (logger) logger->debug_ctx(context, __VA_ARGS__); \
-} while(0)
+inline bool log_site_enabled(LogSite& site, int level) {
+    unsigned gen = g_log_level_generation.load(std::memory_order_acquire);
+    if (site.generation.load(std::memory_order_relaxed) != gen) {
+        site.threshold.store(get_log_level(site.context), std::memory_order_relaxed);
+        site.generation.store(gen, std::memory_order_relaxed);
+    }
+    return level >= site.threshold.load(std::memory_order_relaxed);
+}
 
-#define LOG_INFO_CTX(context, ...) do { \
-    SimpleLogger* logger = get_logger(); \
-    if (logger) logger->info_ctx(context, __VA_ARGS__); \
-} while(0)
+// Per-call-site cache; context must be a string literal
+#define LOG_SITE(context) ([]() -> LogSite& { static LogSite log_site_(context); return log_site_; }())
 
-#define LOG_WARN_CTX(context, ...) do { \
-    SimpleLogger* logger = get_logger(); \
-    if (logger) logger->warn_ctx(context, __VA_ARGS__); \
-} while(0)
+// True if a message at level would be written for context.  Use it to skip
+// building expensive arguments (hex dumps) that feed several log calls.
+#define LOG_ENABLED_CTX(level, context) log_site_enabled(LOG_SITE(context), level)
 
-#define LOG_ERROR_CTX(context, ...) do { \
-    SimpleLogger* logger = get_logger(); \
-    if (logger) logger->error_ctx(context, __VA_ARGS__); \
+#define LOG_AT_CTX(level, method, context, ...) do { \
+    if (LOG_ENABLED_CTX(level, context)) { \
+        SimpleLogger* logger = get_logger(); \
+        if (logger) logger->method(context, __VA_ARGS__); \
+    } \
 } while(0)
 
-#define LOG_CRITICAL_CTX(context, ...) do { \
-    SimpleLogger* logger = get_logger(); \
-    if (logger) logger->critical_ctx(context, __VA_ARGS__); \
+// Compiled-out call: arguments are still type-checked but never evaluated
+#define LOG_DISCARD_CTX(method, context, ...) do { \
+    if (false) { \
+        SimpleLogger* logger = nullptr; \
+        logger->method(context, __VA_ARGS__); \
+    } \
 } while(0)
 
+// Standard macros (default context: pi_server)
+#ifdef LOG_DISABLE_DEBUG
+#define LOG_DEBUG(...) LOG_DISCARD_CTX(debug_ctx, "pi_server", __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_AT_CTX(LOG_LEVEL_DEBUG, debug_ctx, "pi_server", __VA_ARGS__)
+#endif
+#define LOG_INFO(...) LOG_AT_CTX(LOG_LEVEL_INFO, info_ctx, "pi_server", __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT_CTX(LOG_LEVEL_WARN, warn_ctx, "pi_server", __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT_CTX(LOG_LEVEL_ERROR, error_ctx, "pi_server", __VA_ARGS__)
+#define LOG_CRITICAL(...) LOG_AT_CTX(LOG_LEVEL_CRITICAL, critical_ctx, "pi_server", __VA_ARGS__)
+
+// Context macros (custom context)
+#ifdef LOG_DISABLE_DEBUG
+#define LOG_DEBUG_CTX(context, ...) LOG_DISCARD_CTX(debug_ctx, context, __VA_ARGS__)
+#else
+#define LOG_DEBUG_CTX(context, ...) LOG_AT_CTX(LOG_LEVEL_DEBUG, debug_ctx, context, __VA_ARGS__)
+#endif
+#define LOG_INFO_CTX(context, ...) LOG_AT_CTX(LOG_LEVEL_INFO, info_ctx, context, __VA_ARGS__)
+#define LOG_WARN_CTX(context, ...) LOG_AT_CTX(LOG_LEVEL_WARN, warn_ctx, context, __VA_ARGS__)
+#define LOG_ERROR_CTX(context, ...) LOG_AT_CTX(LOG_LEVEL_ERROR, error_ctx, context, __VA_ARGS__)
+#define LOG_CRITICAL_CTX(context, ...) LOG_AT_CTX(LOG_LEVEL_CRITICAL, critical_ctx, context, __VA_ARGS__)
+
 #endif // LOGGER_H
@@ -7,6 +7,7 @@
 #include <thread>
 #include <cctype>
 #include <fstream>
+#include <iostream>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <dirent.h>
@@ -15,7 +16,6 @@
 #include <vector>
 #include <unistd.h>
 #include <signal.h>
-#include <sys/time.h>
 
 #include "ConfigManager.h"
 #include "logger.h"
@@ -24,6 +24,8 @@
 #include "UartManager.h"
 #include "RadioManager.h"
 #include "SessionManager.h"
+#include "FileWriterThread.h"
+#include "FileWatcher.h"
 #include "pi_server_sleep.h"
 #include "buffer_constants.h"
 #include "SamplesetSupervisor.h"
@@ -43,6 +45,8 @@ struct CommandLineOptions {
 
 // ===== Globals (needed for signal handlers) =====
 static std::atomic<bool> g_running{true};
+static std::atomic<bool> g_reload_log_levels{false};
+static volatile sig_atomic_t g_sigterm_received = 0;
 static UartManager*  g_uart_manager  = nullptr;
 static RadioManager* g_radio_manager = nullptr;
 SamplesetSupervisor* g_sampleset_supervisor = nullptr;
@@ -105,19 +109,44 @@ static bool parse_command_line(int argc, char** argv, CommandLineOptions& option
 }
 
 // ===== Helpers =====
+// SIGTERM: only sets a flag.  The shutdown itself (database flush, UART
+// close, writer and logger drain) takes locks and joins threads, so it runs
+// on the main thread once the loop sees the flag.
 static void handle_sigterm(int) {
-    LOG_INFO("SIGTERM received. Flushing database and closing UART...");
-    if (g_sampleset_supervisor) {
-        g_sampleset_supervisor->flush_database();
-    }
-    if (g_uart_manager) g_uart_manager->close_port();
-    _exit(0);
+    g_sigterm_received = 1;
+}
+
+// SIGHUP: re-read log levels from the config file on the next loop pass
+static void handle_sighup(int) {
+    g_reload_log_levels.store(true);
 }
 
-static void handle_sigalrm(int) {
-    if (g_radio_manager) {
-        g_radio_manager->handle_uart_interrupt();
-        g_radio_manager->increment_interrupt_count();
+// Apply log.level (default threshold) and log.level.<context> overrides
+static void apply_log_levels(const ConfigManager& cfg) {
+    clear_log_levels();
+
+    int level;
+    const std::string default_name = cfg.get("log.level", std::string("DEBUG"));
+    if (parse_log_level(default_name, &level)) {
+        set_default_log_level(level);
+    } else {
+        LOG_WARN("log.level=%s not recognized, keeping DEBUG", default_name.c_str());
+    }
+
+    const std::string prefix = "log.level.";
+    for (const auto& kv : cfg.get_with_prefix(prefix)) {
+        const std::string context = kv.first.substr(prefix.size());
+        if (context.empty()) continue;
+        if (parse_log_level(kv.second, &level)) {
+            set_log_level(context, level);
+        } else {
+            LOG_WARN("%s=%s not recognized, ignored", kv.first.c_str(), kv.second.c_str());
+        }
+    }
+
+    LOG_INFO("log.level: %s", log_level_name(get_log_level(nullptr)));
+    for (const auto& kv : cfg.get_with_prefix(prefix)) {
+        LOG_INFO("%s: %s", kv.first.c_str(), kv.second.c_str());
     }
 }
 
@@ -130,15 +159,6 @@ static inline bool file_exists_readable(const std::string& p) {
     return f.good();
 }
 
-static void timer_useconds(long int usec) {
-    struct itimerval t{};
-    t.it_interval.tv_sec  = 0;
-    t.it_interval.tv_usec = usec;
-    t.it_value.tv_sec     = 0;
-    t.it_value.tv_usec    = usec;
-    setitimer(ITIMER_REAL, &t, nullptr);
-}
-
 // ===== Config validation (sane ranges, existence checks) =====
 static bool validate_config(const ConfigManager& cfg) {
     bool ok = true;
@@ -148,6 +168,7 @@ static bool validate_config(const ConfigManager& cfg) {
     const int radio_sec             = cfg.get("system.radio_check_period_seconds", 28800);
     const int pi_buf_sz             = cfg.get("system.pi_buffer_size", 1048576);
     const int cmd_buf_sz            = cfg.get("system.command_buffer_size", 16);
+    const int frame_budget          = cfg.get("system.max_frames_per_loop", DEFAULT_FRAME_BUDGET);
     const std::string rf_chan_file  = cfg.get("system.rf_channel_file", std::string("/home/pi/channel.txt"));
 
     if (!file_exists_readable(rf_chan_file)) {
@@ -163,22 +184,21 @@ static bool validate_config(const ConfigManager& cfg) {
                   pi_buf_sz, PI_BUFFER_MIN_SIZE, PI_BUFFER_MAX_SIZE); 
         ok = false;
     } else if (!is_power_of_two(pi_buf_sz)) {
-        LOG_WARN("system.pi_buffer_size=%d not a power of two (ring buffers faster with pow2)", pi_buf_sz);
+        LOG_WARN("system.pi_buffer_size=%d not a power of two (ring will be rounded up)", pi_buf_sz);
     }
     if (cmd_buf_sz < CMD_BUFFER_MIN_SIZE || cmd_buf_sz > CMD_BUFFER_MAX_SIZE) {
         LOG_ERROR("system.command_buffer_size=%d out of range [%d..%d]", 
                   cmd_buf_sz, CMD_BUFFER_MIN_SIZE, CMD_BUFFER_MAX_SIZE); 
         ok = false;
     }
+    if (frame_budget < FRAME_BUDGET_MIN || frame_budget > FRAME_BUDGET_MAX) {
+        LOG_ERROR("system.max_frames_per_loop=%d out of range [%d..%d]", 
+                  frame_budget, FRAME_BUDGET_MIN, FRAME_BUDGET_MAX); 
+        ok = false;
+    }
 
     // uart.*
-    const int timer_us = cfg.get("uart.timer_interval_us", 5000);
     const int loop_us  = cfg.get("uart.main_loop_delay_us", 10000);
-    if (timer_us < TIMER_INTERVAL_MIN_US || timer_us > TIMER_INTERVAL_MAX_US) {
-        LOG_ERROR("uart.timer_interval_us=%d out of range [%d..%d]", 
-                  timer_us, TIMER_INTERVAL_MIN_US, TIMER_INTERVAL_MAX_US); 
-        ok = false;
-    }
     if (loop_us < LOOP_DELAY_MIN_US || loop_us > LOOP_DELAY_MAX_US) {
         LOG_ERROR("uart.main_loop_delay_us=%d out of range [%d..%d]", 
                   loop_us, LOOP_DELAY_MIN_US, LOOP_DELAY_MAX_US); 
@@ -235,14 +255,55 @@ static bool validate_config(const ConfigManager& cfg) {
 // ===== UART + buffer service (TX/RX/CMD) =====
 static int g_buffer_modulo = 0;
 
+// Overflow counters as of the last report
+struct RingOverflowCounts {
+    uint64_t bytes = 0;
+    uint64_t events = 0;
+};
+
+static void report_ring_overflow(const char* name, uint64_t bytes, uint64_t events,
+                                 RingOverflowCounts& last)
+{
+    if (bytes != last.bytes) {
+        LOG_WARN("%s ring overflow: %llu bytes dropped in %llu writes since last report (%llu bytes total)",
+                 name, (unsigned long long)(bytes - last.bytes),
+                 (unsigned long long)(events - last.events), (unsigned long long)bytes);
+    }
+    last.bytes = bytes;
+    last.events = events;
+}
+
+// The rings count dropped bytes instead of logging from the write path;
+// report what was lost since the previous call
+static void report_buffer_overflows(pi_buffer* tx_buffer,
+                                    pi_buffer* rx_buffer,
+                                    pi_buffer* cmd_buffer)
+{
+    static RingOverflowCounts uart_last, rx_last, tx_last, cmd_last;
+
+    report_ring_overflow("UART input", g_uart_manager->get_rx_overflow_bytes(),
+                         g_uart_manager->get_rx_overflow_events(), uart_last);
+    report_ring_overflow("rx", rx_buffer->get_overflow_bytes(),
+                         rx_buffer->get_overflow_events(), rx_last);
+    report_ring_overflow("tx", tx_buffer->get_overflow_bytes(),
+                         tx_buffer->get_overflow_events(), tx_last);
+    report_ring_overflow("cmd", cmd_buffer->get_overflow_bytes(),
+                         cmd_buffer->get_overflow_events(), cmd_last);
+}
+
 
 
 static void service_uart_tx_buffer(pi_buffer* tx_buffer){
-  // TX: flush to UART; throttle with radio wait to avoid overrun
-  while (!tx_buffer->empty()) {
-        char ch = tx_buffer->get_char();
-        g_uart_manager->transmit_char(ch);
-        if (++g_buffer_modulo == 128) {
+  // TX: flush to UART one radio frame at a time; wait for the radio's
+  // buffer-empty line after every 128 bytes to avoid overrun
+  const char* region;
+  size_t len;
+  while ((len = tx_buffer->peek(&region)) > 0) {
+        if (len > static_cast<size_t>(CLENG - g_buffer_modulo)) len = CLENG - g_buffer_modulo;
+        g_uart_manager->transmit_frame(reinterpret_cast<const uint8_t*>(region), len);
+        tx_buffer->consume(len);
+        g_buffer_modulo += len;
+        if (g_buffer_modulo == CLENG) {
             g_buffer_modulo = 0;
             g_radio_manager->wait_on_buffer_empty();
         }
@@ -257,10 +318,11 @@ static void service_uart_and_buffers(pi_buffer* tx_buffer,
 
     service_uart_tx_buffer(tx_buffer);
 
-    // RX: pull from UART into rx_buffer
-    while (g_uart_manager->get_input_count() != g_uart_manager->get_output_count()) {
-        char ch = g_uart_manager->get_input_char();
-        rx_buffer->add_char(ch);
+    // RX: pull what the UART reader thread has queued into rx_buffer
+    char chunk[RXUARTBUFF];
+    size_t n;
+    while ((n = g_uart_manager->read_input(chunk, sizeof(chunk))) > 0) {
+        rx_buffer->write(chunk, n);
     }
 
     // CMD: last-wins semantics for radio settings
@@ -307,8 +369,10 @@ int main(int argc, char** argv) {
 
     // ---- Logger initialization with config ----
     std::string log_directory = cfg.get_log_directory();
+    const bool log_console = cfg.get("system.log_console", true);
     std::cout << "Initializing logger with directory: " << log_directory << std::endl;
-    init_logger(log_directory);
+    init_logger(log_directory, log_console);
+    apply_log_levels(cfg);
 
     // Log operating mode
     if (options.monitor_mode) {
@@ -327,8 +391,9 @@ int main(int argc, char** argv) {
     LOG_INFO("system.radio_check_period_seconds: %d", cfg.get("system.radio_check_period_seconds", 28800));
     LOG_INFO("system.pi_buffer_size: %d", cfg.get("system.pi_buffer_size", 1048576));
     LOG_INFO("system.command_buffer_size: %d", cfg.get("system.command_buffer_size", 16));
+    LOG_INFO("system.max_frames_per_loop: %d", cfg.get("system.max_frames_per_loop", DEFAULT_FRAME_BUDGET));
+    LOG_INFO("system.log_console: %s", log_console ? "true" : "false");
     LOG_INFO("system.rf_channel_file: %s", cfg.get("system.rf_channel_file", std::string("/home/pi/channel.txt")).c_str());
-    LOG_INFO("uart.timer_interval_us: %d", cfg.get("uart.timer_interval_us", 5000));
     LOG_INFO("uart.main_loop_delay_us: %d", cfg.get("uart.main_loop_delay_us", 10000));
 
     if (!validate_config(cfg)) return EXIT_FAILURE;
@@ -338,16 +403,16 @@ int main(int argc, char** argv) {
     const int RADIO_CHECK_PERIOD_SECONDS = cfg.get("system.radio_check_period_seconds", 28800);
     const int PI_BUFFER_SIZE  = cfg.get("system.pi_buffer_size", 1048576);
     const int CMD_BUFFER_SIZE = cfg.get("system.command_buffer_size", 16);
-    const int TIMER_US        = cfg.get("uart.timer_interval_us", 5000);
+    const int FRAME_BUDGET    = cfg.get("system.max_frames_per_loop", DEFAULT_FRAME_BUDGET);
     const int LOOP_US         = cfg.get("uart.main_loop_delay_us", 10000);
 
     // Create/refresh ping file at startup
     if (FILE* f = fopen(PING_FILE.c_str(), "w")) fclose(f);
 
-    // ---- Signals & periodic timer ----
+    // ---- Signals ----
+    // UART input is read by UartManager's own thread (started in open_port)
     signal(SIGTERM, &handle_sigterm);
-    signal(SIGALRM, &handle_sigalrm);
-    timer_useconds(TIMER_US);
+    signal(SIGHUP, &handle_sighup);
 
     // ---- Managers & device init ----
     g_uart_manager  = new UartManager();
@@ -361,6 +426,7 @@ int main(int argc, char** argv) {
     unit->init_utility();
     unit->set_tx_buffer(tx_buffer);
     unit->set_flush_callback(service_uart_tx_buffer_callback);
+    unit->set_frame_budget(FRAME_BUDGET);
 
     // ---- Initialize Config Broadcaster ----
     // SessionManager is already created inside CTS1X, so get it
@@ -420,8 +486,23 @@ int main(int argc, char** argv) {
     LOG_INFO("  Samplesets: %zu", g_sampleset_supervisor->get_sampleset_count());
     LOG_INFO("  Database entries: %zu", g_sampleset_supervisor->get_database_entry_count());
 
+    // ---- File change notifications ----
+    // Reloads follow inotify events instead of periodic stat() checks
+    FileWatcher file_watcher(cfg.get("watch.debounce_ms", FILE_WATCH_DEBOUNCE_MS));
+    const bool file_watch_active = cfg.get("watch.enabled", true) && file_watcher.start();
+    if (file_watch_active) {
+        file_watcher.watch_file(WATCH_SAMPLING_FILE, ts1x_sampling_file);
+        file_watcher.watch_file(WATCH_NODELIST, cfg.get_node_list_file());
+        file_watcher.watch_directory(WATCH_CONFIG_FILES, config_dir);
+        file_watcher.watch_file(WATCH_SERVER_CONFIG, cfg_path);
+        session_mgr->set_file_change_notifications(true);
+    } else {
+        LOG_INFO("File watcher off, checking %s every %d s",
+                 ts1x_sampling_file.c_str(), CONFIG_FILE_CHECK_INTERVAL_SEC);
+    }
+
     LOG_INFO("Starting radio...");
-    while (!g_radio_manager->start()) {
+    while (!g_sigterm_received && !g_radio_manager->start()) {
         Server_sleep_ms(RADIO_STARTUP_RETRY_DELAY_MS); // retry every 200 ms until radio ready
     }
     LOG_INFO("Radio is OK!");
@@ -430,13 +511,15 @@ int main(int argc, char** argv) {
     auto radio_check_tstamp = std::chrono::system_clock::now();
     auto database_flush_tstamp = std::chrono::system_clock::now();
     auto config_check_tstamp = std::chrono::system_clock::now();
+    auto overflow_report_tstamp = std::chrono::system_clock::now();
+    auto file_watch_tstamp = std::chrono::steady_clock::now();  // immune to clock steps
     int  modulo_counter     = 0;
     bool first_time_through = true;
     g_buffer_modulo         = 0;
 
     LOG_INFO("Startup complete. Entering main loop.");
 
-    while (true) {
+    while (!g_sigterm_received) {
         // Periodic radio check
         auto now = std::chrono::system_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - radio_check_tstamp).count();
@@ -445,6 +528,18 @@ int main(int argc, char** argv) {
             radio_check_tstamp = std::chrono::system_clock::now();
         }
 
+        // Periodic ring overflow report
+        auto overflow_elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - overflow_report_tstamp).count();
+        if (overflow_elapsed >= BUFFER_OVERFLOW_REPORT_INTERVAL_SEC) {
+            report_buffer_overflows(tx_buffer, rx_buffer, cmd_buffer);
+            overflow_report_tstamp = now;
+        }
+
+        // Batched journal sync of recorded sample times
+        if (g_sampleset_supervisor) {
+            g_sampleset_supervisor->sync_database();
+        }
+
         // Periodic database flush (every hour)
         auto flush_elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - database_flush_tstamp).count();
         if (flush_elapsed >= DATABASE_FLUSH_INTERVAL_SEC) {  // 3600 seconds = 1 hour
@@ -455,9 +550,34 @@ int main(int argc, char** argv) {
             }
         }
         
-        // Check for config file changes (every 30 seconds)
+        // Watched files changed (debounced, polled every 200 ms)
+        auto watch_now = std::chrono::steady_clock::now();
+        auto watch_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(watch_now - file_watch_tstamp).count();
+        if (file_watch_active && watch_elapsed >= FILE_WATCH_POLL_INTERVAL_MS) {
+            file_watch_tstamp = watch_now;
+            uint32_t changed = file_watcher.poll();
+            if ((changed & FILE_WATCH_BIT(WATCH_SAMPLING_FILE)) && g_sampleset_supervisor) {
+                LOG_INFO("Sampling file changed - reloading samplesets");
+                if (g_sampleset_supervisor->reload_configuration()) {
+                    g_sampleset_supervisor->print_samplesets();
+                }
+            }
+            if (changed & FILE_WATCH_BIT(WATCH_NODELIST)) {
+                session_mgr->on_nodelist_changed();
+            }
+            if (changed & FILE_WATCH_BIT(WATCH_CONFIG_FILES)) {
+                session_mgr->on_config_files_changed();
+            }
+            if (changed & FILE_WATCH_BIT(WATCH_SERVER_CONFIG)) {
+                // Same reload as SIGHUP, handled below
+                LOG_INFO("%s changed", cfg_path.c_str());
+                g_reload_log_levels.store(true);
+            }
+        }
+
+        // Check for config file changes (every 2 minutes, without the watcher)
         auto config_elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - config_check_tstamp).count();
-        if (config_elapsed >= CONFIG_FILE_CHECK_INTERVAL_SEC) {  // Check every 30 seconds
+        if (!file_watch_active && config_elapsed >= CONFIG_FILE_CHECK_INTERVAL_SEC) {
             if (g_sampleset_supervisor) {
                 if (g_sampleset_supervisor->check_and_reload_if_changed()) {
                     LOG_INFO("Configuration file changed - samplesets updated");
@@ -467,6 +587,16 @@ int main(int argc, char** argv) {
             }
         }
 
+        // Log level change requested (kill -HUP or config file changed)
+        if (g_reload_log_levels.exchange(false)) {
+            if (cfg.load(cfg_path)) {
+                LOG_INFO("Reloading log levels from %s", cfg_path.c_str());
+                apply_log_levels(cfg);
+            } else {
+                LOG_ERROR("Failed to reload %s, log levels unchanged", cfg_path.c_str());
+            }
+        }
+
         // First-time RF channel init (reads system.rf_channel_file)
         if (first_time_through) {
             first_time_through = false;
@@ -476,16 +606,18 @@ int main(int argc, char** argv) {
         // UART service: TX/RX/CMD
         service_uart_and_buffers(tx_buffer, rx_buffer, cmd_buffer);
 
-        // Drain RX chars into TS1X
-        int bcount=rx_buffer->get_count();
-        //if(bcount)printf("drain %d bytes\n",bcount);
-        for (int i=0;i<bcount;i++){
-            if(!rx_buffer->empty()){
-                 char ch = rx_buffer->get_char();
-                //printf("Transfer data to ts1x unit: %x, buffer fullness %d\n",ch,unit->get_ibuf_count());
-                unit->rx_char(ch);
-                //printf("buffer cnt %d, ibuf cnt %d: %02x (%c)\n",rx_buffer->get_count(),unit->get_ibuf_count(),ch, isprint(ch) ? ch : '.');
+        // Drain RX chars into TS1X, never more than its ring can hold;
+        // anything left stays queued in rx_buffer for the next iteration
+        const char* rx_region;
+        size_t rx_len;
+        while ((rx_len = rx_buffer->peek(&rx_region)) > 0) {
+            size_t ibuf_free = IBUF_MAX - 1 - unit->get_ibuf_count();
+            if (ibuf_free == 0) break;
+            if (rx_len > ibuf_free) rx_len = ibuf_free;
+            for (size_t i = 0; i < rx_len; i++) {
+                unit->rx_char(rx_region[i]);
             }
+            rx_buffer->consume(rx_len);
         }
         /*
         while (!rx_buffer->empty()) {
@@ -495,17 +627,9 @@ int main(int argc, char** argv) {
             //printf("buffer cnt %d, ibuf cnt %d: %02x (%c)\n",rx_buffer->get_count(),unit->get_ibuf_count(),ch, isprint(ch) ? ch : '.');
         }*/
 
-        // TS1X main processing (includes SessionManager processing)
-        //if(unit->get_ibuf_count()>=CLENG)
-        //    LOG_INFO("go_main data count: %d",unit->get_ibuf_count());
+        // TS1X main processing: parses all queued frames (up to the
+        // frame budget), then runs the SessionManager state machine once
         unit->go_main(true);
-#ifdef DOOOOO
-        int sv_delta = unit->get_ibuf_count();
-        while(sv_delta>=CLENG){
-            LOG_INFO("Additional RX buffer drain, count: %d",sv_delta);
-            unit->go_main(true); // drain rx buffer
-            sv_delta = unit->get_ibuf_count();
-#endif
 
         // Periodic ping file touch
         if (!(modulo_counter++ % PING_FILE_UPDATE_MODULO)) {
@@ -517,14 +641,16 @@ int main(int argc, char** argv) {
         else             std::this_thread::yield();
     }
 
-    // (Normally never reached)
-    LOG_INFO("Shutting down - flushing database...");
+    // ---- Shutdown (SIGTERM) ----
+    LOG_INFO("SIGTERM received. Flushing database and closing UART...");
     if (g_sampleset_supervisor) {
         g_sampleset_supervisor->flush_database();
         delete g_sampleset_supervisor;
         g_sampleset_supervisor = nullptr;
     }
-    
+    g_uart_manager->close_port();
+    FileWriterThread::flush_active(SHUTDOWN_WRITER_FLUSH_TIMEOUT_MS);
+
     cleanup_logger(); 
     delete unit;
     delete rx_buffer;
@@ -1,50 +1,122 @@
 #include "pi_buffer.h"
 
+#include <string.h>
+
+static size_t round_up_pow2(size_t n)
+{
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
 pi_buffer::pi_buffer(int m_size)
+    : head(0), tail(0), overflow_bytes(0), overflow_events(0)
 {
-    //ctor
-    char_buf=new char[m_size];
-    icnt=0;
-    ocnt=0;
-    char_count=0;
-    sv_size=m_size;
+    sv_size = round_up_pow2(m_size > 0 ? static_cast<size_t>(m_size) : 1);
+    mask = sv_size - 1;
+    char_buf = new char[sv_size];
 }
 
 pi_buffer::~pi_buffer()
 {
-    delete char_buf;
-    //dtor
+    delete[] char_buf;
 }
 
 void pi_buffer::add_char(char ch){
-    if(!full()){
-        char_count++;
-        char_buf[icnt++]=ch;
-        if(icnt==sv_size)icnt=0;
-    }
-    else{
-        cout<<"**** buffer overflow"<<endl;
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == sv_size) {
+        note_overflow(1);
+        return;
     }
+    char_buf[h & mask] = ch;
+    head.store(h + 1, std::memory_order_release);
 }
 
 char pi_buffer::get_char(){
-    char retval=0;
-    if(!empty()){
-        char_count--;
-        retval=char_buf[ocnt++];
-        if(ocnt==sv_size)ocnt=0;
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (head.load(std::memory_order_acquire) == t) {
+        return 0;
     }
+    char retval = char_buf[t & mask];
+    tail.store(t + 1, std::memory_order_release);
     return retval;
 }
 
-bool pi_buffer::empty(){
-    return(!char_count);
+bool pi_buffer::empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
+
+bool pi_buffer::full() const {
+    return get_count() == static_cast<int>(sv_size);
+}
+
+int pi_buffer::get_count() const {
+    return static_cast<int>(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+}
+
+size_t pi_buffer::write(const char* data, size_t len){
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t space = sv_size - (h - tail.load(std::memory_order_acquire));
+    size_t n = len < space ? len : space;
+
+    size_t offset = h & mask;
+    size_t first = sv_size - offset;
+    if (first > n) first = n;
+    memcpy(char_buf + offset, data, first);
+    memcpy(char_buf, data + first, n - first);
+    head.store(h + n, std::memory_order_release);
+
+    if (n < len) {
+        note_overflow(len - n);
+    }
+    return n;
+}
+
+size_t pi_buffer::read(char* data, size_t len){
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t avail = head.load(std::memory_order_acquire) - t;
+    size_t n = len < avail ? len : avail;
+
+    size_t offset = t & mask;
+    size_t first = sv_size - offset;
+    if (first > n) first = n;
+    memcpy(data, char_buf + offset, first);
+    memcpy(data + first, char_buf, n - first);
+    tail.store(t + n, std::memory_order_release);
+    return n;
+}
+
+size_t pi_buffer::peek(const char** region) const {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t avail = head.load(std::memory_order_acquire) - t;
+    size_t offset = t & mask;
+    size_t contiguous = sv_size - offset;
+    *region = char_buf + offset;
+    return avail < contiguous ? avail : contiguous;
+}
+
+void pi_buffer::consume(size_t len){
+    tail.store(tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+}
+
+size_t pi_buffer::write_region(char** region){
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t space = sv_size - (h - tail.load(std::memory_order_acquire));
+    size_t offset = h & mask;
+    size_t contiguous = sv_size - offset;
+    *region = char_buf + offset;
+    return space < contiguous ? space : contiguous;
+}
+
+void pi_buffer::commit(size_t len){
+    head.store(head.load(std::memory_order_relaxed) + len, std::memory_order_release);
 }
 
-bool pi_buffer::full(){
-    return (char_count==sv_size);
+void pi_buffer::discard_all(){
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
 }
 
-int pi_buffer::get_count(){
-    return char_count;
+void pi_buffer::note_overflow(size_t len){
+    overflow_bytes.fetch_add(len, std::memory_order_relaxed);
+    overflow_events.fetch_add(1, std::memory_order_relaxed);
 }
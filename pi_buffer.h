@@ -1,36 +1,69 @@
-#include <stdlib.h>
-#include <string.h>
-
-#include <iostream>
-#include <string>
-#include <algorithm>
-#include <fstream>
-
-#include <climits>
-#include <numeric>
-#include <functional>
-using namespace std;
-
 #ifndef PI_BUFFER_H
 #define PI_BUFFER_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Cache line size used to keep producer and consumer indices apart
+#define PI_BUFFER_CACHE_LINE 64
+
+// Single-producer / single-consumer byte ring.
+//
+// Capacity is rounded up to a power of two.  head is only advanced by the
+// producer and tail only by the consumer; each is published with release
+// and read with acquire, so one thread may write while another reads without
+// locks.  The indices run freely and are masked on access, so the full
+// capacity is usable.
+//
+// Writes that do not fit are truncated and counted in the overflow counters
+// rather than blocking or logging.
 class pi_buffer
 {
     public:
-        pi_buffer(int size);
-        virtual ~pi_buffer();
+        explicit pi_buffer(int size);
+        ~pi_buffer();
+
+        pi_buffer(const pi_buffer&) = delete;
+        pi_buffer& operator=(const pi_buffer&) = delete;
+
+        // Byte-at-a-time access
         void add_char(char);
         char get_char();
-        bool empty();
-        bool full();
-        int get_count();
-    protected:
+        bool empty() const;
+        bool full() const;
+        int get_count() const;
+
+        // Bulk access; return the number of bytes actually copied
+        size_t write(const char* data, size_t len);
+        size_t read(char* data, size_t len);
+
+        // Zero-copy access: contiguous readable (peek) or writable
+        // (write_region) span, followed by consume()/commit() of what was used
+        size_t peek(const char** region) const;
+        void consume(size_t len);
+        size_t write_region(char** region);
+        void commit(size_t len);
+
+        // Consumer-side discard of everything currently queued
+        void discard_all();
+
+        // Producer-side accounting for bytes that could not be queued
+        void note_overflow(size_t len);
+
+        size_t capacity() const { return sv_size; }
+        uint64_t get_overflow_bytes() const { return overflow_bytes.load(std::memory_order_relaxed); }
+        uint64_t get_overflow_events() const { return overflow_events.load(std::memory_order_relaxed); }
+
     private:
-    char *char_buf;
-    int icnt;
-    int ocnt;
-    int char_count;
-    int sv_size;
+        char* char_buf;
+        size_t sv_size;
+        size_t mask;
+
+        alignas(PI_BUFFER_CACHE_LINE) std::atomic<size_t> head;   // producer
+        alignas(PI_BUFFER_CACHE_LINE) std::atomic<size_t> tail;   // consumer
+        alignas(PI_BUFFER_CACHE_LINE) std::atomic<uint64_t> overflow_bytes;
+        std::atomic<uint64_t> overflow_events;
 };
 
 #endif // PI_BUFFER_H
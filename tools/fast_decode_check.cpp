@@ -0,0 +1,169 @@
+// fast_decode_check - decode_fast_samples() against the original FAST loop
+//
+//   fast_decode_check [random_payloads]
+//
+// Decodes fixed patterns (all zeros, all ones, every single bit) and random
+// 120-byte payloads with both the per-sample loop parse_upload_data() used
+// before decode_fast_samples() and the kernel itself, and requires
+// identical samples.  Then times both.  Exits non-zero on any mismatch.
+//
+// make check builds this once per kernel path: native (NEON on the Pi,
+// SSE2 on x86), scalar, and NEON through tools/neon_shim on hosts without
+// an ARM compiler (bit-exact, but the shim's timings mean nothing, so that
+// build prints "not timed").
+//
+// Build: make tools
+
+#include "../CommandReceiverSubs.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#if defined(__ARM_NEON) && !defined(__arm__) && !defined(__aarch64__)
+#define KERNEL_PATH "NEON (emulated)"
+#define KERNEL_EMULATED 1
+#elif defined(__ARM_NEON)
+#define KERNEL_PATH "NEON"
+#elif defined(__SSE2__)
+#define KERNEL_PATH "SSE2"
+#else
+#define KERNEL_PATH "scalar"
+#endif
+
+#define FAST_PACKED_BYTES 120
+
+namespace {
+
+// The decoder parse_upload_data() used before decode_fast_samples()
+void legacy_decode(const unsigned char* packed, int16_t out[64])
+{
+    int16_t samples[64];
+    int sample_idx = 0;
+    int save_first = 0;
+    int lcnt = 0;
+
+    for (int i = 0; i < 64; i++) {
+        if ((i & 0xf) == 0) {
+            save_first = 0;
+            sample_idx++;  // Skip first sample of each group of 16
+        } else {
+            int ret = ((packed[lcnt * 2] << 8) & 0xff00) |
+                      (packed[lcnt * 2 + 1] & 0xff);
+
+            if (ret & 1) {
+                save_first += 0x8000;  // Transfer bit from saved sample
+            }
+
+            ret &= 0xfffe;  // Clear lower bit - it's trash in this mode
+
+            if (ret & 2) {
+                ret++;  // Dithering function
+            }
+
+            samples[sample_idx] = ret - 32768;  // Convert to signed
+
+            if ((i & 0xf) == 0xf) {
+                samples[sample_idx - 15] = save_first - 32768;
+            }
+
+            save_first >>= 1;
+            lcnt++;
+            sample_idx++;
+        }
+    }
+
+    for (int i = 0; i < 64; i++) {
+        out[i] = samples[i];
+    }
+}
+
+bool check_payload(const unsigned char* packed, const char* what)
+{
+    int16_t expected[64];
+    int16_t actual[64];
+    legacy_decode(packed, expected);
+    CommandReceiverSubs::decode_fast_samples(packed, actual);
+    for (int i = 0; i < 64; i++) {
+        if (expected[i] != actual[i]) {
+            fprintf(stderr, "FAIL [%s] %s: sample %d is %d, expected %d\n",
+                    KERNEL_PATH, what, i, actual[i], expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Decode>
+double time_decode(const std::vector<unsigned char>& payloads, int rounds, Decode decode,
+                   uint32_t* checksum)
+{
+    size_t count = payloads.size() / FAST_PACKED_BYTES;
+    int16_t samples[64];
+    uint32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t p = 0; p < count; p++) {
+            decode(&payloads[p * FAST_PACKED_BYTES], samples);
+            sum += (uint16_t)samples[p & 63];
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    *checksum = sum;
+    return elapsed.count() / ((double)rounds * count);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int random_count = argc > 1 ? atoi(argv[1]) : 200000;
+    unsigned char packed[FAST_PACKED_BYTES];
+
+    memset(packed, 0x00, sizeof(packed));
+    if (!check_payload(packed, "all zeros")) return 1;
+    memset(packed, 0xff, sizeof(packed));
+    if (!check_payload(packed, "all ones")) return 1;
+
+    for (int bit = 0; bit < FAST_PACKED_BYTES * 8; bit++) {
+        char what[32];
+        snprintf(what, sizeof(what), "bit %d", bit);
+        memset(packed, 0x00, sizeof(packed));
+        packed[bit / 8] = (unsigned char)(0x80 >> (bit % 8));
+        if (!check_payload(packed, what)) return 1;
+        memset(packed, 0xff, sizeof(packed));
+        packed[bit / 8] ^= (unsigned char)(0x80 >> (bit % 8));
+        if (!check_payload(packed, what)) return 1;
+    }
+
+    std::mt19937 rng(20261016);
+    std::vector<unsigned char> payloads(4096 * FAST_PACKED_BYTES);
+    for (int n = 0; n < random_count; n++) {
+        for (auto& byte : packed) {
+            byte = (unsigned char)rng();
+        }
+        if (!check_payload(packed, "random payload")) return 1;
+        if ((size_t)n < payloads.size() / FAST_PACKED_BYTES) {
+            memcpy(&payloads[n * FAST_PACKED_BYTES], packed, sizeof(packed));
+        }
+    }
+
+#ifdef KERNEL_EMULATED
+    printf("fast_decode_check [%s]: %d payloads OK; not timed\n",
+           KERNEL_PATH, random_count + 2 + FAST_PACKED_BYTES * 16);
+    return 0;
+#else
+    uint32_t legacy_sum = 0;
+    uint32_t kernel_sum = 0;
+    double legacy_ns = time_decode(payloads, 50, legacy_decode, &legacy_sum);
+    double kernel_ns = time_decode(payloads, 50, CommandReceiverSubs::decode_fast_samples,
+                                   &kernel_sum);
+
+    printf("fast_decode_check [%s]: %d payloads OK; loop %.1f ns, kernel %.1f ns per packet (%.1fx)\n",
+           KERNEL_PATH, random_count + 2 + FAST_PACKED_BYTES * 16,
+           legacy_ns, kernel_ns, legacy_ns / kernel_ns);
+    return legacy_sum == kernel_sum ? 0 : 1;
+#endif
+}
@@ -0,0 +1,37 @@
+// Portable stand-in for <arm_acle.h>, tools only
+//
+// The ARMv8 CRC32 instructions the server uses (make check builds them with
+// -D__ARM_FEATURE_CRC32 -Itools/neon_shim).  Same reflected polynomial and
+// no pre/post inversion, exactly as the instructions; bit-at-a-time, so
+// only results are representative, not speed.
+
+#ifndef TOOLS_NEON_SHIM_ARM_ACLE_H
+#define TOOLS_NEON_SHIM_ARM_ACLE_H
+
+#include <cstdint>
+
+static inline uint32_t neon_shim_crc32(uint32_t crc, uint32_t data, int bits)
+{
+    crc ^= data;
+    for (int i = 0; i < bits; i++) {
+        crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+    }
+    return crc;
+}
+
+static inline uint32_t __crc32b(uint32_t crc, uint8_t data)
+{
+    return neon_shim_crc32(crc, data, 8);
+}
+
+static inline uint32_t __crc32h(uint32_t crc, uint16_t data)
+{
+    return neon_shim_crc32(crc, data, 16);
+}
+
+static inline uint32_t __crc32w(uint32_t crc, uint32_t data)
+{
+    return neon_shim_crc32(crc, data, 32);
+}
+
+#endif // TOOLS_NEON_SHIM_ARM_ACLE_H
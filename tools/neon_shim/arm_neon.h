@@ -0,0 +1,167 @@
+// Portable stand-in for <arm_neon.h>, tools only
+//
+// Lets the NEON paths of the server build and run on a host without an ARM
+// compiler (make check builds them with -D__ARM_NEON -Itools/neon_shim).
+// Only the intrinsics those paths use are provided.  Every vector type is a
+// distinct struct, so mixing up lane types fails to compile here just as it
+// would with the real header; lanes are little-endian as on the Pi.
+// Results are bit-exact; speed is not representative.
+
+#ifndef TOOLS_NEON_SHIM_ARM_NEON_H
+#define TOOLS_NEON_SHIM_ARM_NEON_H
+
+#include <cstdint>
+#include <cstring>
+
+#define NEON_SHIM 1
+
+struct uint8x16_t { uint8_t lane[16]; };
+struct uint16x8_t { uint16_t lane[8]; };
+struct int16x8_t  { int16_t lane[8]; };
+struct uint32x4_t { uint32_t lane[4]; };
+struct uint64x2_t { uint64_t lane[2]; };
+
+// ---- Load / store / duplicate
+
+static inline uint8x16_t vld1q_u8(const uint8_t* p)
+{
+    uint8x16_t r;
+    memcpy(r.lane, p, sizeof(r.lane));
+    return r;
+}
+
+static inline int16x8_t vld1q_s16(const int16_t* p)
+{
+    int16x8_t r;
+    memcpy(r.lane, p, sizeof(r.lane));
+    return r;
+}
+
+static inline void vst1q_s16(int16_t* p, int16x8_t a)
+{
+    memcpy(p, a.lane, sizeof(a.lane));
+}
+
+static inline uint16x8_t vdupq_n_u16(uint16_t x)
+{
+    uint16x8_t r;
+    for (int i = 0; i < 8; i++) r.lane[i] = x;
+    return r;
+}
+
+static inline uint32x4_t vdupq_n_u32(uint32_t x)
+{
+    uint32x4_t r;
+    for (int i = 0; i < 4; i++) r.lane[i] = x;
+    return r;
+}
+
+static inline uint64_t vgetq_lane_u64(uint64x2_t a, int lane)
+{
+    return a.lane[lane];
+}
+
+// ---- Reinterpret (same 16 bytes, little-endian lanes)
+
+static inline uint16x8_t vreinterpretq_u16_u8(uint8x16_t a)
+{
+    uint16x8_t r;
+    memcpy(r.lane, a.lane, sizeof(r.lane));
+    return r;
+}
+
+static inline int16x8_t vreinterpretq_s16_u16(uint16x8_t a)
+{
+    int16x8_t r;
+    memcpy(r.lane, a.lane, sizeof(r.lane));
+    return r;
+}
+
+// ---- Bitwise / shifts
+
+static inline uint8x16_t vrev16q_u8(uint8x16_t a)
+{
+    uint8x16_t r;
+    for (int i = 0; i < 16; i += 2) {
+        r.lane[i] = a.lane[i + 1];
+        r.lane[i + 1] = a.lane[i];
+    }
+    return r;
+}
+
+static inline uint16x8_t vandq_u16(uint16x8_t a, uint16x8_t b)
+{
+    uint16x8_t r;
+    for (int i = 0; i < 8; i++) r.lane[i] = a.lane[i] & b.lane[i];
+    return r;
+}
+
+static inline uint16x8_t vorrq_u16(uint16x8_t a, uint16x8_t b)
+{
+    uint16x8_t r;
+    for (int i = 0; i < 8; i++) r.lane[i] = a.lane[i] | b.lane[i];
+    return r;
+}
+
+static inline uint16x8_t veorq_u16(uint16x8_t a, uint16x8_t b)
+{
+    uint16x8_t r;
+    for (int i = 0; i < 8; i++) r.lane[i] = a.lane[i] ^ b.lane[i];
+    return r;
+}
+
+static inline uint16x8_t vshrq_n_u16(uint16x8_t a, int n)
+{
+    uint16x8_t r;
+    for (int i = 0; i < 8; i++) r.lane[i] = (uint16_t)(a.lane[i] >> n);
+    return r;
+}
+
+// Shift each lane left by the signed low byte of b (negative shifts right)
+static inline uint16x8_t vshlq_u16(uint16x8_t a, int16x8_t b)
+{
+    uint16x8_t r;
+    for (int i = 0; i < 8; i++) {
+        int n = (int8_t)(b.lane[i] & 0xff);
+        if (n >= 16 || n <= -16) {
+            r.lane[i] = 0;
+        } else if (n >= 0) {
+            r.lane[i] = (uint16_t)(a.lane[i] << n);
+        } else {
+            r.lane[i] = (uint16_t)(a.lane[i] >> -n);
+        }
+    }
+    return r;
+}
+
+// ---- Pairwise add long (and accumulate)
+
+static inline uint16x8_t vpaddlq_u8(uint8x16_t a)
+{
+    uint16x8_t r;
+    for (int i = 0; i < 8; i++) r.lane[i] = (uint16_t)(a.lane[2 * i] + a.lane[2 * i + 1]);
+    return r;
+}
+
+static inline uint32x4_t vpaddlq_u16(uint16x8_t a)
+{
+    uint32x4_t r;
+    for (int i = 0; i < 4; i++) r.lane[i] = (uint32_t)a.lane[2 * i] + a.lane[2 * i + 1];
+    return r;
+}
+
+static inline uint64x2_t vpaddlq_u32(uint32x4_t a)
+{
+    uint64x2_t r;
+    for (int i = 0; i < 2; i++) r.lane[i] = (uint64_t)a.lane[2 * i] + a.lane[2 * i + 1];
+    return r;
+}
+
+static inline uint32x4_t vpadalq_u16(uint32x4_t acc, uint16x8_t a)
+{
+    uint32x4_t r;
+    for (int i = 0; i < 4; i++) r.lane[i] = acc.lane[i] + a.lane[2 * i] + a.lane[2 * i + 1];
+    return r;
+}
+
+#endif // TOOLS_NEON_SHIM_ARM_NEON_H
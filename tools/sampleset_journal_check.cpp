@@ -0,0 +1,416 @@
+// sampleset_journal_check - SamplesetDataManager snapshot + journal recovery
+//
+//   sampleset_journal_check [work_dir]
+//
+// Records sample times, copies the database and journal aside as a power
+// cut would leave them, and loads the copy in a fresh manager:
+//
+//   replay      synced journal records come back without a snapshot
+//   torn tail   a partial record after the last good one is cut off
+//   corrupt     replay stops at the first record with a bad CRC
+//   compaction  the snapshot is renamed, its directory fsync'd, and only
+//               then is the journal truncated; nothing is lost
+//   dir fsync   if the directory fsync fails, the journal is kept
+//   write fail  after a failed journal write, compaction clears the closed
+//               journal by path and later records are journaled again
+//
+// rename, fsync, ftruncate and write are wrapped here to record the order
+// of operations and to inject failures.  Exits non-zero on the first
+// failed check.  Without work_dir a temporary directory is used and
+// removed unless a check fails.
+//
+// Build: make tools
+
+#include "../ConfigManager.h"
+#include "../SamplesetDataManager.h"
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#define COMPACT_RECORDS 64
+#define JOURNAL_RECORD_BYTES 32
+
+// ===== Wrapped libc calls =====
+
+namespace {
+
+std::vector<std::string> g_events;
+bool g_fail_dir_fsync = false;
+ino_t g_fail_write_ino = 0;         // fail one write() to this file
+
+bool is_directory(int fd)
+{
+    struct stat st;
+    return fstat(fd, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+template <typename Function>
+Function next_symbol(const char* name)
+{
+    return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+}
+
+} // namespace
+
+extern "C" int rename(const char* from, const char* to)
+{
+    static auto real = next_symbol<int (*)(const char*, const char*)>("rename");
+    g_events.push_back("rename");
+    return real(from, to);
+}
+
+extern "C" int fsync(int fd)
+{
+    static auto real = next_symbol<int (*)(int)>("fsync");
+    if (is_directory(fd)) {
+        g_events.push_back("fsync dir");
+        if (g_fail_dir_fsync) {
+            errno = EIO;
+            return -1;
+        }
+    }
+    return real(fd);
+}
+
+extern "C" int ftruncate(int fd, off_t length)
+{
+    static auto real = next_symbol<int (*)(int, off_t)>("ftruncate");
+    g_events.push_back(length == 0 ? "ftruncate 0" : "ftruncate");
+    return real(fd, length);
+}
+
+extern "C" ssize_t write(int fd, const void* data, size_t length)
+{
+    static auto real = next_symbol<ssize_t (*)(int, const void*, size_t)>("write");
+    struct stat st;
+    if (g_fail_write_ino != 0 && fstat(fd, &st) == 0 && st.st_ino == g_fail_write_ino) {
+        g_fail_write_ino = 0;
+        errno = EIO;
+        return -1;
+    }
+    return real(fd, data, length);
+}
+
+namespace {
+
+std::string g_dir;
+
+std::string path_of(const std::string& name)
+{
+    return g_dir + "/" + name;
+}
+
+bool fail(const char* check, const char* what)
+{
+    fprintf(stderr, "FAIL %s: %s\n", check, what);
+    return false;
+}
+
+Sampleset make_sampleset(int n)
+{
+    Sampleset s;
+    s.nodeid = 0x00111500 + n;
+    s.sampling_mask = (uint8_t)(1 + (n & 3));
+    s.max_freq = n & 1 ? 2500.0 : 0.0;
+    s.resolution = n & 1 ? 4096 : 0;
+    s.interval = 600.0 + n;
+    s.priority = 0;
+    s.ac_dc_flag = n & 1;
+    return s;
+}
+
+// What the table must hold: sampleset index -> last recorded time
+typedef std::map<int, time_t> Model;
+
+void record(SamplesetDataManager& db, Model& model, int n, time_t t)
+{
+    db.recordSample(make_sampleset(n), t);
+    model[n] = t;
+}
+
+bool matches(const SamplesetDataManager& db, const Model& model, int samplesets)
+{
+    for (int n = 0; n < samplesets; n++) {
+        auto it = model.find(n);
+        time_t expected = it == model.end() ? 0 : it->second;
+        if (db.getLastSampleTime(make_sampleset(n)) != expected) {
+            fprintf(stderr, "  sampleset %d: %ld, expected %ld\n", n,
+                    (long)db.getLastSampleTime(make_sampleset(n)), (long)expected);
+            return false;
+        }
+    }
+    return db.getEntryCount() == model.size();
+}
+
+bool copy_file(const std::string& from, const std::string& to)
+{
+    unlink(to.c_str());
+    FILE* in = fopen(from.c_str(), "rb");
+    if (!in) {
+        return errno == ENOENT;     // nothing to copy is a valid state
+    }
+    FILE* out = fopen(to.c_str(), "wb");
+    if (!out) {
+        fclose(in);
+        return false;
+    }
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        fwrite(buffer, 1, n, out);
+    }
+    fclose(in);
+    return fclose(out) == 0;
+}
+
+// The files as a power cut right now would leave them (everything synced)
+std::string crash_copy(const std::string& db_path, const char* name)
+{
+    std::string copy = path_of(name);
+    copy_file(db_path, copy);
+    copy_file(db_path + SAMPLESET_JOURNAL_SUFFIX, copy + SAMPLESET_JOURNAL_SUFFIX);
+    return copy;
+}
+
+off_t file_size(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+void remove_database(const std::string& path)
+{
+    unlink(path.c_str());
+    unlink((path + SAMPLESET_JOURNAL_SUFFIX).c_str());
+    unlink((path + ".tmp").c_str());
+}
+
+size_t index_of(const char* event, size_t from = 0)
+{
+    for (size_t i = from; i < g_events.size(); i++) {
+        if (g_events[i] == event) return i;
+    }
+    return g_events.size();
+}
+
+// ===== Checks =====
+
+bool check_replay_torn_corrupt()
+{
+    std::string db_path = path_of("replay.txt");
+    remove_database(db_path);
+
+    SamplesetDataManager db(db_path);
+    db.initialize();
+    Model model;
+    std::vector<Model> after;           // model after each record
+    for (int i = 0; i < 40; i++) {
+        record(db, model, i % 7, 1000 + i);
+        after.push_back(model);
+    }
+    db.flush();                         // below the compaction threshold: sync only
+
+    if (file_size(db_path) >= 0) {
+        return fail("replay", "flush below the threshold wrote a snapshot");
+    }
+
+    std::string copy = crash_copy(db_path, "replay_copy.txt");
+    {
+        SamplesetDataManager reloaded(copy);
+        reloaded.initialize();
+        if (!matches(reloaded, model, 7)) return fail("replay", "journal replay lost records");
+    }
+
+    // Torn tail: half a record after the last good one
+    copy = crash_copy(db_path, "torn_copy.txt");
+    std::string journal = copy + SAMPLESET_JOURNAL_SUFFIX;
+    off_t good_size = file_size(journal);
+    if (FILE* f = fopen(journal.c_str(), "ab")) {
+        fwrite("torn record torn", 1, 17, f);
+        fclose(f);
+    }
+    {
+        SamplesetDataManager reloaded(copy);
+        reloaded.initialize();
+        if (!matches(reloaded, model, 7)) return fail("torn tail", "records lost");
+        if (file_size(journal) != good_size) return fail("torn tail", "torn bytes not cut off");
+    }
+
+    // Corrupt record in the middle: replay keeps what came before it
+    const int corrupt = 25;
+    copy = crash_copy(db_path, "corrupt_copy.txt");
+    journal = copy + SAMPLESET_JOURNAL_SUFFIX;
+    int fd = open(journal.c_str(), O_RDWR);
+    unsigned char byte;
+    off_t offset = corrupt * JOURNAL_RECORD_BYTES + 3;
+    if (fd < 0 || pread(fd, &byte, 1, offset) != 1) return fail("corrupt", "cannot read journal");
+    byte ^= 0x40;
+    if (pwrite(fd, &byte, 1, offset) != 1) return fail("corrupt", "cannot write journal");
+    close(fd);
+    {
+        SamplesetDataManager reloaded(copy);
+        reloaded.initialize();
+        if (!matches(reloaded, after[corrupt - 1], 7)) {
+            return fail("corrupt", "replay did not stop at the bad record");
+        }
+        if (file_size(journal) != corrupt * JOURNAL_RECORD_BYTES) {
+            return fail("corrupt", "journal not cut at the bad record");
+        }
+    }
+
+    printf("  replay, torn tail, corrupt record: OK\n");
+    return true;
+}
+
+bool check_compaction()
+{
+    std::string db_path = path_of("compact.txt");
+    remove_database(db_path);
+
+    SamplesetDataManager db(db_path);
+    db.initialize();
+    Model model;
+    for (int i = 0; i < COMPACT_RECORDS + 10; i++) {
+        record(db, model, i % 11, 5000 + i);
+    }
+
+    g_events.clear();
+    if (!db.flush()) return fail("compaction", "flush failed");
+
+    size_t renamed = index_of("rename");
+    size_t dir_synced = index_of("fsync dir", renamed);
+    size_t truncated = index_of("ftruncate 0");
+    if (renamed == g_events.size() || dir_synced == g_events.size()) {
+        return fail("compaction", "snapshot rename not followed by a directory fsync");
+    }
+    if (truncated == g_events.size() || truncated < dir_synced) {
+        return fail("compaction", "journal truncated before the directory fsync");
+    }
+    if (file_size(db_path + SAMPLESET_JOURNAL_SUFFIX) != 0) {
+        return fail("compaction", "journal not emptied");
+    }
+
+    // Records after the compaction go to the fresh journal
+    record(db, model, 3, 9000);
+    db.flush();
+    std::string copy = crash_copy(db_path, "compact_copy.txt");
+    SamplesetDataManager reloaded(copy);
+    reloaded.initialize();
+    if (!matches(reloaded, model, 11)) return fail("compaction", "snapshot + journal lost records");
+
+    printf("  compaction (rename, directory fsync, then truncate): OK\n");
+    return true;
+}
+
+bool check_dir_fsync_failure()
+{
+    std::string db_path = path_of("dirsync.txt");
+    remove_database(db_path);
+
+    SamplesetDataManager db(db_path);
+    db.initialize();
+    Model model;
+    for (int i = 0; i < COMPACT_RECORDS + 5; i++) {
+        record(db, model, i % 5, 7000 + i);
+    }
+
+    g_fail_dir_fsync = true;
+    bool flushed = db.flush();
+    g_fail_dir_fsync = false;
+    if (flushed) return fail("dir fsync", "flush reported success");
+    if (file_size(db_path + SAMPLESET_JOURNAL_SUFFIX) != (COMPACT_RECORDS + 5) * JOURNAL_RECORD_BYTES) {
+        return fail("dir fsync", "journal truncated although the snapshot may not be durable");
+    }
+
+    // Journal alone still restores everything
+    std::string copy = crash_copy(db_path, "dirsync_copy.txt");
+    unlink(copy.c_str());               // the rename did not survive
+    SamplesetDataManager reloaded(copy);
+    reloaded.initialize();
+    if (!matches(reloaded, model, 5)) return fail("dir fsync", "records lost");
+
+    printf("  directory fsync failure keeps the journal: OK\n");
+    return true;
+}
+
+bool check_write_failure()
+{
+    std::string db_path = path_of("writefail.txt");
+    remove_database(db_path);
+
+    SamplesetDataManager db(db_path);
+    db.initialize();
+    Model model;
+    record(db, model, 0, 1000);         // journaled
+
+    struct stat st;
+    if (stat((db_path + SAMPLESET_JOURNAL_SUFFIX).c_str(), &st) != 0) {
+        return fail("write fail", "no journal");
+    }
+    g_fail_write_ino = st.st_ino;
+    record(db, model, 0, 2000);         // write fails: journal closed, snapshot dirty
+    if (g_fail_write_ino != 0) return fail("write fail", "journal write not attempted");
+
+    if (!db.flush()) return fail("write fail", "compaction failed");
+    record(db, model, 0, 3000);         // must be journaled again
+    db.flush();
+
+    std::string copy = crash_copy(db_path, "writefail_copy.txt");
+    SamplesetDataManager reloaded(copy);
+    reloaded.initialize();
+    if (!matches(reloaded, model, 1)) return fail("write fail", "stale journal replayed or record lost");
+
+    printf("  journal write failure, compaction and reopen: OK\n");
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bool keep_files = argc > 1;
+    if (keep_files) {
+        g_dir = argv[1];
+    } else {
+        char tmpl[] = "/tmp/sampleset_journal.XXXXXX";
+        if (!mkdtemp(tmpl)) {
+            perror("mkdtemp");
+            return 2;
+        }
+        g_dir = tmpl;
+    }
+
+    std::string config = path_of("config.txt");
+    if (FILE* f = fopen(config.c_str(), "w")) {
+        fprintf(f, "sampleset_journal_sync_records=1\n");
+        fprintf(f, "sampleset_journal_compact_records=%d\n", COMPACT_RECORDS);
+        fclose(f);
+    }
+    if (!ConfigManager::instance().load(config)) {
+        fprintf(stderr, "Cannot load %s\n", config.c_str());
+        return 2;
+    }
+
+    printf("sampleset_journal_check:\n");
+    if (!check_replay_torn_corrupt() || !check_compaction() ||
+        !check_dir_fsync_failure() || !check_write_failure()) {
+        fprintf(stderr, "files kept in %s\n", g_dir.c_str());
+        return 1;
+    }
+
+    if (!keep_files) {
+        std::string command = "rm -rf '" + g_dir + "'";
+        if (system(command.c_str()) != 0) {
+            fprintf(stderr, "Cannot remove %s\n", g_dir.c_str());
+        }
+    }
+    return 0;
+}
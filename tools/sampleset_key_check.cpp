@@ -0,0 +1,253 @@
+// sampleset_key_check - SamplesetKey against the legacy text database key
+//
+//   sampleset_key_check [random_count]
+//
+// For fixed boundary values (x.x5, where "%.1f" and round-half-away
+// disagree) and for random samplesets, checks that:
+//   - to_text(from_sampleset(s)) is the text key the database always used
+//   - from_text(that text) gives back the same SamplesetKey
+//   - two samplesets share a SamplesetKey exactly when they share a text key
+// Then compares the quantized tenths directly with the digits "%.1f"
+// prints for exact halves, their neighbouring doubles and random values
+// of every magnitude, and times a sample time lookup (key + table find)
+// against the string key and unordered_map it replaced.
+// Exits non-zero on the first mismatch.
+//
+// Build: make tools
+
+#include "../SamplesetKey.h"
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define LOOKUP_SAMPLESETS 2000
+#define LOOKUP_ROUNDS 200
+
+namespace {
+
+// The key SamplesetDataManager::generateKey() wrote before SamplesetKey
+std::string legacy_key(const Sampleset& sampleset)
+{
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "0x%08x_0x%02x_%s_%.1f_%d_%.1f",
+             sampleset.nodeid,
+             sampleset.sampling_mask,
+             sampleset.ac_dc_flag ? "AC" : "DC",
+             sampleset.max_freq,
+             sampleset.resolution,
+             sampleset.interval);
+    return std::string(buffer);
+}
+
+Sampleset make_sampleset(uint32_t nodeid, double max_freq, double interval)
+{
+    Sampleset sampleset;
+    sampleset.nodeid = nodeid;
+    sampleset.sampling_mask = 0x03;
+    sampleset.max_freq = max_freq;
+    sampleset.resolution = 1600;
+    sampleset.interval = interval;
+    sampleset.priority = 0;
+    sampleset.ac_dc_flag = 1;
+    return sampleset;
+}
+
+// Tenths as the digits "%.1f" prints (the reference for to_tenths())
+int32_t printf_tenths(double value)
+{
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), "%.1f", value);
+    if (length <= 0 || static_cast<size_t>(length) >= sizeof(buffer)) {
+        return value < 0 ? -INT32_MAX : INT32_MAX;
+    }
+    int64_t tenths = 0;
+    for (const char* p = buffer; *p; p++) {
+        if (*p >= '0' && *p <= '9') {
+            tenths = tenths * 10 + (*p - '0');
+            if (tenths > INT32_MAX) {
+                tenths = INT32_MAX;
+                break;
+            }
+        }
+    }
+    return static_cast<int32_t>(buffer[0] == '-' ? -tenths : tenths);
+}
+
+bool check_tenths(double value)
+{
+    Sampleset sampleset = make_sampleset(1, value, -value);
+    SamplesetKey key = SamplesetKey::from_sampleset(sampleset);
+    if (key.max_freq_tenths != printf_tenths(value) ||
+        key.interval_tenths != printf_tenths(-value)) {
+        fprintf(stderr, "FAIL %.17g: tenths %d / %d, \"%%.1f\" gives %d / %d\n", value,
+                key.max_freq_tenths, key.interval_tenths, printf_tenths(value), printf_tenths(-value));
+        return false;
+    }
+    return true;
+}
+
+// The value, its neighbouring doubles, and the same for value / 10^k
+bool check_around(double value)
+{
+    return check_tenths(value) &&
+           check_tenths(std::nextafter(value, 0.0)) &&
+           check_tenths(std::nextafter(value, INFINITY));
+}
+
+double elapsed_ns(std::chrono::steady_clock::time_point start, long operations)
+{
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    return d.count() / operations;
+}
+
+// ns per getLastSampleTime()-style lookup: SamplesetKey + SamplesetTimeTable
+// against the text key + unordered_map used before
+void time_lookups()
+{
+    std::mt19937_64 rng(7);
+    std::vector<Sampleset> samplesets;
+    for (int i = 0; i < LOOKUP_SAMPLESETS; i++) {
+        samplesets.push_back(make_sampleset(0x00111000 + (uint32_t)(rng() % 4096),
+                                            (rng() % 50000) / 10.0, 60.0 + (rng() % 86400)));
+    }
+
+    SamplesetTimeTable table;
+    std::unordered_map<std::string, time_t> legacy;
+    for (size_t i = 0; i < samplesets.size(); i++) {
+        table.set(SamplesetKey::from_sampleset(samplesets[i]), (time_t)i);
+        legacy[legacy_key(samplesets[i])] = (time_t)i;
+    }
+
+    long operations = (long)LOOKUP_ROUNDS * LOOKUP_SAMPLESETS;
+    time_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < LOOKUP_ROUNDS; r++) {
+        for (const Sampleset& s : samplesets) {
+            const time_t* t = table.find(SamplesetKey::from_sampleset(s));
+            sum += t ? *t : 0;
+        }
+    }
+    double key_ns = elapsed_ns(start, operations);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < LOOKUP_ROUNDS; r++) {
+        for (const Sampleset& s : samplesets) {
+            auto it = legacy.find(legacy_key(s));
+            sum -= it != legacy.end() ? it->second : 0;
+        }
+    }
+    double legacy_ns = elapsed_ns(start, operations);
+
+    printf("  lookup: SamplesetKey %.1f ns, text key %.1f ns (%.0fx)%s\n",
+           key_ns, legacy_ns, legacy_ns / key_ns, sum == 0 ? "" : " MISMATCH");
+}
+
+bool check_one(const Sampleset& sampleset)
+{
+    std::string expected = legacy_key(sampleset);
+    SamplesetKey key = SamplesetKey::from_sampleset(sampleset);
+    std::string text = key.to_text();
+    if (text != expected) {
+        fprintf(stderr, "FAIL max_freq=%.17g interval=%.17g: key text %s, legacy %s\n",
+                sampleset.max_freq, sampleset.interval, text.c_str(), expected.c_str());
+        return false;
+    }
+
+    SamplesetKey parsed;
+    if (!SamplesetKey::from_text(expected, &parsed) || parsed != key) {
+        fprintf(stderr, "FAIL %s does not parse back to the same key\n", expected.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int random_count = argc > 1 ? atoi(argv[1]) : 200000;
+
+    static const double boundaries[] = {
+        0.05, 0.15, 0.25, 0.35, 0.45, 0.55, 0.65, 0.75, 0.85, 0.95,
+        1.25, 2.35, 10.05, 12.45, 156.25, 156.35, 2560.05, 3276.75,
+        0.0, 0.1, 0.2, 0.3, 1.0, 10.0, 60.0, 3600.0, 86400.0,
+    };
+
+    int checked = 0;
+    for (double max_freq : boundaries) {
+        for (double interval : boundaries) {
+            if (!check_one(make_sampleset(0x00111578, max_freq, interval))) {
+                return 1;
+            }
+            checked++;
+        }
+    }
+
+    // Same SamplesetKey <=> same legacy text key, including values one
+    // tenth apart that straddle a .x5 boundary
+    std::map<std::string, SamplesetKey> by_text;
+    std::mt19937_64 rng(20261016);
+    std::uniform_int_distribution<int> hundredths(0, 500000);
+    for (int i = 0; i < random_count; i++) {
+        double max_freq = hundredths(rng) / 100.0;
+        double interval = (i & 1) ? hundredths(rng) / 100.0
+                                  : std::uniform_real_distribution<double>(0.0, 5000.0)(rng);
+        Sampleset sampleset = make_sampleset(0x00111578, max_freq, interval);
+        if (!check_one(sampleset)) {
+            return 1;
+        }
+
+        SamplesetKey key = SamplesetKey::from_sampleset(sampleset);
+        auto inserted = by_text.emplace(legacy_key(sampleset), key);
+        if (!inserted.second && inserted.first->second != key) {
+            fprintf(stderr, "FAIL %s maps to two different keys\n", inserted.first->first.c_str());
+            return 1;
+        }
+        checked++;
+    }
+
+    std::map<std::string, std::string> by_key;
+    for (const auto& entry : by_text) {
+        auto inserted = by_key.emplace(entry.second.to_text(), entry.first);
+        if (!inserted.second) {
+            fprintf(stderr, "FAIL %s and %s share a key\n",
+                    inserted.first->second.c_str(), entry.first.c_str());
+            return 1;
+        }
+    }
+
+    // Exact halves (k / 4 is exact, so k odd puts it on a .x5 tie) and
+    // their neighbours, then random doubles from 1e-6 to 2e8
+    int values = 0;
+    for (int k = 0; k < 400000; k++) {
+        if (!check_around(k / 4.0) || !check_around(k / 20.0)) {
+            return 1;
+        }
+        values += 6;
+    }
+    std::uniform_real_distribution<double> exponent(-6.0, 8.3);
+    for (int i = 0; i < random_count; i++) {
+        double value = std::pow(10.0, exponent(rng));
+        double scale = std::pow(10.0, (int)(rng() % 8));
+        if (!check_tenths(value) || !check_around(std::round(value * scale) / scale + 0.05)) {
+            return 1;
+        }
+        values += 4;
+    }
+    if (!check_tenths(0.0) || !check_tenths(-0.0) || !check_tenths(214748364.7) ||
+        !check_tenths(214748364.8) || !check_tenths(1e13)) {
+        return 1;
+    }
+
+    printf("sampleset_key_check: %d samplesets, %zu distinct keys, %d values, OK\n",
+           checked, by_text.size(), values);
+    time_lookups();
+    return 0;
+}
@@ -0,0 +1,247 @@
+// sampleset_scheduler_check - SamplesetScheduler against a brute-force model
+//
+//   sampleset_scheduler_check [rounds]
+//
+// Drives the heap scheduler and a linear-scan model of the same rules
+// through random sampleset lists, retry delays and clocks, and requires
+// the same answer from next_due(), get_due_time() and get_next_due_time()
+// after every step.  Samples fail at random, so entries handed out without
+// a record_sample() (the retry delay path) are covered too.  Then checks
+// the starvation cases directly:
+//   - a failing priority sampleset does not hold back due normal ones
+//   - with a single failing sampleset, retries are spaced by the delay
+// Exits non-zero on the first mismatch.
+//
+// Build: make tools
+
+#include "../SamplesetScheduler.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#define MODEL_STEPS 4000
+
+namespace {
+
+// The scheduling rules, one linear scan per call
+class ModelScheduler {
+public:
+    explicit ModelScheduler(int retry_delay) : retry_delay_(retry_delay), sequence_(0) {}
+
+    void rebuild(const std::vector<Sampleset>& samplesets, const std::vector<time_t>& last)
+    {
+        entries_.clear();
+        sequence_ = 0;
+        for (size_t i = 0; i < samplesets.size(); i++) {
+            Entry e;
+            e.interval = samplesets[i].interval;
+            e.priority = samplesets[i].priority != 0;
+            e.due = due_after(last[i], e.interval);
+            e.ready = e.due;
+            e.sequence = sequence_++;
+            entries_.push_back(e);
+        }
+    }
+
+    bool next_due(time_t now, size_t* index, double* overdue)
+    {
+        for (int pass = 0; pass < 2; pass++) {
+            bool want_priority = pass == 0;
+            bool found = false;
+            size_t best = 0;
+            for (size_t i = 0; i < entries_.size(); i++) {
+                const Entry& e = entries_[i];
+                if (e.priority != want_priority || e.ready > now) continue;
+                if (!found || e.ready < entries_[best].ready ||
+                    (e.ready == entries_[best].ready && e.sequence < entries_[best].sequence)) {
+                    best = i;
+                    found = true;
+                }
+            }
+            if (found) {
+                Entry& e = entries_[best];
+                *index = best;
+                *overdue = e.due ? difftime(now, e.due) : 0.0;
+                e.ready = now + retry_delay_;
+                e.sequence = sequence_++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void record_sample(size_t index, time_t sampled_at)
+    {
+        Entry& e = entries_[index];
+        e.due = due_after(sampled_at, e.interval);
+        e.ready = e.due;
+        e.sequence = sequence_++;
+    }
+
+    time_t get_due_time(size_t index) const { return entries_[index].due; }
+
+    time_t get_next_due_time() const
+    {
+        time_t next = 0;
+        for (size_t i = 0; i < entries_.size(); i++) {
+            if (i == 0 || entries_[i].ready < next) next = entries_[i].ready;
+        }
+        return next;
+    }
+
+private:
+    struct Entry {
+        time_t due;
+        time_t ready;
+        unsigned long sequence;
+        double interval;
+        bool priority;
+    };
+
+    static time_t due_after(time_t sampled_at, double interval)
+    {
+        return sampled_at == 0 ? 0 : sampled_at + static_cast<time_t>(std::ceil(interval));
+    }
+
+    std::vector<Entry> entries_;
+    int retry_delay_;
+    unsigned long sequence_;
+};
+
+Sampleset make_sampleset(double interval, bool priority)
+{
+    Sampleset s = Sampleset();
+    s.interval = interval;
+    s.priority = priority ? 1 : 0;
+    return s;
+}
+
+bool run_model(std::mt19937& rng, int round)
+{
+    static const int delays[] = {0, 1, 5, 60};
+    int retry_delay = delays[rng() % 4];
+    size_t count = 1 + rng() % (round % 4 == 0 ? 400 : 40);
+
+    std::vector<Sampleset> samplesets;
+    std::vector<time_t> last;
+    time_t now = 1700000000;
+    for (size_t i = 0; i < count; i++) {
+        samplesets.push_back(make_sampleset(1 + rng() % 900 + (rng() % 10) / 10.0, rng() % 4 == 0));
+        last.push_back(rng() % 3 == 0 ? 0 : now - (time_t)(rng() % 2000));
+    }
+
+    SamplesetScheduler scheduler;
+    scheduler.set_retry_delay(retry_delay);
+    scheduler.rebuild(samplesets, last);
+    ModelScheduler model(retry_delay);
+    model.rebuild(samplesets, last);
+
+    int fail_percent = rng() % 60;
+    for (int step = 0; step < MODEL_STEPS; step++) {
+        now += rng() % 4 == 0 ? rng() % 120 : 0;
+
+        size_t index = 0, model_index = 0;
+        double overdue = 0.0, model_overdue = 0.0;
+        bool due = scheduler.next_due(now, &index, &overdue);
+        bool model_due = model.next_due(now, &model_index, &model_overdue);
+        if (due != model_due || (due && (index != model_index || overdue != model_overdue))) {
+            fprintf(stderr, "FAIL round %d step %d (delay %d, %zu samplesets): "
+                    "next_due %d/%zu/%.0f, model %d/%zu/%.0f\n",
+                    round, step, retry_delay, count, due, index, overdue,
+                    model_due, model_index, model_overdue);
+            return false;
+        }
+        if (due && (int)(rng() % 100) >= fail_percent) {
+            time_t sampled_at = now + rng() % 3;
+            scheduler.record_sample(index, sampled_at);
+            model.record_sample(index, sampled_at);
+        }
+
+        size_t probe = rng() % count;
+        if (scheduler.get_due_time(probe) != model.get_due_time(probe) ||
+            scheduler.get_next_due_time() != model.get_next_due_time()) {
+            fprintf(stderr, "FAIL round %d step %d: due/next-due times differ from the model\n",
+                    round, step);
+            return false;
+        }
+    }
+    return true;
+}
+
+// A priority sampleset that always fails must not starve the normal ones
+bool check_failing_priority()
+{
+    std::vector<Sampleset> samplesets;
+    samplesets.push_back(make_sampleset(600, true));
+    samplesets.push_back(make_sampleset(600, false));
+    samplesets.push_back(make_sampleset(600, false));
+
+    SamplesetScheduler scheduler;
+    scheduler.set_retry_delay(60);
+    scheduler.rebuild(samplesets, std::vector<time_t>(3, 0));
+
+    int handed_out[3] = {0, 0, 0};
+    time_t now = 1000;
+    for (int i = 0; i < 20; i++, now += 10) {
+        size_t index;
+        double overdue;
+        if (scheduler.next_due(now, &index, &overdue)) {
+            handed_out[index]++;
+            if (index != 0) scheduler.record_sample(index, now);
+        }
+    }
+    // 200 s: the failing one every 60 s, each normal one once
+    if (handed_out[0] != 4 || handed_out[1] != 1 || handed_out[2] != 1) {
+        fprintf(stderr, "FAIL failing priority: handed out %d/%d/%d, expected 4/1/1\n",
+                handed_out[0], handed_out[1], handed_out[2]);
+        return false;
+    }
+    return true;
+}
+
+// A lone failing sampleset is retried once per retry delay, no sooner
+bool check_single_failing(int retry_delay)
+{
+    std::vector<Sampleset> samplesets(1, make_sampleset(600, false));
+    SamplesetScheduler scheduler;
+    scheduler.set_retry_delay(retry_delay);
+    scheduler.rebuild(samplesets, std::vector<time_t>(1, 0));
+
+    std::vector<time_t> attempts;
+    for (time_t now = 1000; now < 1000 + 10 * retry_delay; now++) {
+        size_t index;
+        double overdue;
+        if (scheduler.next_due(now, &index, &overdue)) {
+            attempts.push_back(now);
+        }
+    }
+    for (size_t i = 0; i < attempts.size(); i++) {
+        if (attempts[i] != 1000 + (time_t)i * retry_delay) {
+            fprintf(stderr, "FAIL single failing sampleset (delay %d): attempt %zu at +%ld\n",
+                    retry_delay, i, (long)(attempts[i] - 1000));
+            return false;
+        }
+    }
+    return attempts.size() == 10;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 200;
+    std::mt19937 rng(20261016);
+
+    for (int round = 0; round < rounds; round++) {
+        if (!run_model(rng, round)) return 1;
+    }
+    if (!check_failing_priority() || !check_single_failing(60) || !check_single_failing(5)) {
+        return 1;
+    }
+
+    printf("sampleset_scheduler_check: %d rounds of %d steps match the model, "
+           "retry delay checks OK\n", rounds, MODEL_STEPS);
+    return 0;
+}
@@ -0,0 +1,487 @@
+// server_bench - time server hot paths against the code they replaced
+//
+//   server_bench [join [channels] | window [trials] | copy [packets]]
+//
+// join: writes a synthetic TS1X sampling file (default 10000 channels, four
+//       per node), reads it with readTs1xSamplingFile(), builds samplesets,
+//       and joins channels to samplesets with both the original nested
+//       loop of populate_database_from_channels() (sscanf serial, type
+//       string, strptime + mktime per matching pair) and
+//       oldestChannelSampleTimes().  The oldest times must agree.
+//
+// window: for synthetic 0x55 loss patterns (uniform loss at several rates,
+//       bursts, a timed-out tail) over a 2048-segment upload, finds the
+//       densest 532-segment bitmap window with the original 28-segment grid
+//       scan and with plan_partial_windows().  The new window must cover as
+//       many missing segments as an exhaustive search, and never fewer
+//       than the grid scan.
+//
+// copy: copy-constructs parsed responses the way a received frame is
+//       copied (out of parse_response(), into the pending and triggering
+//       upload responses), for a '3' upload data frame and a 0x55 request,
+//       with CommandResponse as it is now and with the layout it replaced
+//       (five std::string fields and the 0x55 segment vector).  Reports the
+//       cost per copy.
+//
+// With no arguments every benchmark runs with its defaults.  Exits non-zero
+// if any result differs from the code it replaced.
+//
+// Build: make tools
+
+#include "../CommandProcessor.h"
+#include "../CommandReceiverSubs.h"
+#include "../SamplesetGenerator.h"
+#include "../Ts1xSamplingReader.h"
+#include "../UploadCommandBuilder.h"
+#include <unistd.h>
+#include <utime.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+#define JOIN_DEFAULT_CHANNELS 10000
+#define JOIN_CHANNELS_PER_NODE 4
+
+#define WINDOW_DEFAULT_TRIALS 200
+#define WINDOW_TOTAL_SEGMENTS 2048
+#define WINDOW_BITMAP_SEGMENTS 532   // 76 mask bytes x 7
+
+#define COPY_DEFAULT_PACKETS 1000000
+#define COPY_BATCH 256
+
+namespace {
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+// ===== join =====
+
+// SamplesetSupervisor::parse_timestamp() as it was
+time_t legacy_parse_timestamp(const std::string& timestamp_str)
+{
+    if (timestamp_str.empty() || timestamp_str == "-") {
+        return 0;
+    }
+    struct tm tm = {};
+    if (strptime(timestamp_str.c_str(), "%Y-%m-%d %H:%M:%S", &tm) == nullptr) {
+        return 0;
+    }
+    time_t timestamp = mktime(&tm);
+    return timestamp == -1 ? 0 : timestamp;
+}
+
+// The join populate_database_from_channels() ran before the node index
+std::vector<time_t> legacy_join(const std::vector<Sampleset>& samplesets,
+                                const std::vector<Ts1xChannel>& channels)
+{
+    std::vector<time_t> oldest;
+    for (const auto& sampleset : samplesets) {
+        time_t oldest_time = 0;
+        bool found_any = false;
+
+        for (const auto& channel : channels) {
+            uint32_t channel_nodeid = 0;
+            if (sscanf(channel.serial.c_str(), "0x%x", &channel_nodeid) != 1) {
+                continue;
+            }
+            if (channel_nodeid != sampleset.nodeid) {
+                continue;
+            }
+            bool is_ac = (channel.channel_type == "AC");
+            if (is_ac != (bool)sampleset.ac_dc_flag) {
+                continue;
+            }
+            uint8_t channel_bit = (1 << channel.channel_num);
+            if ((sampleset.sampling_mask & channel_bit) == 0) {
+                continue;
+            }
+            time_t channel_time = legacy_parse_timestamp(channel.last_sampled);
+            if (channel_time == 0) {
+                continue;
+            }
+            if (!found_any || channel_time < oldest_time) {
+                oldest_time = channel_time;
+                found_any = true;
+            }
+        }
+        oldest.push_back(found_any ? oldest_time : 0);
+    }
+    return oldest;
+}
+
+bool write_sampling_file(const std::string& path, int channel_count)
+{
+    FILE* fp = fopen(path.c_str(), "w");
+    if (!fp) {
+        return false;
+    }
+    fprintf(fp, "hw_type | serial | port | channel | type | channel_id | interval | adj_interval | "
+                "max_freq | resolution | last_sampled | priority | is_demod | external_input | external_name\n");
+    fprintf(fp, "--------+--------+------+---------+------+------------+----------+--------------+"
+                "----------+------------+--------------+----------+----------+----------------+--------------\n");
+
+    std::mt19937 rng(20261016);
+    auto pick = [&rng](unsigned n) { return (unsigned)(rng() % n); };
+    for (int i = 0; i < channel_count; i++) {
+        unsigned nodeid = 0x00110000 + i / JOIN_CHANNELS_PER_NODE;
+        int channel = i % JOIN_CHANNELS_PER_NODE;
+        bool ac = channel >= 2;
+        char last_sampled[32];
+        if (pick(10) == 0) {
+            strcpy(last_sampled, "-");
+        } else {
+            snprintf(last_sampled, sizeof(last_sampled), "2026-%02u-%02u %02u:%02u:%02u.000",
+                     1 + pick(9), 1 + pick(28), pick(24), pick(60), pick(60));
+        }
+        fprintf(fp, "TS1X | 0x%08x | 820 | %d | %s | 6f1c%04x-0000-4000-8000-%012x | %s | %s | %s | %s | %s | %d | 0 | False | -\n",
+                nodeid, channel, ac ? "AC" : "DC", i & 0xffff, i,
+                ac ? "3600" : "600", ac ? "3600" : "600",
+                ac ? "2000" : "-", ac ? "1600" : "-",
+                last_sampled, (i % 50) == 0 ? 1 : 0);
+    }
+    fclose(fp);
+
+    // The reader waits for files modified in the last two seconds
+    struct utimbuf old_times;
+    old_times.actime = old_times.modtime = time(nullptr) - 60;
+    utime(path.c_str(), &old_times);
+    return true;
+}
+
+bool bench_join(int channel_count)
+{
+    char path[] = "/tmp/server_bench_ts1x.XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return false;
+    }
+    close(fd);
+    if (!write_sampling_file(path, channel_count)) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        unlink(path);
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Ts1xChannel> channels = readTs1xSamplingFile(path);
+    double read_ms = elapsed_ms(start);
+    unlink(path);
+
+    std::vector<Sampleset> samplesets = createSamplesets(channels);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<time_t> expected = legacy_join(samplesets, channels);
+    double legacy_ms = elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<time_t> actual = oldestChannelSampleTimes(samplesets, channels);
+    double join_ms = elapsed_ms(start);
+
+    if (actual != expected) {
+        for (size_t i = 0; i < samplesets.size(); i++) {
+            if (actual[i] != expected[i]) {
+                fprintf(stderr, "FAIL join: sampleset %zu (0x%08x mask=0x%02x) oldest %ld, expected %ld\n",
+                        i, samplesets[i].nodeid, samplesets[i].sampling_mask,
+                        (long)actual[i], (long)expected[i]);
+                break;
+            }
+        }
+        return false;
+    }
+
+    printf("join: %zu channels, %zu samplesets, identical oldest times\n",
+           channels.size(), samplesets.size());
+    printf("  read file (parses serials and timestamps once) %8.2f ms\n", read_ms);
+    printf("  nested loop join                               %8.2f ms\n", legacy_ms);
+    printf("  node index join                                %8.2f ms\n", join_ms);
+    return true;
+}
+
+// ===== window =====
+
+// UploadCommandBuilder::count_segments_in_window() as it was
+int legacy_count_in_window(int start_segment, const std::vector<int>& missing_segments,
+                           int max_segments_per_bitmap)
+{
+    int end_segment = start_segment + max_segments_per_bitmap;
+    int count = 0;
+    for (int seg : missing_segments) {
+        if (seg < start_segment) continue;
+        if (seg >= end_segment) break;
+        count++;
+    }
+    return count;
+}
+
+// UploadCommandBuilder::find_optimal_start_segment() as it was (grid of 28,
+// then the first missing segment; fewer than 10 missing: first missing)
+int legacy_find_start(const std::vector<int>& missing_segments, int total_segments,
+                      int max_segments_per_bitmap)
+{
+    if (missing_segments.empty()) {
+        return -1;
+    }
+    if (missing_segments.size() < 10) {
+        return missing_segments[0];
+    }
+
+    int best_start = missing_segments[0];
+    int best_count = 0;
+    const int max_possible_count = std::min((int)missing_segments.size(), max_segments_per_bitmap);
+
+    for (int scan_pos = 0; scan_pos < total_segments; scan_pos += 28) {
+        int count = legacy_count_in_window(scan_pos, missing_segments, max_segments_per_bitmap);
+        if (count > best_count) {
+            best_start = scan_pos;
+            best_count = count;
+            if (best_count >= max_possible_count) {
+                return best_start;
+            }
+        }
+    }
+
+    int first_count = legacy_count_in_window(missing_segments[0], missing_segments,
+                                             max_segments_per_bitmap);
+    if (first_count > best_count) {
+        best_start = missing_segments[0];
+    }
+    return best_start;
+}
+
+int count_in_window(int start, const std::vector<int>& missing, int width)
+{
+    return std::lower_bound(missing.begin(), missing.end(), start + width) -
+           std::lower_bound(missing.begin(), missing.end(), start);
+}
+
+// Every possible start
+int exhaustive_best(const std::vector<int>& missing, int total_segments, int width)
+{
+    int best = 0;
+    for (int start = 0; start < total_segments; start++) {
+        best = std::max(best, count_in_window(start, missing, width));
+    }
+    return best;
+}
+
+struct LossPattern {
+    const char* name;
+    double loss;        // uniform loss probability
+    int bursts;         // additional lost bursts
+    int burst_length;
+    int tail_from;      // everything from here on lost, -1 for none
+};
+
+std::vector<int> make_missing(const LossPattern& pattern, std::mt19937& rng)
+{
+    std::vector<bool> lost(WINDOW_TOTAL_SEGMENTS, false);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (int s = 0; s < WINDOW_TOTAL_SEGMENTS; s++) {
+        lost[s] = uniform(rng) < pattern.loss;
+    }
+    for (int b = 0; b < pattern.bursts; b++) {
+        int start = rng() % WINDOW_TOTAL_SEGMENTS;
+        for (int s = start; s < std::min(WINDOW_TOTAL_SEGMENTS, start + pattern.burst_length); s++) {
+            lost[s] = true;
+        }
+    }
+    if (pattern.tail_from >= 0) {
+        for (int s = pattern.tail_from; s < WINDOW_TOTAL_SEGMENTS; s++) {
+            lost[s] = true;
+        }
+    }
+
+    std::vector<int> missing;
+    for (int s = 0; s < WINDOW_TOTAL_SEGMENTS; s++) {
+        if (lost[s]) missing.push_back(s);
+    }
+    return missing;
+}
+
+bool bench_window(int trials)
+{
+    static const LossPattern patterns[] = {
+        {"uniform 5%",          0.05, 0,   0,  -1},
+        {"uniform 30%",         0.30, 0,   0,  -1},
+        {"uniform 70%",         0.70, 0,   0,  -1},
+        {"uniform 95%",         0.95, 0,   0,  -1},
+        {"bursts of 64",        0.02, 6,  64,  -1},
+        {"bursts of 300",       0.02, 3, 300,  -1},
+        {"timeout at 1500",     0.05, 0,   0, 1500},
+        {"timeout + bursts",    0.05, 4,  96, 1700},
+    };
+
+    UploadCommandBuilder builder;
+    std::mt19937 rng(20261016);
+    bool ok = true;
+
+    printf("window: %d trials per pattern, %d segments, %d-segment bitmap\n",
+           trials, WINDOW_TOTAL_SEGMENTS, WINDOW_BITMAP_SEGMENTS);
+    printf("  %-18s %8s %8s %8s %10s %10s\n",
+           "pattern", "best", "grid", "new", "grid us", "new us");
+
+    for (const LossPattern& pattern : patterns) {
+        long best_total = 0;
+        long legacy_total = 0;
+        long new_total = 0;
+        double legacy_us = 0.0;
+        double new_us = 0.0;
+
+        for (int t = 0; t < trials; t++) {
+            std::vector<int> missing = make_missing(pattern, rng);
+            if (missing.empty()) {
+                continue;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            int legacy_start = legacy_find_start(missing, WINDOW_TOTAL_SEGMENTS, WINDOW_BITMAP_SEGMENTS);
+            legacy_us += elapsed_ms(start) * 1000.0;
+
+            std::vector<int> starts;
+            start = std::chrono::steady_clock::now();
+            int covered = builder.plan_partial_windows(missing, WINDOW_BITMAP_SEGMENTS, 1, starts);
+            new_us += elapsed_ms(start) * 1000.0;
+
+            int best = exhaustive_best(missing, WINDOW_TOTAL_SEGMENTS, WINDOW_BITMAP_SEGMENTS);
+            int legacy_covered = count_in_window(legacy_start, missing, WINDOW_BITMAP_SEGMENTS);
+            if (starts.size() != 1 || covered != best ||
+                count_in_window(starts[0], missing, WINDOW_BITMAP_SEGMENTS) != covered ||
+                covered < legacy_covered) {
+                fprintf(stderr, "FAIL window [%s]: covers %d (start %d), exhaustive %d, grid %d\n",
+                        pattern.name, covered, starts.empty() ? -1 : starts[0], best, legacy_covered);
+                ok = false;
+                break;
+            }
+            best_total += best;
+            legacy_total += legacy_covered;
+            new_total += covered;
+        }
+
+        printf("  %-18s %8.1f %8.1f %8.1f %10.2f %10.2f\n", pattern.name,
+               (double)best_total / trials, (double)legacy_total / trials,
+               (double)new_total / trials, legacy_us / trials, new_us / trials);
+    }
+    return ok;
+}
+
+// ===== copy =====
+
+// CommandResponse before it was made trivially copyable: the same plain
+// fields plus the strings and the segment vector it carried
+struct LegacyResponse {
+    CommandResponse plain;
+    std::string command_name;
+    std::string command_description;
+    std::string descriptor_sample_rate_str;
+    std::string unit_type;
+    std::string firmware_version;
+    std::vector<uint16_t> upload_partial_segments;
+};
+
+size_t touch(const CommandResponse& r) { return strlen(r.command_name) + r.data[0]; }
+size_t touch(const LegacyResponse& r) { return r.command_name.size() + r.plain.data[0]; }
+
+// Copy-construct `packets` responses into a reused batch; returns ns/copy
+template <typename Response>
+double time_copies(const Response& source, int packets, size_t* sink)
+{
+    std::vector<Response> batch;
+    batch.reserve(COPY_BATCH);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < packets; i++) {
+        if (batch.size() == COPY_BATCH) {
+            *sink += touch(batch.back());
+            batch.clear();
+        }
+        batch.push_back(source);
+    }
+    return elapsed_ms(start) * 1e6 / packets;
+}
+
+// Registry names as parse_response() fills them in (CommandProcessor.cpp)
+void fill_command(CommandResponse& plain, LegacyResponse& legacy, char code,
+                  const char* name, const char* description)
+{
+    plain.command_code = code;
+    plain.command_name = name;
+    plain.command_description = description;
+    legacy.command_name = name;
+    legacy.command_description = description;
+}
+
+bool bench_copy(int packets)
+{
+    std::mt19937 rng(20261016);
+
+    CommandResponse data_frame;
+    LegacyResponse legacy_data;
+    fill_command(data_frame, legacy_data, '3', "DATA_UPLOAD", "Data upload segment");
+    data_frame.has_upload_data = true;
+    data_frame.upload_segment_count = 2;
+    for (int i = 0; i < 128; i++) data_frame.data[i] = (uint8_t)rng();
+    for (int i = 0; i < 64; i++) data_frame.upload_data[i] = (int16_t)rng();
+    legacy_data.plain = data_frame;
+    legacy_data.descriptor_sample_rate_str = "20.0 kHz";
+    legacy_data.unit_type = "TSX_7CH";
+    legacy_data.firmware_version = "v85";
+
+    // Half the bitmap flagged
+    CommandResponse partial_frame;
+    LegacyResponse legacy_partial;
+    fill_command(partial_frame, legacy_partial, 'U', "UPLOAD_PARTIAL",
+                 "Upload partial data request (0x55)");
+    partial_frame.has_upload_partial_request = true;
+    for (int i = 0; i < 128; i++) partial_frame.data[i] = (uint8_t)(rng() | 1);
+    legacy_partial.plain = partial_frame;
+    for (int i = 0; i < UPLOAD_PARTIAL_MAX_SEGMENTS; i += 2) {
+        legacy_partial.upload_partial_segments.push_back((uint16_t)i);
+    }
+
+    size_t sink = 0;
+    printf("copy: %d copies per frame, CommandResponse %zu bytes (was %zu + heap)\n",
+           packets, sizeof(CommandResponse), sizeof(LegacyResponse));
+    printf("  %-18s %10s %10s\n", "frame", "old ns", "new ns");
+    double old_ns = time_copies(legacy_data, packets, &sink);
+    double new_ns = time_copies(data_frame, packets, &sink);
+    printf("  %-18s %10.1f %10.1f\n", "'3' upload data", old_ns, new_ns);
+    old_ns = time_copies(legacy_partial, packets, &sink);
+    new_ns = time_copies(partial_frame, packets, &sink);
+    printf("  %-18s %10.1f %10.1f\n", "0x55 request", old_ns, new_ns);
+    return sink != 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const char* only = argc > 1 ? argv[1] : nullptr;
+    bool ok = true;
+
+    if (only && strcmp(only, "join") != 0 && strcmp(only, "window") != 0 &&
+        strcmp(only, "copy") != 0) {
+        fprintf(stderr, "Usage: %s [join [channels] | window [trials] | copy [packets]]\n", argv[0]);
+        return 2;
+    }
+    int count = only && argc > 2 ? atoi(argv[2]) : 0;
+
+    if (!only || strcmp(only, "join") == 0) {
+        ok = bench_join(count > 0 ? count : JOIN_DEFAULT_CHANNELS) && ok;
+    }
+    if (!only || strcmp(only, "window") == 0) {
+        ok = bench_window(count > 0 ? count : WINDOW_DEFAULT_TRIALS) && ok;
+    }
+    if (!only || strcmp(only, "copy") == 0) {
+        ok = bench_copy(count > 0 ? count : COPY_DEFAULT_PACKETS) && ok;
+    }
+    return ok ? 0 : 1;
+}
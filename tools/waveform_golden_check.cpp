@@ -0,0 +1,308 @@
+// waveform_golden_check - render_waveform_text() against the original writer
+//
+//   waveform_golden_check [out_dir]
+//
+// For a set of fixed 65536-sample datasets, writes each waveform text file
+// twice into out_dir: once with the fprintf/fprintf_3digit_exp writer
+// write_data_file() used before the line cache, once with
+// render_waveform_text() + write_whole_file() as the server does now.  The
+// two files must be byte-identical.  Each dataset is also written as a
+// .wfb (render_waveform_binary() + write_whole_file()), read back with
+// read_waveform_binary() and rendered to text again, which must match the
+// same bytes.  All three writers are timed.  Exits non-zero on the first
+// difference.  Without out_dir the files go to a temporary directory that
+// is removed unless a check fails.
+//
+// Build: make tools
+
+#include "../WaveformFile.h"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#define DATA_SCALE (1.0 / 20971.52)
+#define DATASET_SAMPLES 65536
+#define TIMING_ROUNDS 5
+
+namespace {
+
+// ===== The writer as it was before render_waveform_text() =====
+
+void fprintf_3digit_exp(FILE* fp, double value) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.6e", value);
+
+    // Find the 'e' in scientific notation
+    char* e_pos = strchr(buffer, 'e');
+    if (!e_pos) e_pos = strchr(buffer, 'E');
+
+    // If exponent is only 2 digits (e.g., "e-04"), expand to 3 (e.g., "e-004")
+    if (e_pos && strlen(e_pos) == 4) {  // "e-04" is 4 chars
+        char sign = e_pos[1];           // '+' or '-'
+        int exp_val = abs(atoi(e_pos + 2));
+        sprintf(e_pos, "e%c%03d", sign, exp_val);
+    }
+
+    fprintf(fp, "%s\n", buffer);
+}
+
+bool legacy_write(const std::string& path, const WaveformHeader& h, const std::vector<int16_t>& data)
+{
+    FILE* fp = fopen(path.c_str(), "w");
+    if (!fp) {
+        return false;
+    }
+
+    fprintf(fp, ";PodID %08x\n", h.pod_id);
+    fprintf(fp, ";Date Year(%d) Month(%d) Day(%02d) Hour(%02d) Minutes(%02d) Seconds(%02d)\n",
+            h.year, h.month, h.day, h.hour, h.min, h.sec);
+    fprintf(fp, ";FSampleRate %f\n", h.sample_rate);
+    fprintf(fp, ";Channels 1\n");
+    fprintf(fp, ";nStart_channel %d\n", h.start_channel);
+    fprintf(fp, ";Units 0\n");
+    fprintf(fp, ";echobase %08x\n", h.echobase);
+    fprintf(fp, ";Agc 1\n");
+    fprintf(fp, ";Samples %zu\n", data.size());
+    fprintf(fp, ";RMS %f\n", h.rms);
+    fprintf(fp, ";channelIds -2 -1\n");
+
+    int meani = h.mean;
+    for (int16_t sample : data) {
+        double scaled_sample = (sample-meani) * h.scale;
+        fprintf_3digit_exp(fp, scaled_sample);
+    }
+
+    fclose(fp);
+    return true;
+}
+
+// ===== Datasets =====
+
+struct Dataset {
+    const char* name;
+    std::vector<int16_t> samples;
+    double scale;
+};
+
+std::vector<Dataset> make_datasets()
+{
+    std::vector<Dataset> sets;
+    std::mt19937 rng(20261016);
+    std::normal_distribution<double> noise(0.0, 40.0);
+
+    Dataset random{"random", {}, DATA_SCALE};
+    for (int i = 0; i < DATASET_SAMPLES; i++) {
+        random.samples.push_back((int16_t)(rng() & 0xffff));
+    }
+    sets.push_back(random);
+
+    Dataset sine{"sine_noise", {}, DATA_SCALE};
+    for (int i = 0; i < DATASET_SAMPLES; i++) {
+        double v = 1200.0 + 9000.0 * sin(2 * M_PI * i / 337.0) + noise(rng);
+        sine.samples.push_back((int16_t)lround(std::max(-32768.0, std::min(32767.0, v))));
+    }
+    sets.push_back(sine);
+
+    Dataset square{"square_full_scale", {}, DATA_SCALE};
+    for (int i = 0; i < DATASET_SAMPLES; i++) {
+        square.samples.push_back((i / 64) & 1 ? 32767 : -32768);
+    }
+    sets.push_back(square);
+
+    Dataset ramp{"ramp", {}, DATA_SCALE};
+    for (int i = 0; i < DATASET_SAMPLES; i++) {
+        ramp.samples.push_back((int16_t)(i - 32768));
+    }
+    sets.push_back(ramp);
+
+    Dataset flat{"flat_offset", {}, DATA_SCALE};
+    for (int i = 0; i < DATASET_SAMPLES; i++) {
+        flat.samples.push_back((int16_t)(-1234 + (i % 3 == 0)));
+    }
+    sets.push_back(flat);
+
+    // Scales whose lines need other exponent widths
+    Dataset tiny{"ramp_scale_1e-9", ramp.samples, 1e-9};
+    sets.push_back(tiny);
+    Dataset large{"ramp_scale_1e6", ramp.samples, 1e6};
+    sets.push_back(large);
+
+    return sets;
+}
+
+WaveformHeader make_header(const Dataset& set, int index)
+{
+    static const double sample_rates[] = {
+        20000.0, 10000.0, 5000.0, 2500.0, 1250.0, 625.0, 312.0, 156.0
+    };
+
+    double sum = 0.0;
+    for (int16_t s : set.samples) sum += s;
+    int meani = (int)(sum / set.samples.size());
+    double sum_squares = 0.0;
+    for (int16_t s : set.samples) {
+        double scaled = (s - meani) * set.scale;
+        sum_squares += scaled * scaled;
+    }
+
+    WaveformHeader header;
+    header.pod_id = 0x00111578 + index;
+    header.echobase = 0x0a0b0c0d;
+    header.year = 2026;
+    header.month = 10;
+    header.day = 16;
+    header.hour = 9;
+    header.min = index;
+    header.sec = 7;
+    header.start_channel = 1 + (index & 1);
+    header.sample_rate = sample_rates[index % 8];
+    header.rms = sqrt(sum_squares / set.samples.size());
+    header.scale = set.scale;
+    header.mean = meani;
+    header.sample_count = set.samples.size();
+    return header;
+}
+
+bool read_file(const std::string& path, std::string* contents)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) {
+        return false;
+    }
+    char buffer[65536];
+    size_t n;
+    contents->clear();
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        contents->append(buffer, n);
+    }
+    fclose(fp);
+    return true;
+}
+
+// 1-based line of the first difference
+size_t first_difference_line(const std::string& a, const std::string& b)
+{
+    size_t line = 1;
+    for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+        if (a[i] != b[i]) return line;
+        if (a[i] == '\n') line++;
+    }
+    return line;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string out_dir;
+    bool keep_files = argc > 1;
+    if (keep_files) {
+        out_dir = argv[1];
+    } else {
+        char tmpl[] = "/tmp/waveform_golden.XXXXXX";
+        if (!mkdtemp(tmpl)) {
+            perror("mkdtemp");
+            return 2;
+        }
+        out_dir = tmpl;
+    }
+
+    std::vector<Dataset> sets = make_datasets();
+    std::vector<std::string> written;
+    for (size_t i = 0; i < sets.size(); i++) {
+        const Dataset& set = sets[i];
+        WaveformHeader header = make_header(set, (int)i);
+        std::string old_path = out_dir + "/" + set.name + ".old.txt";
+        std::string new_path = out_dir + "/" + set.name + ".new.txt";
+        std::string binary_path = out_dir + "/" + set.name + WAVEFORM_BINARY_EXTENSION;
+        written.push_back(old_path);
+        written.push_back(new_path);
+        written.push_back(binary_path);
+
+        double old_ms = 0.0;
+        double new_ms = 0.0;
+        double binary_ms = 0.0;
+        for (int r = 0; r < TIMING_ROUNDS; r++) {
+            auto start = std::chrono::steady_clock::now();
+            if (!legacy_write(old_path, header, set.samples)) {
+                fprintf(stderr, "Cannot write %s\n", old_path.c_str());
+                return 2;
+            }
+            old_ms += elapsed_ms(start);
+
+            start = std::chrono::steady_clock::now();
+            if (!write_whole_file(new_path, render_waveform_text(header, set.samples.data()))) {
+                fprintf(stderr, "Cannot write %s\n", new_path.c_str());
+                return 2;
+            }
+            new_ms += elapsed_ms(start);
+
+            start = std::chrono::steady_clock::now();
+            if (!write_whole_file(binary_path, render_waveform_binary(header, set.samples.data()))) {
+                fprintf(stderr, "Cannot write %s\n", binary_path.c_str());
+                return 2;
+            }
+            binary_ms += elapsed_ms(start);
+        }
+
+        std::string old_text;
+        std::string new_text;
+        if (!read_file(old_path, &old_text) || !read_file(new_path, &new_text)) {
+            fprintf(stderr, "Cannot read back %s\n", set.name);
+            return 2;
+        }
+        if (old_text != new_text) {
+            fprintf(stderr, "FAIL %s: %s and %s differ at line %zu\n", set.name,
+                    old_path.c_str(), new_path.c_str(), first_difference_line(old_text, new_text));
+            return 1;
+        }
+
+        // .wfb -> text must give the same file
+        WaveformHeader read_header;
+        std::vector<int16_t> read_samples;
+        std::string error;
+        if (!read_waveform_binary(binary_path, read_header, read_samples, &error)) {
+            fprintf(stderr, "FAIL %s: cannot read back %s: %s\n", set.name,
+                    binary_path.c_str(), error.c_str());
+            return 1;
+        }
+        if (read_samples != set.samples) {
+            fprintf(stderr, "FAIL %s: %s samples differ\n", set.name, binary_path.c_str());
+            return 1;
+        }
+        std::string binary_text = render_waveform_text(read_header, read_samples.data());
+        if (binary_text != old_text) {
+            fprintf(stderr, "FAIL %s: text rendered from %s differs from %s at line %zu\n",
+                    set.name, binary_path.c_str(), old_path.c_str(),
+                    first_difference_line(old_text, binary_text));
+            return 1;
+        }
+
+        printf("  %-18s %8zu bytes identical, .wfb round trip identical; "
+               "fprintf %6.2f ms, text %6.2f ms, .wfb %5.2f ms\n",
+               set.name, new_text.size(), old_ms / TIMING_ROUNDS, new_ms / TIMING_ROUNDS,
+               binary_ms / TIMING_ROUNDS);
+    }
+
+    printf("waveform_golden_check: %zu datasets identical (text and .wfb)\n", sets.size());
+    if (!keep_files) {
+        for (const auto& path : written) {
+            unlink(path.c_str());
+        }
+        rmdir(out_dir.c_str());
+    }
+    return 0;
+}
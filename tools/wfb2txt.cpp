@@ -0,0 +1,56 @@
+// wfb2txt - regenerate the legacy waveform text file from a binary .wfb
+//
+//   wfb2txt <file.wfb> [out.txt | -]
+//
+// Without an output name the text goes next to the input with a .txt
+// extension; "-" writes to stdout.  The output is byte-identical to the
+// text file pi_server would have written for the same dataset.
+//
+// Build: make tools
+
+#include "../WaveformFile.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s <file%s> [out%s | -]\n",
+                argv[0], WAVEFORM_BINARY_EXTENSION, WAVEFORM_TEXT_EXTENSION);
+        return 2;
+    }
+
+    std::string in_path = argv[1];
+    std::string out_path;
+    if (argc == 3) {
+        out_path = argv[2];
+    } else {
+        size_t dot = in_path.rfind('.');
+        size_t slash = in_path.rfind('/');
+        bool has_ext = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+        out_path = (has_ext ? in_path.substr(0, dot) : in_path) + WAVEFORM_TEXT_EXTENSION;
+    }
+
+    WaveformHeader header;
+    std::vector<int16_t> samples;
+    std::string error;
+    if (!read_waveform_binary(in_path, header, samples, &error)) {
+        fprintf(stderr, "%s: %s\n", in_path.c_str(), error.c_str());
+        return 1;
+    }
+
+    std::string text = render_waveform_text(header, samples.data());
+    if (out_path == "-") {
+        if (fwrite(text.data(), 1, text.size(), stdout) != text.size()) {
+            perror("stdout");
+            return 1;
+        }
+        return 0;
+    }
+    if (!write_whole_file(out_path, text)) {
+        perror(out_path.c_str());
+        return 1;
+    }
+    return 0;
+}